@@ -0,0 +1,72 @@
+import sys
+import os
+import struct
+
+# Converts an ImageReader map file into packed image files (*.imgpack) and a pack list (*.imgpacklist),
+# which can be used instead of the map file as the 'file' parameter of the ImageReader.
+# Each pack holds the encoded images as they are (no re-encoding), followed by an index with keys and labels,
+# so that the reader loads a whole pack with a single sequential read.
+# See ImageDataDeserializer.cpp for the format.
+
+Magic = b'CNTKIPK1'
+HeaderSize = len(Magic) + 3 * 8
+
+def readMap(mapPath):
+    with open(mapPath, 'r') as mapFile:
+        for lineIndex, line in enumerate(mapFile):
+            fields = line.rstrip('\r\n').split('\t')
+            if len(fields) >= 3:
+                key, path, label = fields[0], fields[1], fields[2]
+            elif len(fields) == 2:
+                # Old format without sequence keys: the key is the line number, as in the reader.
+                key, path, label = str(lineIndex), fields[0], fields[1]
+            else:
+                raise ValueError('Invalid map file format, must contain 2 or 3 tab-delimited columns, line %d in file %s.' % (lineIndex, mapPath))
+            yield key, path, int(label)
+
+def writePack(packPath, records):
+    with open(packPath, 'wb') as pack:
+        pack.write(Magic + struct.pack('<QQQ', 0, 0, 0))
+        index = []
+        for key, path, label in records:
+            with open(path, 'rb') as image:
+                data = image.read()
+            index.append((pack.tell(), len(data), label, key.encode('utf-8')))
+            pack.write(data)
+        indexOffset = pack.tell()
+        for offset, size, label, key in index:
+            pack.write(struct.pack('<QIII', offset, size, label, len(key)))
+            pack.write(key)
+        indexSize = pack.tell() - indexOffset
+        pack.seek(len(Magic))
+        pack.write(struct.pack('<QQQ', len(index), indexOffset, indexSize))
+
+def convert(mapPath, outPrefix, packSizeMB):
+    packSize = packSizeMB * 1024 * 1024
+    packNames = []
+    records = []
+    recordsSize = 0
+    def flush():
+        packName = '%s_%05d.imgpack' % (os.path.basename(outPrefix), len(packNames))
+        writePack(os.path.join(os.path.dirname(outPrefix), packName), records)
+        packNames.append(packName)
+        print('Written %s (%d images).' % (packName, len(records)))
+    for key, path, label in readMap(mapPath):
+        records.append((key, path, label))
+        recordsSize += os.path.getsize(path)
+        if recordsSize >= packSize:
+            flush()
+            records = []
+            recordsSize = 0
+    if records:
+        flush()
+    # Pack paths are relative to the list file.
+    with open(outPrefix + '.imgpacklist', 'w') as packList:
+        for packName in packNames:
+            packList.write(packName + '\n')
+
+if __name__ == "__main__":
+    if len(sys.argv) < 3:
+        print('Usage: ImagePackConverter.py <map file> <output prefix> [<pack size in MB, default 128>]')
+        sys.exit(1)
+    convert(sys.argv[1], sys.argv[2], int(sys.argv[3]) if len(sys.argv) > 3 else 128)
@@ -59,6 +59,8 @@ template <typename ElemType>
 void DoWriteWordAndClassInfo(const ConfigParameters& config);
 template <typename ElemType>
 void DoTopologyPlot(const ConfigParameters& config);
+template <typename ElemType>
+void DoConvertModel(const ConfigParameters& config);
 
 // special purpose (SpecialPurposeActions.cpp)
 template <typename ElemType>
@@ -71,7 +71,7 @@ static void DoEvalBase(const ConfigParameters& config, IDataReader& reader)
         evalNodeNamesVector.push_back(evalNodeNames[i]);
     }
 
-    auto net = ComputationNetwork::CreateFromFile<ElemType>(deviceId, modelPath);
+    auto net = ComputationNetwork::CreateFromFile<ElemType>(deviceId, modelPath, /*readOnly=*/true);
     
     // set tracing flags
     net->EnableNodeTracing(config(L"traceNodeNamesReal",     ConfigParameters::Array(stringargvector())),
@@ -162,7 +162,7 @@ void DoCrossValidate(const ConfigParameters& config)
         }
 
         cvModels.push_back(cvModelPath);
-        auto net = ComputationNetwork::CreateFromFile<ElemType>(deviceId, cvModelPath);
+        auto net = ComputationNetwork::CreateFromFile<ElemType>(deviceId, cvModelPath, /*readOnly=*/true);
         
         SimpleEvaluator<ElemType> eval(net, MPIWrapper::GetInstance(), enableDistributedMBReading, numMBsToShowResult,
             firstMBsToShowResult, traceLevel, maxSamplesInRAM, numSubminiBatches);
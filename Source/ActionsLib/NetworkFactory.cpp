@@ -12,6 +12,8 @@
 #include "ScriptableObjects.h"
 #include "BrainScriptEvaluator.h"
 #include "BrainScriptParser.h"
+#include "MPIWrapper.h"
+#include "fileutil.h"
 
 function<ComputationNetworkPtr(DEVICEID_TYPE)> GetCreateNetworkFn(const ScriptableObjects::IConfigRecord& config)
 {
@@ -34,6 +36,78 @@ function<ComputationNetworkPtr(DEVICEID_TYPE)> GetCreateNetworkFn(const ConfigPa
     NOT_IMPLEMENTED;
 } // old CNTK config does not support lambdas
 
+// content hash of a BrainScript parse tree, used as the key of the network cache
+// Includes are already expanded in the tree, while text locations are ignored, so that editing comments or white space does not invalidate the cache.
+static void HashExpression(uint64_t& hash, const BS::ExpressionPtr& e)
+{
+    if (!e)
+    {
+        FnvHashString(hash, L"<null>");
+        return;
+    }
+    FnvHashString(hash, e->op);
+    FnvHashString(hash, e->id);
+    FnvHashString(hash, e->s);
+    FnvHashBytes(hash, &e->d, sizeof(e->d));
+    let b = (char) e->b;
+    FnvHashBytes(hash, &b, sizeof(b));
+    let numArgs = (uint64_t) e->args.size();
+    FnvHashBytes(hash, &numArgs, sizeof(numArgs));
+    for (let& arg : e->args)
+        HashExpression(hash, arg);
+    let numNamedArgs = (uint64_t) e->namedArgs.size();
+    FnvHashBytes(hash, &numNamedArgs, sizeof(numNamedArgs));
+    for (let& namedArg : e->namedArgs)
+    {
+        FnvHashString(hash, namedArg.first);
+        HashExpression(hash, namedArg.second.second);
+    }
+}
+
+// hash the files a network description may read, e.g. a model for BS.Network.Load() or a parameter's 'initFromFilePath'
+// Any string literal that names an existing file is hashed by its path and contents.
+// Returns false if the description concatenates strings, since then a file name may be computed and cannot be known before evaluation.
+static bool HashReferencedFiles(uint64_t& hash, const BS::ExpressionPtr& e)
+{
+    if (!e)
+        return true;
+    auto_file_ptr f(e->op == L"s" && !e->s.empty() ? _wfopen(e->s.c_str(), L"rb") : nullptr);
+    if (f)
+    {
+        FnvHashString(hash, e->s);
+        vector<char> buffer(1 << 20);
+        for (size_t n; (n = fread(buffer.data(), 1, buffer.size(), f)) > 0;)
+            FnvHashBytes(hash, buffer.data(), n);
+    }
+    if (e->op == L"+" && any_of(e->args.begin(), e->args.end(), [](const BS::ExpressionPtr& arg) { return arg && arg->op == L"s"; }))
+        return false;
+    for (let& arg : e->args)
+        if (!HashReferencedFiles(hash, arg))
+            return false;
+    for (let& namedArg : e->namedArgs)
+        if (!HashReferencedFiles(hash, namedArg.second.second))
+            return false;
+    return true;
+}
+
+// path of the cached network for a parsed BrainScript network description, or empty if no 'networkCacheDir' was given or the network cannot be cached
+// The key also covers the model version, so that cached networks from an older CNTK are not picked up, and the files the description reads.
+static wstring GetNetworkCachePath(const wstring& networkCacheDir, const BS::ExpressionPtr& expr)
+{
+    if (networkCacheDir.empty())
+        return wstring();
+    uint64_t hash = FnvHashSeed;
+    let modelVersion = (uint64_t) CURRENT_CNTK_MODEL_VERSION;
+    FnvHashBytes(hash, &modelVersion, sizeof(modelVersion));
+    HashExpression(hash, expr);
+    if (!HashReferencedFiles(hash, expr))
+    {
+        fprintf(stderr, "BuildNetworkFromDescription: Not caching the network, since its description computes strings that may name files it reads.\n");
+        return wstring();
+    }
+    return msra::strfun::wstrprintf(L"%ls/network_%016llx.dnn", networkCacheDir.c_str(), (unsigned long long) hash);
+}
+
 template <class ConfigRecordType, typename ElemType>
 bool TryGetNetworkFactory(const ConfigRecordType& config, function<ComputationNetworkPtr(DEVICEID_TYPE)>& createNetworkFn)
 {
@@ -91,16 +165,34 @@ bool TryGetNetworkFactory(const ConfigRecordType& config, function<ComputationNe
             (int)deviceId, ElemTypeName<ElemType>(), sourceOfNetwork.c_str());
         let expr = BS::ParseConfigDictFromString(sourceOfBS, L"BrainScriptNetworkBuilder", move(includePaths));
 
+        // optionally cache the evaluated network as a model file keyed by the parse tree, so that later runs with the same network description
+        // (restarts, evaluation, other workers) load it instead of evaluating the BrainScript again
+        wstring networkCacheDir = config(L"networkCacheDir", L"");
+        let networkCachePath = GetNetworkCachePath(networkCacheDir, expr);
+
         // the rest is done in a lambda that is only evaluated when a virgin network is needed
         // Note that evaluating the BrainScript *is* instantiating the network, so the evaluate call must be inside the lambda.
-        createNetworkFn = [expr](DEVICEID_TYPE /*deviceId*/)
+        createNetworkFn = [expr, networkCachePath, deviceId](DEVICEID_TYPE /*deviceId*/)
         {
+            if (!networkCachePath.empty() && fexists(networkCachePath))
+            {
+                fprintf(stderr, "BuildNetworkFromDescription: Loading cached network from '%ls'.\n", networkCachePath.c_str());
+                return ComputationNetwork::CreateFromFile<ElemType>(deviceId, networkCachePath);
+            }
             // evaluate the parse tree, particularly the top-level field 'network'
             // Evaluating it will create the network.
             let object = EvaluateField(expr, L"network");                   // this comes back as a BS::Object
             let network = dynamic_pointer_cast<ComputationNetwork>(object); // cast it
             if (!network)
                 LogicError("BuildNetworkFromDescription: ComputationNetwork not what it was meant to be");
+            // only the main node writes the cache; Save() writes to a temporary file first, so readers never see a partial file
+            let mpi = MPIWrapper::GetInstance();
+            if (!networkCachePath.empty() && (!mpi || mpi->IsMainNode()))
+            {
+                msra::files::make_intermediate_dirs(networkCachePath);
+                network->Save(networkCachePath);
+                fprintf(stderr, "BuildNetworkFromDescription: Cached network as '%ls'.\n", networkCachePath.c_str());
+            }
             // success
             return network;
         };
@@ -172,7 +264,7 @@ ComputationNetworkPtr GetModelFromConfig(const ConfigRecordType& config, vector<
         // We don't use CreateFromFile() here since the user might specify OutputNodeNames in the config.
         // By not compiling the network before patching, we avoid double log output for validation.
         net = make_shared<ComputationNetwork>(deviceId);
-        net->Read<ElemType>(modelPath);
+        net->Read<ElemType>(modelPath, /*readOnly=*/true);
         if (outputNodeNames.size() > 0)
             PatchOutputNodes(net, outputNodeNames, outputNodeNamesVector);
         net->CompileNetwork();
@@ -559,3 +559,34 @@ void DoTopologyPlot(const ConfigParameters& config)
 
 template void DoTopologyPlot<float>(const ConfigParameters& config);
 template void DoTopologyPlot<double>(const ConfigParameters& config);
+
+// ===========================================================================
+// DoConvertModel() - implements CNTK "convertModel" command
+// ===========================================================================
+
+// re-save a model in another file format
+//  - format="mappable": large parameters are stored page-aligned, so that loading a model for evaluation maps them instead
+//    of reading them. CPU processes that evaluate the same model then share the parameter memory through the OS page cache.
+//    Parameters smaller than File::s_minAlignedArraySize (e.g. biases) are stored and read as in the regular format.
+//  - format="binary": the regular model format
+template <typename ElemType>
+void DoConvertModel(const ConfigParameters& config)
+{
+    wstring modelPath       = config(L"modelPath");
+    wstring outputModelPath = config(L"outputModelPath");
+    wstring format          = config(L"format", L"mappable");
+
+    int fileFormat = FileOptions::fileOptionsBinary;
+    if (format == L"mappable")
+        fileFormat |= FileOptions::fileOptionsMappable;
+    else if (format != L"binary")
+        InvalidArgument("convertModel: Unknown format '%ls'. Must be 'mappable' or 'binary'.", format.c_str());
+
+    ComputationNetwork net(CPUDEVICE);
+    net.Load<ElemType>(modelPath);
+    net.Save(outputModelPath, (FileOptions) fileFormat);
+    fprintf(stderr, "Converted model '%ls' to %ls format: '%ls'\n", modelPath.c_str(), format.c_str(), outputModelPath.c_str());
+}
+
+template void DoConvertModel<float>(const ConfigParameters& config);
+template void DoConvertModel<double>(const ConfigParameters& config);
@@ -66,6 +66,58 @@ shared_ptr<C> CreateObject(const ConfigParameters& config, const wchar_t* id)
     return make_shared<C>(readerConfig);                           // old CNTK config specifies a dictionary which then must be explicitly instantiated
 }
 
+// create a reader on the main node first, while the other nodes wait
+// Readers may create files from their data on first use (e.g. LMSequenceReader's 'binaryFile'),
+// which the other nodes then find and only open, rather than all of them writing the same file.
+template <class ConfigRecordType>
+shared_ptr<DataReader> CreateDataReaderOnMainNodeFirst(const ConfigRecordType& config, const wchar_t* id)
+{
+    auto mpi = MPIWrapper::GetInstance();
+    if (mpi && !mpi->IsMainNode())
+        mpi->WaitAll();
+    auto dataReader = CreateObject<DataReader>(config, id);
+    if (mpi && mpi->IsMainNode())
+        mpi->WaitAll();
+    return dataReader;
+}
+
+// append the size and modification time of each file named in a config section, including its sub-sections
+static void AppendFileStamps(const ConfigParameters& config, wstring& text)
+{
+    for (const auto& entry : config)
+    {
+        const string& value = entry.second;
+        if (!value.empty() && value[0] == '[')
+            AppendFileStamps(ConfigParameters(config(entry.first)), text);
+        else if (fexists(value))
+        {
+            let path = msra::strfun::utf16(value);
+            FILETIME time = {};
+            getfiletime(path, time);
+            uint64_t timeHash = FnvHashSeed;
+            FnvHashBytes(timeHash, &time, sizeof(time));
+            text += msra::strfun::wstrprintf(L"\n%ls: %lld bytes, time %016llx", path.c_str(), (long long) filesize64(path.c_str()), (unsigned long long) timeHash);
+        }
+    }
+}
+
+// text of a config section, used to key caches of results that depend on the data (see SGD::SetTrainingDataDescription())
+// The files the section names are described by their size and time, so that the key changes when the data does.
+// BrainScript configs do not retain the source text, so nothing is cached for those.
+static wstring GetConfigSectionText(const ConfigParameters& config, const wchar_t* id)
+{
+    if (!config.Exists(id))
+        return wstring();
+    wstring text = msra::strfun::utf16((const string&) config(id));
+    AppendFileStamps(ConfigParameters(config(id)), text);
+    return text;
+}
+
+static wstring GetConfigSectionText(const ScriptableObjects::IConfigRecord&, const wchar_t*)
+{
+    return wstring();
+}
+
 template <class ConfigRecordType, typename ElemType>
 void DoTrain(const ConfigRecordType& config)
 {
@@ -78,11 +130,11 @@ void DoTrain(const ConfigRecordType& config)
 
     createNetworkFn = GetNetworkFactory<ConfigRecordType, ElemType>(config);
 
-    auto dataReader = CreateObject<DataReader>(config, L"reader");
+    auto dataReader = CreateDataReaderOnMainNodeFirst(config, L"reader");
 
     shared_ptr<DataReader> cvDataReader;
     if (config.Exists(L"cvReader"))
-        cvDataReader = CreateObject<DataReader>(config, L"cvReader");
+        cvDataReader = CreateDataReaderOnMainNodeFirst(config, L"cvReader");
 
     shared_ptr<SGD<ElemType>> optimizer;
     if (config.Exists(L"optimizer"))
@@ -96,6 +148,7 @@ void DoTrain(const ConfigRecordType& config)
     }
 
     optimizer->InitMPI(MPIWrapper::GetInstance());
+    optimizer->SetTrainingDataDescription(GetConfigSectionText(config, L"reader"));
     optimizer->Train(createNetworkFn, deviceId, dataReader.get(), cvDataReader.get(), makeMode);
 }
 
@@ -289,6 +289,10 @@ void DoCommands(const ConfigParameters& config, const shared_ptr<MPIWrapper>& mp
                 {
                     DoTopologyPlot<ElemType>(commandParams);
                 }
+                else if (thisAction == "convertModel")
+                {
+                    DoConvertModel<ElemType>(commandParams);
+                }
                 else if (thisAction == "SVD")
                 {
                     DoParameterSVD<ElemType>(commandParams);
@@ -11,6 +11,7 @@
 #include "Basics.h"
 #define FORMAT_SPECIALIZE // to get the specialized version of the format routines
 #include "File.h"
+#include "MappedFile.h"
 #include <string>
 #include <stdint.h>
 #include <locale>
@@ -19,6 +20,7 @@
 #include "Windows.h"
 #include <VersionHelpers.h>
 #include <Shlwapi.h>
+#include <io.h> // for _commit()
 #pragma comment(lib, "Shlwapi.lib")
 #endif
 #ifdef __unix__
@@ -268,9 +270,19 @@ File::~File(void)
     }
 }
 
+// Flush - flush the stdio buffer; with fileOptionsSync, also wait until the OS has written the data to the device
 void File::Flush()
 {
     fflushOrDie(m_file);
+    if ((m_options & fileOptionsSync) && m_seekable)
+    {
+#ifdef _WIN32
+        if (_commit(_fileno(m_file)) != 0)
+#else
+        if (fsync(fileno(m_file)) != 0)
+#endif
+            RuntimeError("File: failed to commit file %S to disk: %s", m_filename.c_str(), strerror(errno));
+    }
 }
 
 // read a line
@@ -828,6 +840,45 @@ void File::SetPosition(uint64_t pos)
     fsetpos(m_file, pos);
 }
 
+// round a file position up to the alignment of aligned arrays
+static uint64_t AlignArrayPosition(uint64_t pos)
+{
+    return (pos + File::s_arrayAlignment - 1) / File::s_arrayAlignment * File::s_arrayAlignment;
+}
+
+// PutAlignedArray - pad the file to the next aligned position, then write the raw bytes
+void File::PutAlignedArray(const void* data, size_t numBytes)
+{
+    if (IsTextBased())
+        LogicError("File: aligned arrays can only be written to binary files.");
+    static const char padding[s_arrayAlignment] = {};
+    uint64_t pos = GetPosition();
+    fwriteOrDie(padding, 1, (size_t) (AlignArrayPosition(pos) - pos), m_file);
+    fwriteOrDie(data, 1, numBytes, m_file);
+}
+
+// GetAlignedArray - read an array written by PutAlignedArray() into memory
+void File::GetAlignedArray(void* data, size_t numBytes)
+{
+    SetPosition(AlignArrayPosition(GetPosition()));
+    freadOrDie(data, 1, numBytes, m_file);
+}
+
+// MapAlignedArray - return a pointer to an array written by PutAlignedArray() inside the memory-mapped file,
+// and skip over it. Returns nullptr if the file was not opened with fileOptionsMappable or cannot be mapped.
+void* File::MapAlignedArray(size_t numBytes)
+{
+    if (!IsMappable() || !CanSeek() || m_pcloseNeeded)
+        return nullptr;
+    uint64_t pos = AlignArrayPosition(GetPosition());
+    if (!m_mapping)
+        m_mapping = make_shared<MappedFile>(m_filename);
+    if (pos + numBytes > m_mapping->Size())
+        RuntimeError("File: array at position %llu extends beyond the end of '%ls'.", (unsigned long long) pos, m_filename.c_str());
+    SetPosition(pos + numBytes);
+    return m_mapping->Data() + pos;
+}
+
 // helper to load a matrix from a stream (file or string literal)
 // The input string is expected to contain one line per matrix row (natural printing order for humans).
 // Inputs:
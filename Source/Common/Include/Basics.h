@@ -587,6 +587,32 @@ static wstring TypeId()
     return msra::strfun::utf16(typeid(C).name());
 }
 
+// ----------------------------------------------------------------------------
+// FNV-1a hash, for keys that must be stable across processes and builds (unlike std::hash), e.g. names of cache files
+// ----------------------------------------------------------------------------
+
+static const uint64_t FnvHashSeed = 14695981039346656037ull;
+
+static inline void FnvHashBytes(uint64_t& hash, const void* data, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= ((const unsigned char*) data)[i];
+        hash *= 1099511628211ull;
+    }
+}
+
+static inline void FnvHashString(uint64_t& hash, const wstring& s)
+{
+    let size = (uint64_t) s.size();
+    FnvHashBytes(hash, &size, sizeof(size));
+    for (auto c : s) // (hash characters as 32 bit, since wchar_t differs between Windows and Linux)
+    {
+        let c32 = (uint32_t) c;
+        FnvHashBytes(hash, &c32, sizeof(c32));
+    }
+}
+
 // ----------------------------------------------------------------------------
 // dynamic loading of modules  --TODO: not Basics, should move to its own header
 // ----------------------------------------------------------------------------
@@ -25,6 +25,7 @@
 #include <map>
 #include <vector>
 #include <string>
+#include <stdexcept>
 
 namespace Microsoft { namespace MSR { namespace CNTK {
 
@@ -211,6 +212,67 @@ struct ValueBuffer
 template <typename ElemType>
 using Values = std::vector<ValueBuffer<ElemType>>;
 
+//
+// A non-owning view of an array, used in place of a std::vector if the memory is managed by the caller.
+// It provides the subset of the std::vector interface used by the evaluation API.
+//
+template <typename T>
+struct VectorRef
+{
+    T* m_vector;       // memory, owned by the caller
+    size_t m_capacity; // number of elements allocated
+    size_t m_size;     // number of elements in use
+
+    VectorRef() : m_vector(nullptr), m_capacity(0), m_size(0) {}
+    VectorRef(T* data, size_t capacity, size_t size) : m_vector(data), m_capacity(capacity), m_size(size) {}
+
+    void InitFrom(std::vector<T>& src) { InitFrom(src.data(), src.capacity(), src.size()); }
+    void InitFrom(T* data, size_t capacity, size_t size)
+    {
+        m_vector = data;
+        m_capacity = capacity;
+        m_size = size;
+    }
+
+    size_t size() const { return m_size; }
+    size_t capacity() const { return m_capacity; }
+    bool empty() const { return m_size == 0; }
+    void resize(size_t size)
+    {
+        if (size > m_capacity)
+            throw std::length_error("VectorRef: cannot grow beyond the capacity of the referenced memory.");
+        m_size = size;
+    }
+
+    T* data() { return m_vector; }
+    const T* data() const { return m_vector; }
+    T* begin() { return m_vector; }
+    T* end() { return m_vector + m_size; }
+    const T* begin() const { return m_vector; }
+    const T* end() const { return m_vector + m_size; }
+    T& operator[](size_t idx) { return m_vector[idx]; }
+    const T& operator[](size_t idx) const { return m_vector[idx]; }
+};
+
+//
+// Same as ValueBuffer, but referring to memory owned by the caller. This allows to evaluate without copying
+// the data into (and out of) vectors allocated by the evaluator.
+// For dense inputs on the CPU, the memory is bound directly to the input matrix of the network. It must stay
+// valid and unchanged until the ForwardPass() call returns.
+// For outputs, m_buffer may be left unset (nullptr). It then borrows the memory of the network's output
+// matrix if possible, which stays valid until the next call to ForwardPass().
+//
+template <typename ElemType>
+struct ValueBufferRef
+{
+    VectorRef<ElemType> m_buffer;
+    VectorRef<int> m_indices;
+    VectorRef<int> m_colIndices;
+};
+
+template <typename ElemType>
+using ValueRefs = std::vector<ValueBufferRef<ElemType>>;
+
 //
 // Meta data
 //
@@ -262,7 +324,7 @@ class VariableSchema : public std::vector<VariableLayout>
 //
 // Extended interface, allowing for sparse input.
 // Implementation constraints: 
-// - Every output is a single tensor (not a batch), 
+// - Every output is a single sequence per input sequence (several sequences can be evaluated in one batch),
 // - Outputs must be dense.
 // - Output buffer must be preallocated.
 //
@@ -300,6 +362,30 @@ public:
     // outputs - vector of output buffers. Must be sized to fit output schema.
     //
     virtual void ForwardPass(const Values<ElemType>& inputs, Values<ElemType>& output) = 0;
+
+    //
+    // ForwardPass - Same as above, but using caller-owned memory for inputs and outputs (see ValueBufferRef).
+    //
+    virtual void ForwardPass(const ValueRefs<ElemType>& inputs, ValueRefs<ElemType>& output) = 0;
+
+    //
+    // ForwardPass - Evaluate several independent (variable length) sequences in a single forward pass.
+    // The sequences are packed side by side into one minibatch, so that the network operates on larger matrices
+    // than when calling ForwardPass() for each sequence. The outputs are split back per sequence.
+    // inputs - one entry per sequence; every entry is a vector of input buffers as for the single-sequence version
+    // outputs - one entry per sequence; every entry must be sized to fit the output schema for that sequence.
+    //
+    virtual void ForwardPass(const std::vector<Values<ElemType>>& inputs, std::vector<Values<ElemType>>& outputs) = 0;
+
+    //
+    // Clone - Create another evaluator for the same model, to be used on a different thread.
+    // The clone shares the (read-only) model parameters with this instance and only owns its own activations,
+    // so that N workers do not need N copies of the model. If StartForwardEvaluation() has been called, the clone
+    // is started with the same outputs.
+    // This method is thread-safe: it can be called while another thread runs ForwardPass() on this instance.
+    // The clone must be released with Destroy().
+    //
+    virtual IEvaluateModelExtended<ElemType>* Clone() = 0;
 };
 
 template <typename ElemType>
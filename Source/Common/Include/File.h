@@ -19,11 +19,14 @@
 #include "fileutil.h" // for f{ge,pu}t{,Text}()
 #include <fstream>    // for LoadMatrixFromTextFile() --TODO: change to using this File class
 #include <sstream>
+#include <memory>
 
 namespace Microsoft { namespace MSR { namespace CNTK {
 
 using namespace std;
 
+class MappedFile;
+
 // file options, Type of textfile to use
 enum FileOptions
 {
@@ -34,6 +37,8 @@ enum FileOptions
     fileOptionsRead = 8,                                        // open in read mode
     fileOptionsWrite = 16,                                      // open in write mode
     fileOptionsSequential = 32,                                 // optimize for sequential reads (allocates big buffer)
+    fileOptionsMappable = 64,                                   // binary only: write large arrays page-aligned, and read them from a memory mapping of the file
+    fileOptionsSync = 128,                                      // writing: Flush() also commits the data to the storage device (fsync), e.g. for checkpoints
     fileOptionsReadWrite = fileOptionsRead | fileOptionsWrite,  // read/write mode
 };
 
@@ -99,6 +104,7 @@ private:
     bool m_pcloseNeeded; // was opened with popen(), use pclose() when destructing
     bool m_seekable;     // this stream is seekable
     int m_options;       // FileOptions ored togther
+    std::shared_ptr<MappedFile> m_mapping; // memory mapping of the file, created on demand by MapAlignedArray()
     void Init(const wchar_t* filename, int fileOptions);
 
 public:
@@ -195,6 +201,32 @@ public:
         return *this;
     }
 
+    // bulk I/O of an array of basic types
+    // Binary files transfer the whole array with a single fwrite()/fread() call; the on-disk format is the same as
+    // that of a loop over operator<< resp. operator>>, which text files still use.
+    template <typename T>
+    void WriteArray(const T* data, size_t count)
+    {
+        if (IsTextBased())
+        {
+            for (size_t i = 0; i < count; i++)
+                *this << data[i];
+        }
+        else if (count > 0)
+            fwriteOrDie(data, sizeof(*data), count, m_file);
+    }
+    template <typename T>
+    void ReadArray(T* data, size_t count)
+    {
+        if (IsTextBased())
+        {
+            for (size_t i = 0; i < count; i++)
+                *this >> data[i];
+        }
+        else if (count > 0)
+            freadOrDie(data, sizeof(*data), count, m_file);
+    }
+
     void WriteString(const char* str, int size = 0);                   // zero terminated strings use size=0
     void ReadString(char* str, int size);                              // read up to size bytes, or a zero terminator (or space in text mode)
     void WriteString(const wchar_t* str, int size = 0);                // zero terminated strings use size=0
@@ -248,6 +280,20 @@ public:
         return *this;
     }
 
+    // Aligned arrays store raw binary data at a file position that is a multiple of s_arrayAlignment, so that a reader
+    // can use them in place from a memory mapping of the file (fileOptionsMappable) instead of reading them.
+    // Only arrays of at least s_minAlignedArraySize bytes are worth it; the padding to align a smaller one would cost more than mapping it saves.
+    static const size_t s_arrayAlignment = 4096;
+    static const size_t s_minAlignedArraySize = 16 * s_arrayAlignment;
+    bool IsMappable() const { return !!(m_options & fileOptionsMappable) && !(m_options & fileOptionsText); }
+    void PutAlignedArray(const void* data, size_t numBytes);
+    void GetAlignedArray(void* data, size_t numBytes);
+    // returns a pointer to the array inside the (copy-on-write) memory mapping of the file, or nullptr if this file
+    // cannot be mapped, in which case the caller must use GetAlignedArray(). The mapping stays valid as long as a
+    // reference obtained from GetMapping() is held.
+    void* MapAlignedArray(size_t numBytes);
+    std::shared_ptr<MappedFile> GetMapping() const { return m_mapping; }
+
     operator FILE*() const { return m_file; }
 
     // Read a matrix stored in text format from 'filePath' (whitespace-separated columns, newline-separated rows),
@@ -0,0 +1,124 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// MappedFile.h -- memory mapping of an entire file for reading
+//
+// The mapping is copy-on-write: pages are shared with the OS page cache (and thus with all other processes that
+// map the same file) until they are written to, which creates a private copy of that page. Modifications are
+// never written back to the file.
+//
+
+#pragma once
+
+#include "Basics.h"
+#include <string>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include "Windows.h"
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+class MappedFile
+{
+    char* m_data;
+    size_t m_size;
+#ifdef _WIN32
+    HANDLE m_hFile;
+    HANDLE m_hMapping;
+#endif
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+public:
+    explicit MappedFile(const std::wstring& path)
+        : m_data(nullptr), m_size(0)
+    {
+#ifdef _WIN32
+        m_hMapping = NULL;
+        m_hFile = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (m_hFile == INVALID_HANDLE_VALUE)
+            RuntimeError("MappedFile: cannot open '%ls' (error %d).", path.c_str(), (int) GetLastError());
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(m_hFile, &size))
+        {
+            int err = (int) GetLastError();
+            Close();
+            RuntimeError("MappedFile: cannot determine size of '%ls' (error %d).", path.c_str(), err);
+        }
+        m_size = (size_t) size.QuadPart;
+        if (m_size == 0) // empty files cannot be mapped
+            return;
+        m_hMapping = CreateFileMappingW(m_hFile, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+        if (m_hMapping != NULL)
+            m_data = (char*) MapViewOfFile(m_hMapping, FILE_MAP_COPY, 0, 0, 0);
+        if (m_data == nullptr)
+        {
+            int err = (int) GetLastError();
+            Close();
+            RuntimeError("MappedFile: cannot map '%ls' (error %d).", path.c_str(), err);
+        }
+#else
+        std::string pathUtf8 = msra::strfun::utf8(path);
+        int fd = open(pathUtf8.c_str(), O_RDONLY);
+        if (fd < 0)
+            RuntimeError("MappedFile: cannot open '%s': %s", pathUtf8.c_str(), strerror(errno));
+        struct stat st;
+        if (fstat(fd, &st) != 0)
+        {
+            close(fd);
+            RuntimeError("MappedFile: cannot determine size of '%s': %s", pathUtf8.c_str(), strerror(errno));
+        }
+        m_size = (size_t) st.st_size;
+        if (m_size > 0)
+        {
+            void* data = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+            if (data == MAP_FAILED)
+            {
+                close(fd);
+                RuntimeError("MappedFile: cannot map '%s': %s", pathUtf8.c_str(), strerror(errno));
+            }
+            m_data = (char*) data;
+        }
+        close(fd); // the mapping keeps its own reference to the file
+#endif
+    }
+
+    ~MappedFile()
+    {
+        Close();
+    }
+
+    char* Data() const { return m_data; }
+    size_t Size() const { return m_size; }
+
+private:
+    void Close()
+    {
+#ifdef _WIN32
+        if (m_data)
+            UnmapViewOfFile(m_data);
+        if (m_hMapping)
+            CloseHandle(m_hMapping);
+        CloseHandle(m_hFile);
+#else
+        if (m_data)
+            munmap(m_data, m_size);
+#endif
+        m_data = nullptr;
+    }
+};
+
+}}}
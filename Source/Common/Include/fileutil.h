@@ -603,15 +603,20 @@ std::vector<char*> fgetfilelines(const std::wstring& pathname, std::vector<char>
 
 }}
 
-#ifdef _WIN32
 // ----------------------------------------------------------------------------
 // getfiletime(), setfiletime(): access modification time
 // ----------------------------------------------------------------------------
 
+#ifndef _FILETIME_
+//typedef struct _FILETIME { DWORD dwLowDateTime; DWORD dwHighDateTime; };    // from minwindef.h
+typedef time_t FILETIME;
+#endif
+
 bool getfiletime(const std::wstring& path, FILETIME& time);
+#ifdef _WIN32
 void setfiletime(const std::wstring& path, const FILETIME& time);
-
 #endif
+
 // ----------------------------------------------------------------------------
 // expand_wildcards() -- expand a path with wildcards (also intermediate ones)
 // ----------------------------------------------------------------------------
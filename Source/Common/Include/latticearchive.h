@@ -17,8 +17,10 @@
 #include "latticestorage.h"
 #include "simple_checked_arrays.h"
 #include "fileutil.h"
+#include "MappedFile.h"
 #include <vector>
 #include <string>
+#include <memory>
 #include <unordered_map>
 #include <algorithm> // for find()
 #include "simplesenonehmm.h"
@@ -990,79 +992,149 @@ public:
             freadvector(f, "EDGS", edges2, info.numedges); // uniqued edges
             freadvector(f, "ALNS", uniquededgedatatokens); // uniqued alignments
             fcheckTag(f, "END ");
+            finishreadv2(idmap, spunit);
+        }
+        else
+            RuntimeError("fread: unsupported lattice format version");
+    }
+
+    // read a lattice from a record of a mapped lattice archive, see fwritemapped()
+    // Same semantics as fread(); the arrays are copied straight out of the mapped memory, no tag parsing or I/O calls are involved.
+    // 'size' is the number of bytes from 'p' to the end of the mapping. Each array is checked against it, so a corrupt record fails instead of reading beyond the mapping.
+    template <class IDMAP>
+    void readmapped(const char* p, size_t size, const IDMAP& idmap, size_t spunit)
+    {
+        size_t offset = 0; // of the next array, relative to p
+        auto nextarray = [&](uint64_t count, size_t elementsize) -> const char*
+        {
+            if (offset > size || count > (size - offset) / elementsize)
+                RuntimeError("readmapped: lattice record extends beyond the end of the mapped archive");
+            const char* array = p + offset;
+            offset = mappedpad(offset + (size_t) count * elementsize);
+            return array;
+        };
+        memcpy(&info, nextarray(1, sizeof(info)), sizeof(info));
+        uint64_t numtokens;
+        memcpy(&numtokens, nextarray(1, sizeof(numtokens)), sizeof(numtokens));
+        const auto* pnodes = (const nodeinfo*) nextarray(info.numnodes, sizeof(nodeinfo));
+        nodes.assign(pnodes, pnodes + info.numnodes);
+        const auto* pedges = (const edgeinfo*) nextarray(info.numedges, sizeof(edgeinfo));
+        edges2.assign(pedges, pedges + info.numedges);
+        const auto* ptokens = (const aligninfo*) nextarray(numtokens, sizeof(aligninfo));
+        uniquededgedatatokens.assign(ptokens, ptokens + numtokens);
+        if (nodes.empty() || nodes.back().t != info.numframes)
+            RuntimeError("readmapped: mismatch between info.numframes and last node's time");
+        finishreadv2(idmap, spunit);
+    }
+
+    // write a lattice as a record of a mapped lattice archive (must be in uniqued V2 form, cf. builduniquealignments())
+    // Layout: info, #tokens (uint64), nodes, edges2, uniquededgedatatokens; each array starts 8-byte aligned relative to the record,
+    // and records themselves are written at 8-byte aligned file offsets.
+    void fwritemapped(FILE* f) const
+    {
+        const uint64_t start = fgetpos(f);
+        if (start % mappedalignment != 0)
+            LogicError("fwritemapped: record not aligned");
+        const uint64_t numtokens = uniquededgedatatokens.size();
+        fwriteOrDie(&info, sizeof(info), 1, f);
+        fwriteOrDie(&numtokens, sizeof(numtokens), 1, f);
+        fwriteOrDie(nodes.data(), sizeof(nodeinfo), nodes.size(), f);
+        fwritemappedpadding(f);
+        fwriteOrDie(edges2.data(), sizeof(edgeinfo), edges2.size(), f);
+        fwritemappedpadding(f);
+        fwriteOrDie(uniquededgedatatokens.data(), sizeof(aligninfo), uniquededgedatatokens.size(), f);
+        fwritemappedpadding(f);
+    }
+
+    static const size_t mappedalignment = 8;
+    static size_t mappedpad(size_t n)
+    {
+        return (n + mappedalignment - 1) / mappedalignment * mappedalignment;
+    }
+    static void fwritemappedpadding(FILE* f)
+    {
+        static const char zeros[mappedalignment] = {0};
+        const size_t pos = (size_t) fgetpos(f);
+        if (mappedpad(pos) != pos)
+            fwriteOrDie(zeros, 1, mappedpad(pos) - pos, f);
+    }
+
+private:
+    // V2 lattices are read in uniqued form; this maps them to the user's symbol map and rebuilds edges and align
+    template <class IDMAP>
+    void finishreadv2(const IDMAP& idmap, size_t spunit)
+    {
 // check if we need to map
 #if 1                                                                                     // post-bugfix for incorrect inference of spunit
-            if (info.impliedspunitid != SIZE_MAX && info.impliedspunitid >= idmap.size()) // we have buggy lattices like that--what do they mean??
-            {
-                fprintf(stderr, "fread: detected buggy spunit id %d which is out of range (%d entries in map)\n", (int) info.impliedspunitid, (int) idmap.size());
-                RuntimeError("fread: out of bounds spunitid");
-            }
+        if (info.impliedspunitid != SIZE_MAX && info.impliedspunitid >= idmap.size()) // we have buggy lattices like that--what do they mean??
+        {
+            fprintf(stderr, "fread: detected buggy spunit id %d which is out of range (%d entries in map)\n", (int) info.impliedspunitid, (int) idmap.size());
+            RuntimeError("fread: out of bounds spunitid");
+        }
 #endif
-            // This is critical--we have a buggy lattice set that requires no mapping where mapping would fail
-            bool needsmapping = false;
-            foreach_index (k, idmap)
-            {
-                if (idmap[k] != (size_t) k
+        // This is critical--we have a buggy lattice set that requires no mapping where mapping would fail
+        bool needsmapping = false;
+        foreach_index (k, idmap)
+        {
+            if (idmap[k] != (size_t) k
 #if 1
-                    && (k != (int) idmap.size() - 1 || idmap[k] != spunit) // that HACK that we add one more /sp/ entry at the end...
+                && (k != (int) idmap.size() - 1 || idmap[k] != spunit) // that HACK that we add one more /sp/ entry at the end...
 #endif
-                    )
-                {
-                    needsmapping = true;
-                    break;
-                }
+                )
+            {
+                needsmapping = true;
+                break;
             }
-            // map align ids to user's symmap  --the lattice gets updated in place here
-            if (needsmapping)
+        }
+        // map align ids to user's symmap  --the lattice gets updated in place here
+        if (needsmapping)
+        {
+            if (info.impliedspunitid != SIZE_MAX)
+                info.impliedspunitid = idmap[info.impliedspunitid];
+
+            // deal with broken (zero-token) edges
+            std::vector<bool> isendworkaround;
+            if (info.impliedspunitid != spunit)
             {
-                if (info.impliedspunitid != SIZE_MAX)
-                    info.impliedspunitid = idmap[info.impliedspunitid];
+                fprintf(stderr, "fread: lattice with broken spunit, using workaround to handle potentially broken zero-token edges\n");
+                inferends(isendworkaround);
+            }
 
-                // deal with broken (zero-token) edges
-                std::vector<bool> isendworkaround;
-                if (info.impliedspunitid != spunit)
+            size_t uniquealignments = 1;
+            const size_t skipscoretokens = info.hasacscores ? 2 : 1;
+            for (size_t k = skipscoretokens; k < uniquededgedatatokens.size(); k++)
+            {
+                if (!isendworkaround.empty() && isendworkaround[k]) // secondary criterion to detect ends in broken lattices
                 {
-                    fprintf(stderr, "fread: lattice with broken spunit, using workaround to handle potentially broken zero-token edges\n");
-                    inferends(isendworkaround);
+                    k--; // don't advance, since nothing to advance over
                 }
-
-                size_t uniquealignments = 1;
-                const size_t skipscoretokens = info.hasacscores ? 2 : 1;
-                for (size_t k = skipscoretokens; k < uniquededgedatatokens.size(); k++)
+                else
                 {
-                    if (!isendworkaround.empty() && isendworkaround[k]) // secondary criterion to detect ends in broken lattices
-                    {
-                        k--; // don't advance, since nothing to advance over
-                    }
-                    else
-                    {
-                        // this is a regular token: update it in-place
-                        auto& ai = uniquededgedatatokens[k];
-                        if (ai.unit >= idmap.size())
-                            RuntimeError("fread: broken-file heuristics failed");
-                        ai.updateunit(idmap); // updates itself
-                        if (!ai.last)
-                            continue;
-                    }
-                    // if last then skip over the lm and ac scores
-                    k += skipscoretokens;
-                    uniquealignments++;
+                    // this is a regular token: update it in-place
+                    auto& ai = uniquededgedatatokens[k];
+                    if (ai.unit >= idmap.size())
+                        RuntimeError("fread: broken-file heuristics failed");
+                    ai.updateunit(idmap); // updates itself
+                    if (!ai.last)
+                        continue;
                 }
-                fprintf(stderr, "fread: mapped %d unique alignments\n", (int) uniquealignments);
-            }
-            if (info.impliedspunitid != spunit)
-            {
-                // fprintf (stderr, "fread: inconsistent spunit id in file %d vs. expected %d; due to erroneous heuristic\n", info.impliedspunitid, spunit);    // [v-hansu] comment out becaues it takes up most of the log
-                // it's actually OK, we can live with this, since we only decompress and then move on without any assumptions
-                // RuntimeError("fread: mismatching /sp/ units");
+                // if last then skip over the lm and ac scores
+                k += skipscoretokens;
+                uniquealignments++;
             }
-            // reconstruct old lattice format from this   --TODO: remove once we change to new data representation
-            rebuildedges(info.impliedspunitid != spunit /*to be able to read somewhat broken V2 lattice archives*/);
+            fprintf(stderr, "fread: mapped %d unique alignments\n", (int) uniquealignments);
         }
-        else
-            RuntimeError("fread: unsupported lattice format version");
+        if (info.impliedspunitid != spunit)
+        {
+            // fprintf (stderr, "fread: inconsistent spunit id in file %d vs. expected %d; due to erroneous heuristic\n", info.impliedspunitid, spunit);    // [v-hansu] comment out becaues it takes up most of the log
+            // it's actually OK, we can live with this, since we only decompress and then move on without any assumptions
+            // RuntimeError("fread: mismatching /sp/ units");
+        }
+        // reconstruct old lattice format from this   --TODO: remove once we change to new data representation
+        rebuildedges(info.impliedspunitid != spunit /*to be able to read somewhat broken V2 lattice archives*/);
     }
 
+public:
     // parallel versions (defined in parallelforwardbackward.cpp)
     class parallelstate
     {
@@ -1213,6 +1285,124 @@ class archive
     mutable size_t currentarchiveindex;               // which archive is open
     mutable auto_file_ptr f;                          // cached archive file handle of currentarchiveindex
     std::unordered_map<std::wstring, latticeref> toc; // [key] -> (file, offset)  --table of content (.toc file)
+
+    // mapped lattice archives (.latmap), written by convertmapped()
+    // These are self-indexed and are accessed through a memory mapping, so there is neither a TOC to parse nor any file I/O per lattice.
+    // Layout: mappedheader; lattice records (see lattice::fwritemapped(), 8-byte aligned); keys (UTF-8, 0-terminated);
+    // hash index of 'numbuckets' mappedindexentry's (open addressing with linear probing; recordoffset 0 marks an empty bucket).
+    // Like regular archives, the units are given by a .symlist file next to the archive.
+    struct mappedheader
+    {
+        char magic[8]; // "LATMAP01"
+        uint64_t numlattices;
+        uint64_t numbuckets; // power of 2
+        uint64_t indexoffset;
+    };
+    struct mappedindexentry
+    {
+        uint64_t hash;
+        uint64_t keyoffset;
+        uint64_t recordoffset;
+    };
+    static_assert(sizeof(mappedheader) == 32 && sizeof(mappedindexentry) == 24, "unexpected byte size of mapped lattice archive structures");
+    static const char* mappedmagic()
+    {
+        return "LATMAP01";
+    }
+    static bool ismappedpath(const std::wstring& path)
+    {
+        const std::wstring ext = L".latmap";
+        return path.size() >= ext.size() && path.compare(path.size() - ext.size(), ext.size(), ext) == 0;
+    }
+    static uint64_t mappedhash(const std::string& key) // FNV-1a
+    {
+        uint64_t h = 14695981039346656037ull;
+        for (unsigned char c : key)
+            h = (h ^ c) * 1099511628211ull;
+        return h;
+    }
+    struct mappedarchive
+    {
+        std::shared_ptr<Microsoft::MSR::CNTK::MappedFile> file;
+        size_t archiveindex; // into archivepaths[] and symmaps[]
+
+        const mappedheader& header() const
+        {
+            return *(const mappedheader*) file->Data();
+        }
+        // get the record of a lattice and its size up to the end of the mapping, or nullptr if not in this archive
+        const char* find(const std::string& key, size_t& recordsize) const
+        {
+            const auto& h = header();
+            const auto* index = (const mappedindexentry*) (file->Data() + h.indexoffset);
+            const uint64_t hash = mappedhash(key);
+            for (uint64_t b = hash & (h.numbuckets - 1);; b = (b + 1) & (h.numbuckets - 1))
+            {
+                const auto& entry = index[b];
+                if (entry.recordoffset == 0)
+                    return nullptr;
+                if (entry.recordoffset >= file->Size() || entry.keyoffset >= file->Size())
+                    RuntimeError("find: index entry points beyond the end of the mapped lattice archive");
+                if (entry.hash == hash && haskey(entry.keyoffset, key))
+                {
+                    recordsize = file->Size() - (size_t) entry.recordoffset;
+                    return file->Data() + entry.recordoffset;
+                }
+            }
+        }
+        // compare the 0-terminated key at 'keyoffset', without reading beyond the mapping
+        bool haskey(uint64_t keyoffset, const std::string& key) const
+        {
+            const char* p = file->Data() + keyoffset;
+            return file->Size() - keyoffset > key.size() && memcmp(p, key.data(), key.size()) == 0 && p[key.size()] == 0;
+        }
+    };
+    std::vector<mappedarchive> mappedarchives;
+
+    void openmapped(const std::wstring& path)
+    {
+        mappedarchive a;
+        a.file = std::make_shared<Microsoft::MSR::CNTK::MappedFile>(path);
+        if (a.file->Size() < sizeof(mappedheader) || memcmp(a.header().magic, mappedmagic(), sizeof(a.header().magic)) != 0)
+            RuntimeError("openmapped: '%ls' is not a mapped lattice archive", path.c_str());
+        const auto& h = a.header();
+        if (h.numbuckets == 0 || (h.numbuckets & (h.numbuckets - 1)) != 0 || h.numlattices >= h.numbuckets ||
+            h.indexoffset + h.numbuckets * sizeof(mappedindexentry) > a.file->Size())
+            RuntimeError("openmapped: malformed index in mapped lattice archive '%ls'", path.c_str());
+        a.archiveindex = getarchiveindex(path);
+        mappedarchives.push_back(a);
+    }
+
+    // find a lattice in the mapped archives; returns nullptr if not found
+    const char* findmapped(const std::wstring& key, size_t& archiveindex, size_t& recordsize) const
+    {
+        if (mappedarchives.empty())
+            return nullptr;
+        const std::string key8 = msra::strfun::utf8(key);
+        for (const auto& a : mappedarchives)
+        {
+            const char* record = a.find(key8, recordsize);
+            if (record)
+            {
+                archiveindex = a.archiveindex;
+                return record;
+            }
+        }
+        return nullptr;
+    }
+
+    // get the mapping of an archive's units to the model's, and the /sp/ unit
+    const symbolidmapping& getidmap(size_t archiveindex, size_t& spunit) const
+    {
+        auto& idmap = getcachedidmap(archiveindex, modelsymmap); // at first time, this will load the .symlist file and create a mapping to the user SYMMAP
+        spunit = idmap.back();                                   // ugh--getcachedidmap() just appends it to the end
+#if 1                                                            // prep for fixing the pushing of /sp/ at the end  --we actually can just look it up! Duh
+        const size_t spunit2 = getid(modelsymmap, "sp");
+        if (spunit2 != spunit)
+            LogicError("getlattice: huh? same lookup of /sp/ gives different result?");
+#endif
+        return idmap;
+    }
 public:
     // construct = open the archive
     // archive() : currentarchiveindex (SIZE_MAX) {}
@@ -1240,14 +1430,25 @@ public:
                 fprintf(stderr, ".");
             open(tocpaths[i]);
         }
-        fprintf(stderr, " %d total lattices referenced in %d archive files\n", (int) toc.size(), (int) archivepaths.size());
+        size_t numlattices = toc.size();
+        for (const auto& a : mappedarchives)
+            numlattices += (size_t) a.header().numlattices;
+        fprintf(stderr, " %d total lattices referenced in %d archive files\n", (int) numlattices, (int) archivepaths.size());
     }
 
     // open an archive
     // Can be called for multiple archives.
     // BUGBUG: NOT YET. We only really support one archive file at this point. Important to do that though.
+    // A mapped lattice archive (.latmap) can be passed instead of a TOC file.
     void open(const std::wstring& tocpath)
     {
+        if (ismappedpath(tocpath))
+        {
+            openmapped(tocpath);
+            symmaps.resize(archivepaths.size());
+            return;
+        }
+
         // BUGBUG: we only really support one archive file at this point
         // read the TOC in one swoop
         std::vector<char> textbuffer;
@@ -1298,7 +1499,8 @@ public:
     // check if a lattice for a given key is available  --do this during initial check ideally
     bool haslattice(const std::wstring& key) const
     {
-        return toc.find(key) != toc.end();
+        size_t archiveindex, recordsize;
+        return toc.find(key) != toc.end() || findmapped(key, archiveindex, recordsize) != nullptr;
     }
 
 #if 0 // TODO: change design to keep the #frames in the TOC, so we can check for mismatches before entering the training iteration
@@ -1322,19 +1524,35 @@ public:
                     size_t expectedframes = SIZE_MAX /*if unknown*/) const
     {
         auto iter = toc.find(key);
-        if (iter == toc.end())
-            LogicError("getlattice: requested lattice for non-existent key; haslattice() should have been used to check availability");
+        if (iter != toc.end())
+            getlatticefromarchivefile(iter->second, L);
+        else
+        {
+            size_t archiveindex, recordsize;
+            const char* record = findmapped(key, archiveindex, recordsize);
+            if (!record)
+                LogicError("getlattice: requested lattice for non-existent key; haslattice() should have been used to check availability");
+            size_t spunit;
+            auto& idmap = getidmap(archiveindex, spunit);
+            L.readmapped(record, recordsize, idmap, spunit);
+            L.setverbosity(verbosity);
+        }
+        // check if number of frames is as expected
+        if (expectedframes != SIZE_MAX && L.getnumframes() != expectedframes)
+            LogicError("getlattice: number of frames mismatch between numerator lattice and features");
+        // remember the latice key for diagnostics messages
+        L.key = key;
+    };
+
+private:
+    void getlatticefromarchivefile(const latticeref& ref, lattice& L) const
+    {
         // get the archive that the lattice lives in and its byte offset
-        const size_t archiveindex = iter->second.archiveindex;
-        const auto offset = iter->second.offset;
+        const size_t archiveindex = ref.archiveindex;
+        const auto offset = ref.offset;
         // get id map (used below); this may lazily load a .symlist file. We do it here rather than later w.r.t. an outer retry loop.
-        auto& idmap = getcachedidmap(archiveindex, modelsymmap); // at first time, this will load the .symlist file and create a mapping to the user SYMMAP
-        const size_t spunit = idmap.back();                      // ugh--getcachedidmap() just appends it to the end
-#if 1                                                            // prep for fixing the pushing of /sp/ at the end  --we actually can just look it up! Duh
-        const size_t spunit2 = getid(modelsymmap, "sp");
-        if (spunit2 != spunit)
-            LogicError("getlattice: huh? same lookup of /sp/ gives different result?");
-#endif
+        size_t spunit;
+        auto& idmap = getidmap(archiveindex, spunit);
         // open archive file in case it is not the current one
         if (archiveindex != currentarchiveindex)
         {
@@ -1360,13 +1578,9 @@ public:
             f = NULL; // this closes the file handle
             throw;
         }
-        // check if number of frames is as expected
-        if (expectedframes != SIZE_MAX && L.getnumframes() != expectedframes)
-            LogicError("getlattice: number of frames mismatch between numerator lattice and features");
-        // remember the latice key for diagnostics messages
-        L.key = key;
-    };
+    }
 
+public:
     // static method for building an archive
     static void build(const std::vector<std::wstring>& infiles, const std::wstring& outpath,
                       const std::unordered_map<std::string, size_t>& modelsymmap,
@@ -1380,6 +1594,11 @@ public:
     //  - merge two lattices (for merging numer into denom lattices)
     static void convert(const std::wstring& intocpath, const std::wstring& intocpath2, const std::wstring& outpath,
                         const msra::asr::simplesenonehmm& hset);
+
+    // static method for converting archives into a mapped lattice archive (outpath should end in .latmap; a .symlist is written next to it)
+    // Used by the HTKMLFReader to create the archive given by 'denLatMappedArchive' on first use.
+    static void convertmapped(const std::vector<std::wstring>& intocpaths, const std::wstring& outpath,
+                              const std::unordered_map<std::string, size_t>& modelsymmap, const std::wstring& prefixPath = L"");
 };
 };
 };
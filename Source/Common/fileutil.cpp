@@ -1667,10 +1667,7 @@ vector<char*> msra::files::fgetfilelines(const wstring& path, vector<char>& buff
 // getfiletime(): access modification time
 // ----------------------------------------------------------------------------
 
-#ifndef _FILETIME_
-//typedef struct _FILETIME { DWORD dwLowDateTime; DWORD dwHighDateTime; };    // from minwindef.h
-typedef time_t FILETIME;
-#else
+#ifdef _FILETIME_
 bool operator>=(const FILETIME& targettime, const FILETIME& inputtime) // for use in fuptodate()
 {
     return (targettime.dwHighDateTime > inputtime.dwHighDateTime) ||
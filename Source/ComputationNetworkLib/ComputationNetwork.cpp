@@ -260,11 +260,15 @@ void ComputationNetwork::ReadPersistableParameters(File& fstream, bool create)
 // deserialize the model
 // This does not post-process the model (CompileNetwork()). Use Load() instead.
 template <class ElemType> // for ReadPersistableParameters()
-void ComputationNetwork::Read(const wstring& fileName)
+void ComputationNetwork::Read(const wstring& fileName, bool readOnly)
 {
     ClearNetwork();
 
-    File fstream(fileName, FileOptions::fileOptionsBinary | FileOptions::fileOptionsRead);
+    // models saved with fileOptionsMappable get their parameters mapped rather than read, unless they are to be modified
+    int fileOptions = FileOptions::fileOptionsBinary | FileOptions::fileOptionsRead;
+    if (readOnly)
+        fileOptions |= FileOptions::fileOptionsMappable;
+    File fstream(fileName, fileOptions);
 
     ReadPersistableParameters<ElemType>(fstream, true);
 
@@ -385,6 +389,9 @@ void ComputationNetwork::Read(const wstring& fileName)
     fstream.GetMarker(FileMarker::fileMarkerEndSection, L"ERootNodes");
 
     fstream.GetMarker(FileMarker::fileMarkerEndSection, L"ECN");
+
+    // keep the mapped file alive as long as parameter values may point into it
+    m_mappedModelFile = fstream.GetMapping();
 }
 
 // -----------------------------------------------------------------------
@@ -1464,7 +1471,7 @@ void ComputationNetwork::SaveToDbnFile(ComputationNetworkPtr net, const std::wst
 }
 
 template void ComputationNetwork::InitLearnableParameters<float>(const ComputationNodeBasePtr& node, const bool uniformInit, const unsigned long randomSeed, const float initValueScale, bool initOnCPUOnly);
-template void ComputationNetwork::Read<float>(const wstring& fileName);
+template void ComputationNetwork::Read<float>(const wstring& fileName, bool readOnly);
 template void ComputationNetwork::ReadPersistableParameters<float>(File& fstream, bool create);
 template void ComputationNetwork::PerformSVDecomposition<float>(const map<wstring, float>& SVDConfig, size_t alignedsize);
 template /*static*/ void ComputationNetwork::SetDropoutRate<float>(ComputationNetworkPtr net, const ComputationNodeBasePtr& criterionNode, const double dropoutRate, double& prevDropoutRate, size_t randSeedBase);
@@ -1474,7 +1481,7 @@ template void ComputationNetwork::SetSeqParam<float>(ComputationNetworkPtr net,
 template void ComputationNetwork::SaveToDbnFile<float>(ComputationNetworkPtr net, const std::wstring& fileName) const;
 
 template void ComputationNetwork::InitLearnableParameters<double>(const ComputationNodeBasePtr& node, const bool uniformInit, const unsigned long randomSeed, const double initValueScale, bool initOnCPUOnly);
-template void ComputationNetwork::Read<double>(const wstring& fileName);
+template void ComputationNetwork::Read<double>(const wstring& fileName, bool readOnly);
 template void ComputationNetwork::ReadPersistableParameters<double>(File& fstream, bool create);
 template void ComputationNetwork::PerformSVDecomposition<double>(const map<wstring, float>& SVDConfig, size_t alignedsize);
 template /*static*/ void ComputationNetwork::SetDropoutRate<double>(ComputationNetworkPtr net, const ComputationNodeBasePtr& criterionNode, const double dropoutRate, double& prevDropoutRate, size_t randSeedBase);
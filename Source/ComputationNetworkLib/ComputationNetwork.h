@@ -28,6 +28,7 @@
 #include <regex>
 #include <chrono>
 #include <unordered_map>
+#include <unordered_set>
 #include <set>
 
 namespace Microsoft { namespace MSR { namespace CNTK {
@@ -100,20 +101,22 @@ public:
     }
     // design BUGBUG: binary files do not know whether they are float or double.
     // TODO: modify file format to know this; then eliminate the <ElemType> dependency (and in some future, allow nodes to be different)
-    template <class ElemType> void Read(const std::wstring& fileName);
-    template <class ElemType> void Load(const std::wstring& fileName)
+    // 'readOnly' is for networks that are only evaluated: the parameters of a CPU network loaded from a mappable model
+    // then point into the mapping of the file, and cannot be resized or moved to another device.
+    template <class ElemType> void Read(const std::wstring& fileName, bool readOnly = false);
+    template <class ElemType> void Load(const std::wstring& fileName, bool readOnly = false)
     {
-        Read<ElemType>(fileName);
+        Read<ElemType>(fileName, readOnly);
         // perform all further post-processing, caching, etc.
         CompileNetwork();
     }
 
     // static helper to instantiate a network from a file
     template <class ElemType>
-    static ComputationNetworkPtr CreateFromFile(DEVICEID_TYPE deviceId, const std::wstring& fileName)
+    static ComputationNetworkPtr CreateFromFile(DEVICEID_TYPE deviceId, const std::wstring& fileName, bool readOnly = false)
     {
         auto net = make_shared<ComputationNetwork>(deviceId);
-        net->Load<ElemType>(fileName);
+        net->Load<ElemType>(fileName, readOnly);
         return net;
     }
 
@@ -173,8 +176,9 @@ public:
 
 private:
     void ValidateNetwork();
-    size_t ValidateNodes(list<ComputationNodeBasePtr> nodes, bool isFirstPass, bool isFinalValidationPass);
-    bool ValidateNode(ComputationNodeBasePtr node, bool isFinalValidationPass) const;
+    size_t ValidateNodes(const list<ComputationNodeBasePtr>& nodes, bool isFirstPass, bool isFinalValidationPass);
+    bool ValidateNodeInPass(const ComputationNodeBasePtr& node, bool isFirstPass, bool isFinalValidationPass, vector<ComputationNodeBasePtr>* changedNodes);
+    bool ValidateNode(ComputationNodeBasePtr node, bool isFinalValidationPass, vector<ComputationNodeBasePtr>* changedNodes = nullptr) const;
     void MarkValueNonSharableNodes();
     void ChangeNodeInputs(ComputationNodeBasePtr fromNode, ComputationNodeBasePtr toNode);
 
@@ -240,7 +244,7 @@ public:
         else // this creates a subset of the global eval order of all nodes that rootNode depends on
         {
             auto rawTraversalForRoot = ComputationNodeBase::EnumerateNodes({ rootNode }); // traverse to find the set (we ignore the order)
-            set<ComputationNodeBasePtr> rawSet(rawTraversalForRoot.begin(), rawTraversalForRoot.end());
+            std::unordered_set<ComputationNodeBasePtr> rawSet(rawTraversalForRoot.begin(), rawTraversalForRoot.end());
             for (const auto& node : GetEvalOrder(nullptr)) // iterate over global one and pull out everything that is included in the set for rootNode
             {
                 if (rawSet.find(node) != rawSet.end())
@@ -359,6 +363,7 @@ public:
     ComputationNodeBasePtr CopyNode(const ComputationNetwork& fromNet, const std::wstring fromName, std::wstring toName, const CopyNodeFlags flags);
     void CopySubTree(const ComputationNetwork& fromNet, const std::wstring fromName, std::wstring toNamePrefix, const CopyNodeFlags flags);
     void CopyInputs(const std::wstring fromName, std::wstring toName);
+    ComputationNetworkPtr CloneWithSharedParameters() const;
     void RenameNode(const std::wstring& nodeNameOrig, const std::wstring& nodeNameNew);
     void RenameNode(ComputationNodeBasePtr node, const std::wstring& newNodeName);
     void DeleteNode(const std::wstring& nodeName);
@@ -1047,6 +1052,9 @@ private:
     DEVICEID_TYPE m_deviceId; // TODO: is this shared by all nodes?
     unsigned long m_randomSeedOffset;
 
+    // memory mapping of the model file if it was saved with fileOptionsMappable and loaded read-only; CPU parameter values point into it
+    std::shared_ptr<MappedFile> m_mappedModelFile;
+
     // main node holder
     std::map<const std::wstring, ComputationNodeBasePtr, nocase_compare> m_nameToNodeMap; // [name] -> node; this is the main container that holds this networks' nodes
 
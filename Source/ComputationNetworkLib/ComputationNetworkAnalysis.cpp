@@ -100,11 +100,8 @@ void ComputationNetwork::FormRecurrentLoops(const ComputationNodeBasePtr& rootNo
 
         // set m_numNonDelayedParentsInLoop to all nodes that are part of this loop and have a non-delay-node parent
         // This value is only used in this current block.
-        for (let& node : nodes) // reset it
-        {
-            if (node->m_loopId == iter->m_loopId)
-                assert(node->m_numNonDelayedParentsInLoop == 0); // (in PurgeStateForFormingRecurrentLoops())
-        }
+        for (let& node : nestedNodes) // reset it
+            assert(node->m_numNonDelayedParentsInLoop == 0); // (in PurgeStateForFormingRecurrentLoops())
         for (let& node : nestedNodes)
             {
             for (auto& input : node->GetInputs())
@@ -297,22 +294,16 @@ void ComputationNetwork::DetermineSCCsR(ComputationNodeBasePtr cur,
             //  - the first root takes the first delay node's value, the second root that of the second delay node
             //    I.e. the depth-first tree traversals enter the loop at two different places (m_sourceNode).
             //  -> Are these two loops detected as identical? (determined by m_minIndex, but m_index depends on traversal from each root, so maybe not)
-            bool bFound = false; // find a dup
-            for (let& iter : m_allSEQNodes)
-            {
-                for (let& iter2 : iter->m_nestedNodes)
+            // 'cur' knows its loop if it was already found (m_partOfLoopId is reset together with m_allSEQNodes in InvalidateCompiledNetwork()).
+            bool bFound = cur->m_isPartOfLoop; // find a dup
+            if (bFound)
             {
-                    if (iter2 == cur)
-                {
-                    bFound = true;
-                        // validate that the loop is really the same, by a set comparison
-                        unordered_set<ComputationNodeBasePtr> newLoop     (        nestedNodes.begin(),         nestedNodes.end());
-                        unordered_set<ComputationNodeBasePtr> existingLoop(iter->m_nestedNodes.begin(), iter->m_nestedNodes.end());
-                        if (newLoop != existingLoop)
-                            LogicError("DetermineSCCsR: %ls %ls operation rediscovered in a loop, but that loop is not the same as last time.", cur->NodeName().c_str(), cur->OperationName().c_str());
-                    break;
-                }
-            }
+                let& iter = m_allSEQNodes[cur->m_partOfLoopId];
+                // validate that the loop is really the same, by a set comparison
+                unordered_set<ComputationNodeBasePtr> newLoop     (        nestedNodes.begin(),         nestedNodes.end());
+                unordered_set<ComputationNodeBasePtr> existingLoop(iter->m_nestedNodes.begin(), iter->m_nestedNodes.end());
+                if (newLoop != existingLoop)
+                    LogicError("DetermineSCCsR: %ls %ls operation rediscovered in a loop, but that loop is not the same as last time.", cur->NodeName().c_str(), cur->OperationName().c_str());
             }
             if (bFound)
                 fprintf(stderr, "\nDetermineSCCsR: %ls %ls operation was discovered multiple times as as loop participant", cur->NodeName().c_str(), cur->OperationName().c_str());
@@ -337,7 +328,8 @@ void ComputationNetwork::DetermineSCCsR(ComputationNodeBasePtr cur,
                 rInfo.m_nestedNodes = move(nestedNodes); // TODO: make these two part of the constructor
                 for (auto node : rInfo.m_nestedNodes)
                 {
-                    node->m_isPartOfLoop = true; // this is the only flag in ComputationNode that escapes FormRecurrentLoops()!
+                    node->m_isPartOfLoop = true; // this and m_partOfLoopId are the only members in ComputationNode that escape FormRecurrentLoops()!
+                    node->m_partOfLoopId = rInfo.m_loopId;
                     // TODO: ^^ We should instead remember a pointer to our loop sentinel
                     node->m_loopId = rInfo.m_loopId; // Note: m_loopId is only used inside this source file, and only for reordering
                 }
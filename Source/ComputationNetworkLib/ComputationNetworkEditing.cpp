@@ -100,6 +100,52 @@ void ComputationNetwork::CopyInputs(const std::wstring fromName, std::wstring to
     CopyNode(*this, fromName, toName, CopyNodeFlags::copyNodeInputLinks);
 }
 
+// create a compiled copy of the entire network that shares the values of all parameters with this one
+// Parameters are LearnableParameters and the results of PreCompute nodes. All other nodes are duplicated without their
+// values, so the copy allocates its own activations and MBLayouts and can be evaluated concurrently with this network,
+// as long as neither modifies the parameters (i.e. no training).
+ComputationNetworkPtr ComputationNetwork::CloneWithSharedParameters() const
+{
+    auto net = make_shared<ComputationNetwork>(m_deviceId);
+    net->SetRandomSeedOffset(m_randomSeedOffset);
+    net->m_mappedModelFile = m_mappedModelFile; // shared parameters may point into it
+
+    for (const auto& iter : m_nameToNodeMap)
+    {
+        const auto& fromNode = iter.second;
+        int flags = CopyNodeFlags::copyNodeValue;
+        if (fromNode->OperationName() == OperationNameOf(LearnableParameter) || dynamic_pointer_cast<IPreComputeNode>(fromNode))
+            flags |= CopyNodeFlags::copyNodeShareValue;
+        else
+            flags |= CopyNodeFlags::copyNodeWithoutValue; // activations may refer to memory of the caller, e.g. inputs
+        net->AddNodeToNet(fromNode->Duplicate(fromNode->NodeName(), (CopyNodeFlags) flags));
+    }
+
+    // wire up the inputs among the new nodes
+    for (const auto& iter : m_nameToNodeMap)
+    {
+        const auto& fromNode = iter.second;
+        auto toNode = net->GetNodeFromName(fromNode->NodeName());
+        for (size_t i = 0; i < fromNode->GetNumInputs(); i++)
+            toNode->SetInput(i, net->GetNodeFromName(fromNode->GetInputs()[i]->NodeName()));
+    }
+
+    // node groups
+    for (const auto& node : FeatureNodes())
+        net->AddToNodeGroup(L"feature", net->GetNodeFromName(node->NodeName()));
+    for (const auto& node : LabelNodes())
+        net->AddToNodeGroup(L"label", net->GetNodeFromName(node->NodeName()));
+    for (const auto& node : FinalCriterionNodes())
+        net->AddToNodeGroup(L"criterion", net->GetNodeFromName(node->NodeName()));
+    for (const auto& node : EvaluationNodes())
+        net->AddToNodeGroup(L"evaluation", net->GetNodeFromName(node->NodeName()));
+    for (const auto& node : OutputNodes())
+        net->AddToNodeGroup(L"output", net->GetNodeFromName(node->NodeName()));
+
+    net->CompileNetwork();
+    return net;
+}
+
 // RenameNode - Rename a node to another name
 // nodeNameOrig - original node name
 // nodeNameNew - new node name
@@ -50,9 +50,10 @@ void ComputationNode<ElemType>::Backprop(const FrameRange& fr, bool childrenInTh
     for (size_t i = 0; i < m_inputs.size(); i++)
     {
         ComputationNodePtr child = Input(i);
+        // Note: A child that is part of a different loop (e.g. the previous layer of a stacked LSTM) counts as outside of this loop.
         if (child->m_needsGradient &&
-            ((childrenInThisLoop  && child->IsPartOfLoop() == IsPartOfLoop()) ||
-             (childrenInOuterLoop && child->IsPartOfLoop() != IsPartOfLoop()) ))
+            ((childrenInThisLoop  &&  child->IsPartOfSameLoopAs(*this)) ||
+             (childrenInOuterLoop && !child->IsPartOfSameLoopAs(*this)) ))
         {
             // fprintf(stderr, "Backprop: %ls %ls operation -> child %d %ls %ls\n", NodeName().c_str(), OperationName().c_str(), (int)i, child->NodeName().c_str(), child->OperationName().c_str());
             if (!m_needsGradient)
@@ -65,7 +66,7 @@ void ComputationNode<ElemType>::Backprop(const FrameRange& fr, bool childrenInTh
             // If we propagate from a loop to a node that is outside the loop, we are not efficient.
             // This case is handled by SEQTraversalFlowControlNode::Backprop().
             // The check below is to verify that.
-            if (IsPartOfLoop() && !child->IsPartOfLoop() && !fr.IsAllFrames())
+            if (IsPartOfLoop() && !child->IsPartOfSameLoopAs(*this) && !fr.IsAllFrames())
             {
                 LogicError("Backprop: Inefficiency: %ls %ls operation in loop propagates gradient to non-loop %ls %ls\n",
                            NodeName().c_str(), OperationName().c_str(), child->NodeName().c_str(), child->OperationName().c_str());
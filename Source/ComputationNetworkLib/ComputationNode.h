@@ -53,7 +53,9 @@ enum CopyNodeFlags // flags to be passed to the CopyTo() function
     copyNodeValue          = 1, // copy everything except for the input links
     copyNodeInputLinks     = 2, // copy over input links
     copyNodeAll            = 3, // copy everything
-    copyNodeAcrossNetworks = 4  // allow a cross network child copy
+    copyNodeAcrossNetworks = 4, // allow a cross network child copy
+    copyNodeShareValue     = 8, // together with copyNodeValue: share the value matrix instead of copying it (gradient is not copied)
+    copyNodeWithoutValue   = 16 // together with copyNodeValue: copy everything but the value and gradient, which the copy computes itself
 };
 
 #pragma region base computation class
@@ -149,11 +151,14 @@ struct ComputationNetworkOwnedNodeState
     {
         PurgeStateForFormingRecurrentLoops();
         m_isPartOfLoop = false;
+        m_partOfLoopId = -1;
     }
 
     void CopyTo(ComputationNetworkOwnedNodeState& other) const
     {
         other.m_isPartOfLoop                  = m_isPartOfLoop;
+        other.m_partOfLoopId                  = m_partOfLoopId; // (an index into *our* network's m_allSEQNodes; this is only safe because the receiving
+                                                                //  network must be compiled before use, and CompileNetwork() resets it via InvalidateCompiledNetwork())
         other.m_needsGradient                 = m_needsGradient;
         other.m_valueSharable                 = m_valueSharable;
         other.m_traceNodeValueReal            = m_traceNodeValueReal;
@@ -164,6 +169,8 @@ struct ComputationNetworkOwnedNodeState
     }
 
     bool IsPartOfLoop() const { return m_isPartOfLoop; }
+    // true if both nodes are part of the same recurrent loop, or both are not part of any loop
+    bool IsPartOfSameLoopAs(const ComputationNetworkOwnedNodeState& other) const { return m_isPartOfLoop == other.m_isPartOfLoop && m_partOfLoopId == other.m_partOfLoopId; }
 
     virtual void MarkValueNonSharable() { m_valueSharable = false; }
     virtual void MarkValueSharable() { m_valueSharable = true; }
@@ -187,6 +194,7 @@ protected:                // TODO: should be fully encapsulated here
                           // it will never be released to memory pool
 private:
     bool m_isPartOfLoop; // true if this loop is part of a recurrent loop
+    int m_partOfLoopId;  // if m_isPartOfLoop then the loop's id (index into m_allSEQNodes), otherwise -1; unlike m_loopId, this survives FormRecurrentLoops()
 
 protected:
     // owned by FormRecurrentLoops() and stuff it calls, only used from inside there (FormRecurrentLoops() calls PurgeStateForFormingRecurrentLoops() at its end to make that super-clear)
@@ -310,7 +318,10 @@ public:
             node->m_sampleLayout = m_sampleLayout;
 
             ComputationNetworkOwnedNodeState::CopyTo(*node);
-            TimeStamp::CopyTo(*node);
+            if (flags & CopyNodeFlags::copyNodeWithoutValue)
+                node->SetEvalTimeStampOutdatedWrtAll(); // value is not there yet
+            else
+                TimeStamp::CopyTo(*node);
         }
         node->ClearConfigMemberCache();
     }
@@ -939,20 +950,28 @@ public:
         if (flags & CopyNodeFlags::copyNodeValue)
         {
             auto node = DownCast(nodeP);
-            if (m_value)
+            if (flags & CopyNodeFlags::copyNodeShareValue)
             {
-                node->CreateValueMatrixIfNull();
-                node->m_value->SetValue(*m_value);
+                node->m_value = m_value; // both nodes now refer to the same matrix object
+                node->m_gradient = nullptr;
             }
-            else
-                node->m_value = nullptr;
-            if (m_gradient)
+            else if (!(flags & CopyNodeFlags::copyNodeWithoutValue))
             {
-                node->CreateGradientMatrixIfNull();
-                node->m_gradient->SetValue(*m_gradient);
+                if (m_value)
+                {
+                    node->CreateValueMatrixIfNull();
+                    node->m_value->SetValue(*m_value);
+                }
+                else
+                    node->m_value = nullptr;
+                if (m_gradient)
+                {
+                    node->CreateGradientMatrixIfNull();
+                    node->m_gradient->SetValue(*m_gradient);
+                }
+                else
+                    node->m_gradient = nullptr;
             }
-            else
-                node->m_gradient = nullptr;
         }
     }
 
@@ -1888,6 +1907,12 @@ struct IPreComputeNode
     // call this with 'false' at start and with 'true' at end
     // This is used for resetting and updating from accumulators.
     virtual void MarkComputed(const bool hasComputed) = 0;
+    // call this before MarkComputed(true) if several workers have each accumulated over a different part of the data
+    // 'allReduceSum' must sum up a vector elementwise across all workers.
+    virtual void AggregateAccumulators(const std::function<void(std::vector<double>&)>& allReduceSum) = 0;
+    // save and restore only the precomputed value, e.g. to reuse it across runs
+    virtual void SavePreComputedValue(File& fstream) const = 0;
+    virtual void LoadPreComputedValue(File& fstream) = 0;
 };
 
 // =======================================================================
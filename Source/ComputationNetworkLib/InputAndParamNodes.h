@@ -505,6 +505,12 @@ public:
             Matrix<ElemType> sliceInput1Value = Input(1)->MaskedValueFor(t);
             Matrix<ElemType> sliceOutputGrad = MaskedGradientFor(t);
 
+            // If the input is sparse (one-hot word ids), the gradient only has nonzero columns for the words that were
+            // actually looked up, so we compute it as block-sparse, and the update only touches those columns.
+            // BUGBUG: Like TimesNode, this does not accumulate into the Input(0)->Gradient, which might cause problems elsewhere.
+            if (sliceInput1Value.GetMatrixType() == SPARSE && Input(0)->Gradient().GetMatrixType() == DENSE && sliceOutputGrad.GetMatrixType() == DENSE)
+                Input(0)->Gradient().SwitchToMatrixType(SPARSE, MatrixFormat::matrixFormatSparseBlockCol, false);
+
             BackpropToLeft(sliceInput1Value, Input(0)->GradientAsMatrix(), sliceOutputGrad);
         }
         else if (inputIndex == 1) // right derivative (input)
@@ -522,13 +528,10 @@ public:
         size_t rowsp = gradientValues.GetNumRows(), colsp = gradientValues.GetNumCols();
         int wordsInEachSample = rows1 / inputGradientValues.GetNumCols();
 
-        inputFunctionValues.Reshape(rows1 / wordsInEachSample, cols1 * wordsInEachSample);
-        gradientValues.Reshape(rowsp / wordsInEachSample, colsp * wordsInEachSample);
-
-        Matrix<ElemType>::MultiplyAndAdd(gradientValues, false, inputFunctionValues, true, inputGradientValues);
+        auto inputFunctionValuesReshaped = ReshapedInput(inputFunctionValues, rows1 / wordsInEachSample, cols1 * wordsInEachSample);
+        auto gradientValuesReshaped = gradientValues.Reshaped(rowsp / wordsInEachSample, colsp * wordsInEachSample);
 
-        inputFunctionValues.Reshape(rows1, cols1);
-        gradientValues.Reshape(rowsp, colsp);
+        Matrix<ElemType>::MultiplyAndAdd(gradientValuesReshaped, false, inputFunctionValuesReshaped, true, inputGradientValues);
     }
 
     /*TODO: merge with call site*/ void BackpropToRight(Matrix<ElemType>& inputFunctionValues, Matrix<ElemType>& inputGradientValues, Matrix<ElemType>& gradientValues)
@@ -561,12 +564,26 @@ public:
         if (cols0 * wordsInEachSample != rows1)
             LogicError("LookupTableNode: rows of input 1 is not a multiple of cols of input 0. This usually happens when the feature dimension is not specified as that in the network definition of look-up-table dimension size.");
 
-        auto input1Reshaped = input1.Reshaped(rows1 / wordsInEachSample, cols1 * wordsInEachSample); // BUGBUG: Won't work for sparse. Also kills BOTH state that we would like to retain.
+        // for a sparse (one-hot) input, the product below only gathers the embedding columns of the words present
+        auto input1Reshaped = ReshapedInput(input1, rows1 / wordsInEachSample, cols1 * wordsInEachSample);
 
         auto functionValuesReshaped = functionValues.Reshaped(input0.GetNumRows(), input1Reshaped.GetNumCols());
         functionValuesReshaped.AssignProductOf(input0, false, input1Reshaped, false);
     }
 
+    virtual void AllocateGradientMatricesForInputs(MatrixPool& matrixPool) override
+    {
+        // same as TimesNode: a sparse input gets a block-sparse gradient for the embedding matrix,
+        // which must be allocated directly instead of from the pool
+        if (Input(0)->NeedsGradient() && Input(1)->Value().GetMatrixType() == SPARSE)
+        {
+            Input(0)->CreateGradientMatrixIfNull();
+            Input(0)->Gradient().SwitchToMatrixType(SPARSE, MatrixFormat::matrixFormatSparseBlockCol, false);
+        }
+
+        Base::AllocateGradientMatricesForInputs(matrixPool);
+    }
+
     virtual void /*ComputationNodeBase::*/ Validate(bool isFinalValidationPass) override
     {
         Base::Validate(isFinalValidationPass);
@@ -583,6 +600,20 @@ public:
         SetDims(TensorShape(Input(0)->GetAsMatrixNumRows() * wordsInEachSample), true);
     }
 
+private:
+    // Reshape the input into one word per column.
+    // A sparse input is in a minibatch slice, which cannot be reshaped in place; so if it needs reshaping at all
+    // (more than one word per sample), we reshape a copy, which costs O(nz) rather than O(rows x cols).
+    static Matrix<ElemType> ReshapedInput(const Matrix<ElemType>& input, size_t numRows, size_t numCols)
+    {
+        if (input.GetMatrixType() != SPARSE || (numRows == input.GetNumRows() && numCols == input.GetNumCols()))
+            return input.Reshaped(numRows, numCols);
+        Matrix<ElemType> result = input.DeepClone();
+        result.Reshape(numRows, numCols);
+        return result;
+    }
+
+public:
     bool UnitTest()
     {
         try
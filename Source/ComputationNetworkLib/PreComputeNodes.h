@@ -53,6 +53,24 @@ public:
 
     virtual bool RequiresPreCompute() const override { return true; }
 
+    virtual void /*IPreComputeNode::*/ SavePreComputedValue(File& fstream) const override
+    {
+        if (!m_hasComputed)
+            LogicError("%ls %ls operation: SavePreComputedValue() called before the value was computed.", NodeName().c_str(), OperationName().c_str());
+        fstream << Value();
+    }
+
+    // Unlike Load(), this keeps the validated sample layout.
+    virtual void /*IPreComputeNode::*/ LoadPreComputedValue(File& fstream) override
+    {
+        let sampleLayout = GetSampleLayout();
+        fstream >> Value();
+        if (Value().GetNumElements() != sampleLayout.GetNumElements())
+            RuntimeError("%ls %ls operation: Precomputed value has %d elements, but the node has %d.", NodeName().c_str(), OperationName().c_str(), (int) Value().GetNumElements(), (int) sampleLayout.GetNumElements());
+        SetDims(sampleLayout, false);
+        m_hasComputed = true;
+    }
+
     virtual void Save(File& fstream) const override
     {
         Base::Save(fstream);
@@ -190,6 +208,43 @@ public:
     }
 
 protected:
+    // helpers for AggregateAccumulators(), which combine in double precision
+    static vector<double> CopyToVector(const Matrix<ElemType>& m)
+    {
+        vector<double> v(m.GetNumElements());
+        ElemType* data = m.CopyToArray();
+        for (size_t i = 0; i < v.size(); i++)
+            v[i] = data[i];
+        delete[] data;
+        return v;
+    }
+    static void SetFromVector(Matrix<ElemType>& m, const vector<double>& v)
+    {
+        vector<ElemType> data(v.begin(), v.end());
+        m.SetValue(m.GetNumRows(), m.GetNumCols(), m.GetDeviceId(), data.data());
+    }
+
+    // combine the partial means of all workers, weighted by their sample counts
+    // Returns the overall mean and sets m_numSamples to the overall sample count.
+    vector<double> AggregateMean(const Matrix<ElemType>& partialMean, const std::function<void(std::vector<double>&)>& allReduceSum)
+    {
+        if (!IsAccumulating())
+            LogicError("%ls %ls operation: AggregateAccumulators() called while not accumulating.", NodeName().c_str(), OperationName().c_str());
+        let numSamples = (double) m_numSamples;
+        auto sums = CopyToVector(partialMean);
+        for (auto& sum : sums)
+            sum *= numSamples;
+        sums.push_back(numSamples);
+        allReduceSum(sums);
+        let totalNumSamples = sums.back();
+        sums.pop_back();
+        if (totalNumSamples > 0)
+            for (auto& sum : sums)
+                sum /= totalNumSamples;
+        m_numSamples = (size_t) totalNumSamples;
+        return sums;
+    }
+
     size_t m_numSamples; // (SIZE_MAX while outside accumulation state)
     bool IsAccumulating() const { return m_numSamples != SIZE_MAX; }
 };
@@ -198,7 +253,10 @@ protected:
     ComputationNodeBoilerplate;               \
     UsingPreComputedNodeMembers;              \
     using Base::m_numSamples;                 \
-    using Base::IsAccumulating
+    using Base::IsAccumulating;               \
+    using Base::AggregateMean;                \
+    using Base::CopyToVector;                 \
+    using Base::SetFromVector
 
 // -----------------------------------------------------------------------
 // MeanNode (features)
@@ -261,6 +319,11 @@ public:
 
         m_numSamples += numNewSamples;
     }
+
+    virtual void /*IPreComputeNode::*/ AggregateAccumulators(const std::function<void(std::vector<double>&)>& allReduceSum) override
+    {
+        SetFromVector(Value(), AggregateMean(Value(), allReduceSum));
+    }
 };
 
 template class MeanNode<float>;
@@ -355,6 +418,26 @@ public:
         m_numSamples += Input(0)->GetMBLayout()->GetActualNumSamples();
     }
 
+    // This is the parallel form of the update above (Chan et al.): The variances of the workers are combined weighted by their sample counts,
+    // each corrected by the squared distance of the worker's mean from the overall mean.
+    virtual void /*IPreComputeNode::*/ AggregateAccumulators(const std::function<void(std::vector<double>&)>& allReduceSum) override
+    {
+        let numSamples = (double) m_numSamples;
+        let partialMean = CopyToVector(*m_mean);
+        let mean = AggregateMean(*m_mean, allReduceSum);
+        auto var = CopyToVector(*m_var);
+        for (size_t i = 0; i < var.size(); i++)
+        {
+            let delta = partialMean[i] - mean[i];
+            var[i] = numSamples * (var[i] + delta * delta);
+        }
+        allReduceSum(var);
+        for (auto& v : var)
+            v = m_numSamples > 0 ? v / m_numSamples : 0;
+        SetFromVector(*m_mean, mean);
+        SetFromVector(*m_var, var);
+    }
+
     virtual void CopyTo(ComputationNodeBasePtr nodeP, const std::wstring& newName, const CopyNodeFlags flags) const override
     {
         Base::CopyTo(nodeP, newName, flags);
@@ -0,0 +1,327 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// RecurrentNodes.cpp -- implementation of the fused recurrent cell node (FusedRNNNode)
+//
+
+#include "Basics.h"
+#include "RecurrentNodes.h"
+#include "Matrix.h"
+#include "ComputationNode.h"
+#include "Sequences.h"
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <memory>
+#include <assert.h>
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+// -----------------------------------------------------------------------
+// FusedRNN (W, R, b, input [, peepholes], hiddenDim=, recurrentOp=, initialState=)
+// -----------------------------------------------------------------------
+
+template <class ElemType>
+/*virtual*/ void FusedRNNNode<ElemType>::CopyTo(ComputationNodeBasePtr nodeP, const std::wstring& newName, const CopyNodeFlags flags) const /*override*/
+{
+    Base::CopyTo(nodeP, newName, flags);
+    if (flags & CopyNodeFlags::copyNodeValue)
+    {
+        auto node = dynamic_pointer_cast<FusedRNNNode<ElemType>>(nodeP);
+        node->m_hiddenDim    = m_hiddenDim;
+        node->m_recurrentOp  = m_recurrentOp;
+        node->m_initialState = m_initialState;
+        node->m_carriedOutput.SetValue(m_carriedOutput);
+        node->m_carriedCell.SetValue(m_carriedCell);
+    }
+}
+
+template <class ElemType>
+/*virtual*/ void FusedRNNNode<ElemType>::Load(File& fstream, size_t modelVersion) /*override*/
+{
+    Base::Load(fstream, modelVersion);
+    fstream >> m_hiddenDim >> m_recurrentOp >> m_initialState;
+}
+
+template <class ElemType>
+/*virtual*/ void FusedRNNNode<ElemType>::Save(File& fstream) const /*override*/
+{
+    Base::Save(fstream);
+    fstream << m_hiddenDim << m_recurrentOp << m_initialState;
+}
+
+// set up h(t-1) and c(t-1) for step t: the previous step's output, the state carried over from the previous minibatch,
+// or the initial state for sequences that begin at t
+template <class ElemType>
+void FusedRNNNode<ElemType>::InitializeStates(size_t t)
+{
+    const size_t S = GetNumParallelSequences();
+    auto prevOutput = m_prevOutput->ColumnSlice(t * S, S);
+    auto prevCell = IsLSTM() ? m_prevCell->ColumnSlice(t * S, S) : Matrix<ElemType>(m_deviceId);
+
+    if (t > 0)
+    {
+        prevOutput.SetValue(Value().ColumnSlice((t - 1) * S, S));
+        if (IsLSTM())
+            prevCell.SetValue(m_cell->ColumnSlice((t - 1) * S, S));
+    }
+    else if (m_pMBLayout->HasSequenceBeyondBegin())
+    {
+        if (m_carriedOutput.GetNumRows() != m_hiddenDim || m_carriedOutput.GetNumCols() != S)
+            InvalidArgument("%ls %ls operation: A sequence continues from the previous minibatch, but no matching state was carried over.", NodeName().c_str(), OperationName().c_str());
+        prevOutput.SetValue(m_carriedOutput);
+        if (IsLSTM())
+            prevCell.SetValue(m_carriedCell);
+    }
+    else // all sequences start here
+    {
+        prevOutput.SetValue(m_initialState);
+        if (IsLSTM())
+            prevCell.SetValue(m_initialState);
+        return;
+    }
+
+    FrameRange frPrev = FrameRange(m_pMBLayout, t).WithTimeOffset(-1);
+    if (!m_pMBLayout->IsBeyondStartOrEnd(frPrev))
+        return;
+    for (size_t s = 0; s < S; s++)
+    {
+        if (m_pMBLayout->IsBeyondStartOrEnd(frPrev.Sequence(s)))
+        {
+            prevOutput.ColumnSlice(s, 1).SetValue(m_initialState);
+            if (IsLSTM())
+                prevCell.ColumnSlice(s, 1).SetValue(m_initialState);
+        }
+    }
+}
+
+template <class ElemType>
+/*virtual*/ void FusedRNNNode<ElemType>::ForwardPropNonLooping() /*override*/
+{
+    if (m_deviceId != CPUDEVICE)
+        InvalidArgument("%ls %ls operation is currently only implemented for the CPU. Use BS.RNNs.RecurrentFused, which falls back to an unfused network on a GPU.", NodeName().c_str(), OperationName().c_str());
+
+    const size_t H = m_hiddenDim, G = NumGates();
+    const size_t S = GetNumParallelSequences(), T = GetNumTimeSteps();
+    FrameRange frAll(m_pMBLayout);
+
+    const auto& R = Input(RECURRENTWEIGHTS)->Value();
+    const auto& b = Input(BIAS)->Value();
+    Matrix<ElemType> noPeepholes(m_deviceId);
+    const auto& peepholes = HasPeepholes() ? Input(PEEPHOLES)->Value() : noPeepholes;
+
+    // the input projections of all time steps in one matrix product
+    // Gaps are masked so that they cannot spread NaNs into the gradients of W.
+    Matrix<ElemType>::Multiply(Input(WEIGHTS)->Value(), false, Input(DATA)->MaskedValueFor(frAll), false, *m_gates);
+
+    m_recurrence->Resize(G * H, T * S);
+    m_prevOutput->Resize(H, T * S);
+    m_cell->Resize(H, T * S);
+    if (IsLSTM())
+        m_prevCell->Resize(H, T * S);
+
+    // step through time; only the recurrent product and the cell itself remain sequential
+    for (size_t t = 0; t < T; t++)
+    {
+        InitializeStates(t);
+        auto gates      = m_gates->ColumnSlice(t * S, S);
+        auto recurrence = m_recurrence->ColumnSlice(t * S, S);
+        auto prevOutput = m_prevOutput->ColumnSlice(t * S, S);
+        auto cell       = m_cell->ColumnSlice(t * S, S);
+        auto output     = Value().ColumnSlice(t * S, S);
+        Matrix<ElemType>::Multiply(R, false, prevOutput, false, recurrence);
+        if (IsLSTM())
+            Matrix<ElemType>::LSTMStepForward(gates, recurrence, b, peepholes, m_prevCell->ColumnSlice(t * S, S), cell, output);
+        else
+            Matrix<ElemType>::GRUStepForward(gates, recurrence, b, prevOutput, cell, output);
+    }
+    MaskMissingValueColumnsToZero(frAll);
+
+    // remember the last state of sequences that continue into the next minibatch (truncated BPTT)
+    if (m_pMBLayout->HasSequenceBeyondEnd())
+    {
+        m_carriedOutput.SetValue(Value().ColumnSlice((T - 1) * S, S));
+        if (IsLSTM())
+            m_carriedCell.SetValue(m_cell->ColumnSlice((T - 1) * S, S));
+    }
+    m_backpropDone = false;
+}
+
+// back-propagate through all time steps at once
+// Afterwards, m_gates holds the gradients of the gate pre-activations, and (for GRU) m_recurrence holds the gradient w.r.t. R h(t-1).
+// Gradients do not flow into the initial state, nor back into the previous minibatch.
+template <class ElemType>
+void FusedRNNNode<ElemType>::BackpropThroughTime()
+{
+    const size_t H = m_hiddenDim;
+    const size_t S = GetNumParallelSequences(), T = GetNumTimeSteps();
+    FrameRange frAll(m_pMBLayout);
+
+    const auto& R = Input(RECURRENTWEIGHTS)->Value();
+    Matrix<ElemType> noPeepholes(m_deviceId);
+    const auto& peepholes = HasPeepholes() ? Input(PEEPHOLES)->Value() : noPeepholes;
+    if (HasPeepholes())
+    {
+        m_peepholeGradient.Resize(H, 3);
+        m_peepholeGradient.SetValue(0);
+    }
+
+    m_dh->Resize(H, S);
+    m_dhRecurrent->Resize(H, S);
+    m_dhRecurrent->SetValue(0);
+    m_dcRecurrent->Resize(H, S);
+    m_dcRecurrent->SetValue(0);
+
+    for (size_t t = T; t-- > 0;)
+    {
+        auto gates      = m_gates->ColumnSlice(t * S, S);
+        auto prevOutput = m_prevOutput->ColumnSlice(t * S, S);
+        auto cell       = m_cell->ColumnSlice(t * S, S);
+        m_dh->AssignSumOf(Gradient().ColumnSlice(t * S, S), *m_dhRecurrent);
+        if (IsLSTM())
+        {
+            Matrix<ElemType>::LSTMStepBackward(gates, peepholes, m_prevCell->ColumnSlice(t * S, S), cell, *m_dh, *m_dcRecurrent, m_peepholeGradient);
+            Matrix<ElemType>::Multiply(R, true, gates, false, *m_dhRecurrent);
+        }
+        else
+        {
+            auto recurrenceGradient = m_recurrence->ColumnSlice(t * S, S);
+            Matrix<ElemType>::GRUStepBackward(gates, cell, prevOutput, *m_dh, *m_dhRecurrent, recurrenceGradient);
+            Matrix<ElemType>::MultiplyAndAdd(R, true, recurrenceGradient, false, *m_dhRecurrent);
+        }
+
+        // cut the recurrent gradient at sequence starts and gaps
+        FrameRange fr(m_pMBLayout, t);
+        FrameRange frPrev = fr.WithTimeOffset(-1);
+        if (!m_pMBLayout->IsBeyondStartOrEnd(frPrev) && !m_pMBLayout->IsGap(fr))
+            continue;
+        for (size_t s = 0; s < S; s++)
+        {
+            if (m_pMBLayout->IsBeyondStartOrEnd(frPrev.Sequence(s)) || m_pMBLayout->IsGap(fr.Sequence(s)))
+            {
+                m_dhRecurrent->ColumnSlice(s, 1).SetValue(0);
+                m_dcRecurrent->ColumnSlice(s, 1).SetValue(0);
+            }
+        }
+    }
+
+    // gaps must not contribute to the parameter gradients
+    MaskMissingColumnsToZero(*m_gates, m_pMBLayout, frAll);
+    if (!IsLSTM())
+        MaskMissingColumnsToZero(*m_recurrence, m_pMBLayout, frAll);
+}
+
+template <class ElemType>
+/*virtual*/ void FusedRNNNode<ElemType>::BackpropToNonLooping(size_t inputIndex) /*override*/
+{
+    if (!m_backpropDone)
+    {
+        BackpropThroughTime();
+        m_backpropDone = true;
+    }
+
+    const auto& dGates = *m_gates;
+    switch (inputIndex)
+    {
+    case WEIGHTS:
+        Matrix<ElemType>::MultiplyAndAdd(dGates, false, Input(DATA)->MaskedValueFor(FrameRange(m_pMBLayout)), true, Input(WEIGHTS)->Gradient());
+        break;
+    case RECURRENTWEIGHTS:
+        Matrix<ElemType>::MultiplyAndAdd(IsLSTM() ? dGates : *m_recurrence, false, *m_prevOutput, true, Input(RECURRENTWEIGHTS)->Gradient());
+        break;
+    case BIAS:
+        Matrix<ElemType>::MultiplyAndAdd(dGates, false, ConstOnes(dGates.GetNumCols(), 1, m_deviceId), false, Input(BIAS)->Gradient());
+        break;
+    case DATA:
+        Matrix<ElemType>::MultiplyAndAdd(Input(WEIGHTS)->Value(), true, dGates, false, Input(DATA)->Gradient());
+        break;
+    case PEEPHOLES:
+        Input(PEEPHOLES)->Gradient() += m_peepholeGradient;
+        break;
+    default:
+        LogicError("%ls %ls operation: Invalid input index %d.", NodeName().c_str(), OperationName().c_str(), (int) inputIndex);
+    }
+}
+
+template <class ElemType>
+/*virtual*/ void FusedRNNNode<ElemType>::Validate(bool isFinalValidationPass) /*override*/
+{
+    Base::Validate(isFinalValidationPass);
+    InferMBLayoutFromInputsForStandardCase(isFinalValidationPass);
+
+    if (m_recurrentOp != L"lstm" && m_recurrentOp != L"gru")
+        InvalidArgument("%ls %ls operation: Invalid recurrentOp '%ls', must be 'lstm' or 'gru'.", NodeName().c_str(), OperationName().c_str(), m_recurrentOp.c_str());
+    if (GetNumInputs() != 4 && !(GetNumInputs() == 5 && IsLSTM()))
+        InvalidArgument("%ls %ls operation expects the inputs (W, R, b, input), plus peephole weights for LSTM.", NodeName().c_str(), OperationName().c_str());
+    if (m_hiddenDim == 0)
+        InvalidArgument("%ls %ls operation: hiddenDim must be specified.", NodeName().c_str(), OperationName().c_str());
+
+    const size_t H = m_hiddenDim, G = NumGates();
+    const size_t inputDim = Input(DATA)->GetSampleMatrixNumRows();
+    Input(WEIGHTS)->ValidateInferInputDimsFrom(TensorShape(G * H, inputDim));
+    Input(RECURRENTWEIGHTS)->ValidateInferInputDimsFrom(TensorShape(G * H, H));
+    Input(BIAS)->ValidateInferInputDimsFrom(TensorShape(G * H));
+    if (HasPeepholes())
+        Input(PEEPHOLES)->ValidateInferInputDimsFrom(TensorShape(H, 3));
+
+    if (isFinalValidationPass)
+    {
+        if (!HasMBLayout())
+            InvalidArgument("%ls %ls operation requires its input to be a sequence.", NodeName().c_str(), OperationName().c_str());
+        auto checkParameter = [&](size_t index, size_t rows, size_t cols)
+        {
+            const auto& in = Input(index);
+            if (in->HasMBLayout() || in->GetAsMatrixNumRows() != rows || in->GetAsMatrixNumCols() != cols)
+                InvalidArgument("%ls %ls operation: Input %d (%ls) must be a parameter of dimensions [%d x %d].",
+                                NodeName().c_str(), OperationName().c_str(), (int) index, in->NodeName().c_str(), (int) rows, (int) cols);
+        };
+        checkParameter(WEIGHTS, G * H, inputDim);
+        checkParameter(RECURRENTWEIGHTS, G * H, H);
+        checkParameter(BIAS, G * H, 1);
+        if (HasPeepholes())
+            checkParameter(PEEPHOLES, H, 3);
+    }
+
+    SetDims(TensorShape(H), true);
+}
+
+template <class ElemType>
+/*virtual*/ void FusedRNNNode<ElemType>::RequestMatricesBeforeForwardProp(MatrixPool& matrixPool) /*override*/
+{
+    Base::RequestMatricesBeforeForwardProp(matrixPool);
+    RequestMatrixFromPool(m_gates, matrixPool);
+    RequestMatrixFromPool(m_recurrence, matrixPool);
+    RequestMatrixFromPool(m_prevOutput, matrixPool);
+    RequestMatrixFromPool(m_prevCell, matrixPool);
+    RequestMatrixFromPool(m_cell, matrixPool);
+}
+
+template <class ElemType>
+/*virtual*/ void FusedRNNNode<ElemType>::RequestMatricesBeforeBackprop(MatrixPool& matrixPool) /*override*/
+{
+    Base::RequestMatricesBeforeBackprop(matrixPool);
+    RequestMatrixFromPool(m_dh, matrixPool);
+    RequestMatrixFromPool(m_dhRecurrent, matrixPool);
+    RequestMatrixFromPool(m_dcRecurrent, matrixPool);
+}
+
+template <class ElemType>
+/*virtual*/ void FusedRNNNode<ElemType>::ReleaseMatricesAfterBackprop(MatrixPool& matrixPool) /*override*/
+{
+    Base::ReleaseMatricesAfterBackprop(matrixPool);
+    ReleaseMatrixToPool(m_gates, matrixPool);
+    ReleaseMatrixToPool(m_recurrence, matrixPool);
+    ReleaseMatrixToPool(m_prevOutput, matrixPool);
+    ReleaseMatrixToPool(m_prevCell, matrixPool);
+    ReleaseMatrixToPool(m_cell, matrixPool);
+    ReleaseMatrixToPool(m_dh, matrixPool);
+    ReleaseMatrixToPool(m_dhRecurrent, matrixPool);
+    ReleaseMatrixToPool(m_dcRecurrent, matrixPool);
+}
+
+template class FusedRNNNode<float>;
+template class FusedRNNNode<double>;
+
+}}}
@@ -1181,4 +1181,81 @@ protected:
 
 #endif
 
+// -----------------------------------------------------------------------
+// FusedRNNNode (W, R, b, input [, peepholes], hiddenDim=, recurrentOp=, initialState=)
+// A complete single-layer LSTM or GRU as one node, for the CPU. On a GPU, BS.RNNs.RecurrentFused builds the equivalent
+// network from PastValue and elementwise nodes instead (BS.RNNs.UnfusedLSTM, BS.RNNs.UnfusedGRU).
+// Unlike a network built from PastValue and elementwise nodes, this node does not form a loop in the network:
+// the input projections W * x_t of all time steps are computed with a single matrix product over the whole minibatch,
+// and only the recurrent product R * h(t-1) and the (fused) cell nonlinearities are evaluated step by step.
+// The gradient is computed for all time steps at once (BPTT) upon the first BackpropTo() call.
+//  - W: [G*H x I] input weights, R: [G*H x H] recurrent weights, b: [G*H] bias, where G=4 for LSTM and G=3 for GRU
+//  - LSTM gates are stacked in the order (i, f, g, o); GRU gates in the order (r, u, n), with n = tanh(Wn x + bn + r .* (Rn h))
+//  - peepholes (LSTM only, optional): [H x 3] diagonal peephole weights for the i, f, and o gates
+//  - initialState: value that h and c are initialized to at the start of a sequence (default matches PastValue)
+// Sequences carried over from the previous minibatch (truncated BPTT) continue from the last state of that minibatch.
+// -----------------------------------------------------------------------
+
+template <class ElemType>
+class FusedRNNNode : public ComputationNodeNonLooping<ElemType>
+{
+    typedef ComputationNodeNonLooping<ElemType> Base; UsingComputationNodeMembersBoilerplate;
+    static const std::wstring TypeName() { return L"FusedRNN"; }
+
+    enum : size_t { WEIGHTS = 0, RECURRENTWEIGHTS = 1, BIAS = 2, DATA = 3, PEEPHOLES = 4 };
+
+public:
+    FusedRNNNode(DEVICEID_TYPE deviceId, const wstring& name, size_t hiddenDim = 0, const std::wstring& recurrentOp = L"lstm", ElemType initialState = (ElemType) DEFAULT_HIDDEN_ACTIVATION)
+        : Base(deviceId, name), m_hiddenDim(hiddenDim), m_recurrentOp(recurrentOp), m_initialState(initialState),
+          m_carriedOutput(deviceId), m_carriedCell(deviceId), m_peepholeGradient(deviceId), m_backpropDone(false)
+    {
+    }
+    FusedRNNNode(const ScriptableObjects::IConfigRecordPtr configp)
+        : FusedRNNNode(configp->Get(L"deviceId"), L"<placeholder>", configp->Get(L"hiddenDim"), configp->Get(L"recurrentOp"), configp->Get(L"initialState"))
+    {
+        AttachInputsFromConfig(configp);
+    }
+
+    virtual void /*ComputationNodeBase::*/ CopyTo(ComputationNodeBasePtr nodeP, const std::wstring& newName, const CopyNodeFlags flags) const override;
+    virtual void /*ComputationNodeBase::*/ Load(File& fstream, size_t modelVersion) override;
+    virtual void /*ComputationNodeBase::*/ Save(File& fstream) const override;
+    virtual void /*ComputationNodeNonLooping::*/ ForwardPropNonLooping() override;
+    virtual void /*ComputationNodeNonLooping::*/ BackpropToNonLooping(size_t inputIndex) override;
+    virtual bool /*ComputationNodeBase::*/ OutputUsedInComputingInputNodesGradients() const override { return false; }
+    virtual bool /*ComputationNodeBase::*/ InputUsedInComputingInputNodesGradients(size_t childIndex) const override { return childIndex != BIAS; }
+    virtual void /*ComputationNodeBase::*/ Validate(bool isFinalValidationPass) override;
+
+    virtual void RequestMatricesBeforeForwardProp(MatrixPool& matrixPool) override;
+    virtual void RequestMatricesBeforeBackprop(MatrixPool& matrixPool) override;
+    virtual void ReleaseMatricesAfterBackprop(MatrixPool& matrixPool) override;
+
+private:
+    bool IsLSTM() const { return m_recurrentOp == L"lstm"; }
+    size_t NumGates() const { return IsLSTM() ? 4 : 3; }
+    bool HasPeepholes() const { return GetNumInputs() > PEEPHOLES; }
+    void InitializeStates(size_t t);
+    void BackpropThroughTime();
+
+    size_t m_hiddenDim;         // H
+    std::wstring m_recurrentOp; // "lstm" or "gru"
+    ElemType m_initialState;    // initial value of h and c at sequence start
+
+    // forward state, kept for BPTT; all [.. x T*S] over the whole minibatch
+    shared_ptr<Matrix<ElemType>> m_gates;      // [G*H] gate activations; overwritten with their pre-activation gradients in BPTT
+    shared_ptr<Matrix<ElemType>> m_recurrence; // [G*H] R * h(t-1), or its gradient for GRU
+    shared_ptr<Matrix<ElemType>> m_prevOutput; // [H] h(t-1)
+    shared_ptr<Matrix<ElemType>> m_prevCell;   // [H] c(t-1) (LSTM only)
+    shared_ptr<Matrix<ElemType>> m_cell;       // [H] c(t) for LSTM, Rn * h(t-1) for GRU
+
+    // BPTT temporaries, [H x S]
+    shared_ptr<Matrix<ElemType>> m_dh;
+    shared_ptr<Matrix<ElemType>> m_dhRecurrent;
+    shared_ptr<Matrix<ElemType>> m_dcRecurrent;
+
+    Matrix<ElemType> m_carriedOutput;    // [H x S] last h of sequences that continue into the next minibatch
+    Matrix<ElemType> m_carriedCell;      // [H x S] same for c
+    Matrix<ElemType> m_peepholeGradient; // [H x 3]
+    bool m_backpropDone;                 // BPTT is run upon the first BackpropTo() call after ForwardProp() and reused for all inputs
+};
+
 }}}
@@ -103,6 +103,8 @@ template class SquareErrorNode<double>;
 // -----------------------------------------------------------------------
 // CrossEntropyWithSoftmaxNode (labels, prediction)
 // calculates: -sum(left_i * log(softmax_i(right)))
+// The softmax is never stored: ForwardProp() computes the column-wise log-sum-exp and the criterion in a single fused pass,
+// and BackpropTo() forms softmax - labels on the fly from the log-sum-exp. Only a row vector is kept between the two.
 // -----------------------------------------------------------------------
 
 template <class ElemType>
@@ -128,14 +130,18 @@ public:
         // left input is scalar
         if (inputIndex == 0) // left derivative
         {
+            // Labels rarely need a gradient, so instead of keeping the log softmax from ForwardProp(), it is recomputed here.
+            Matrix<ElemType> logSoftmaxOfRight(m_deviceId);
+            logSoftmaxOfRight.AssignLogSoftmaxOf(Input(1)->ValueFor(fr), true);
+            MaskMissingColumnsToZero(logSoftmaxOfRight, Input(1)->GetMBLayout(), fr);
 #if DUMPOUTPUT
-            m_logSoftmaxOfRight->Print("CrossEntropyWithSoftmax Partial-logSoftmaxOfRight");
+            logSoftmaxOfRight.Print("CrossEntropyWithSoftmax Partial-logSoftmaxOfRight");
             Gradient().Print("CrossEntropyWithSoftmax Partial-gradientValues");
             Input(0)->GradientFor(fr).Print("CrossEntropyWithSoftmaxNode Partial-Left-in");
 #endif
 
             auto gradient = Input(0)->GradientFor(fr);
-            Matrix<ElemType>::Multiply1x1AndWeightedAdd(-1.0f, Gradient() /*1x1*/, *m_logSoftmaxOfRight, 1.0f, gradient);
+            Matrix<ElemType>::Multiply1x1AndWeightedAdd(-1.0f, Gradient() /*1x1*/, logSoftmaxOfRight, 1.0f, gradient);
 #if DUMPOUTPUT
             Input(0)->GradientFor(fr).Print("CrossEntropyWithSoftmaxNode Partial-Left-out");
 #endif
@@ -144,14 +150,15 @@ public:
         else if (inputIndex == 1) // right derivative
         {
 #if DUMPOUTPUT
-            m_softmaxOfRight->Print("CrossEntropyWithSoftmax Partial-softmaxOfRight");
+            m_logSumExpOfRight->Print("CrossEntropyWithSoftmax Partial-logSumExpOfRight");
             Input(0)->ValueFor(fr).Print("CrossEntropyWithSoftmax Partial-inputFunctionValues");
             Gradient().Print("CrossEntropyWithSoftmax Partial-gradientValues");
             Input(1)->GradientFor(fr).Print("CrossEntropyWithSoftmaxNode Partial-Right-in");
 #endif
 
+            // gradient += Gradient() * (softmax(right) - left), with the softmax formed on the fly
             auto gradient = Input(1)->GradientFor(fr);
-            Matrix<ElemType>::AddScaledDifference(Gradient(), *m_softmaxOfRight, Input(0)->ValueFor(fr), gradient);
+            Matrix<ElemType>::AddScaledSoftmaxDifference(Gradient(), Input(1)->ValueFor(fr), *m_logSumExpOfRight, Input(0)->ValueFor(fr), gradient);
 #if DUMPOUTPUT
             Input(1)->GradientFor(fr).Print("CrossEntropyWithSoftmaxNode Partial-Right");
 #endif
@@ -168,24 +175,19 @@ public:
 
     virtual void UpdateFunctionMBSize() override
     {
-        m_logSoftmaxOfRight->Resize(Input(1)->Value());
-        m_softmaxOfRight->Resize(*m_logSoftmaxOfRight);
+        m_logSumExpOfRight->Resize(1, Input(1)->Value().GetNumCols());
+        m_crossEntropyOfColumns->Resize(*m_logSumExpOfRight);
     }
 
     virtual void /*ComputationNodeNonLooping::*/ ForwardPropNonLooping() override // -sum(left_i * log(softmax_i(right)))
     {
         FrameRange fr(Input(0)->GetMBLayout());
-        // first compute the softmax (column-wise)
-        // Note that we need both log and non-log for gradient computation.
-        m_logSoftmaxOfRight->AssignLogSoftmaxOf(Input(1)->ValueFor(fr), true);
-        // BUGBUG: No need to compute m_softmaxOfRight in ForwardProp, should be moved to BackpropTo().
-        m_softmaxOfRight->SetValue(*m_logSoftmaxOfRight);
-        m_softmaxOfRight->InplaceExp();
+        // log-sum-exp and cross entropy of every column in one pass over the prediction
+        Matrix<ElemType>::SoftmaxCrossEntropy(Input(0)->ValueFor(fr), Input(1)->ValueFor(fr), *m_logSumExpOfRight, *m_crossEntropyOfColumns);
         // flatten all gaps to zero, such that gaps will contribute zero to the sum
-        MaskMissingColumnsToZero(*m_logSoftmaxOfRight, Input(1)->GetMBLayout(), fr);
+        MaskMissingColumnsToZero(*m_crossEntropyOfColumns, Input(1)->GetMBLayout(), fr);
         // reduce over all frames
-        Value().AssignInnerProductOfMatrices(Input(0)->MaskedValueFor(fr), *m_logSoftmaxOfRight);
-        Value() *= -1;
+        Value().AssignSumOfElements(*m_crossEntropyOfColumns);
 #if NANCHECK
         Value().HasNan("CrossEntropyWithSoftmax");
 #endif
@@ -205,8 +207,8 @@ public:
         if (flags & CopyNodeFlags::copyNodeValue)
         {
             auto node = dynamic_pointer_cast<CrossEntropyWithSoftmaxNode<ElemType>>(nodeP);
-            node->m_logSoftmaxOfRight->SetValue(*m_logSoftmaxOfRight);
-            node->m_softmaxOfRight->SetValue(*m_softmaxOfRight);
+            node->m_logSumExpOfRight->SetValue(*m_logSumExpOfRight);
+            node->m_crossEntropyOfColumns->SetValue(*m_crossEntropyOfColumns);
         }
     }
 
@@ -214,13 +216,13 @@ public:
     virtual void RequestMatricesBeforeForwardProp(MatrixPool& matrixPool)
     {
         Base::RequestMatricesBeforeForwardProp(matrixPool);
-        RequestMatrixFromPool(m_logSoftmaxOfRight, matrixPool);
-        RequestMatrixFromPool(m_softmaxOfRight, matrixPool);
+        RequestMatrixFromPool(m_logSumExpOfRight, matrixPool);
+        RequestMatrixFromPool(m_crossEntropyOfColumns, matrixPool);
     }
 
 protected:
-    shared_ptr<Matrix<ElemType>> m_logSoftmaxOfRight;
-    shared_ptr<Matrix<ElemType>> m_softmaxOfRight;
+    shared_ptr<Matrix<ElemType>> m_logSumExpOfRight;     // [1 x T] log (sum_i exp (right_i)) per column; all that BackpropTo() needs to form the softmax
+    shared_ptr<Matrix<ElemType>> m_crossEntropyOfColumns; // [1 x T] criterion per column, before masking and reduction
 };
 
 template class CrossEntropyWithSoftmaxNode<float>;
@@ -7,6 +7,7 @@
 
 #include "stdafx.h"
 #define EVAL_EXPORTS // creating the exports here
+#include "Basics.h"
 #include "Eval.h"
 #include "Actions.h"
 #include "CNTKEval.h"
@@ -244,7 +245,7 @@ VariableLayout CNTKEvalExtended<ElemType>::ToVariableLayout(const ComputationNod
                                 matrix->GetMatrixType() == MatrixType::SPARSE ? VariableLayout::Sparse : 
                                 VariableLayout::Undetermined :
                                 VariableLayout::Undetermined,
-        /* dimension */     n->GetSampleLayout().GetNumElements()
+        /* dimension */     (int) n->GetSampleLayout().GetNumElements()
     };
 }
 
@@ -300,96 +301,307 @@ VariableSchema CNTKEvalExtended<ElemType>::GetInputSchema() const
     return inputLayouts;
 }
 
+// Output buffers that are caller-owned views may borrow the memory of a dense CPU output matrix instead of copying.
+template<typename ElemType>
+static bool BorrowOutput(std::vector<ElemType>&, const Matrix<ElemType>&)
+{
+    return false;
+}
+
+template<typename ElemType>
+static bool BorrowOutput(VectorRef<ElemType>& vec, const Matrix<ElemType>& matrix)
+{
+    if (matrix.GetDeviceId() != CPUDEVICE || matrix.GetMatrixType() != MatrixType::DENSE)
+        return false;
+
+    vec.InitFrom(matrix.Data(), matrix.GetNumElements(), matrix.GetNumElements());
+    return true;
+}
+
 template<typename ElemType>
 void CNTKEvalExtended<ElemType>::ForwardPass(const Values<ElemType>& inputs, Values<ElemType>& outputs)
+{
+    ForwardPassImpl<ValueBuffer<ElemType>>({ &inputs }, { &outputs });
+}
+
+template<typename ElemType>
+void CNTKEvalExtended<ElemType>::ForwardPass(const ValueRefs<ElemType>& inputs, ValueRefs<ElemType>& outputs)
+{
+    ForwardPassImpl<ValueBufferRef<ElemType>>({ &inputs }, { &outputs });
+}
+
+template<typename ElemType>
+void CNTKEvalExtended<ElemType>::ForwardPass(const std::vector<Values<ElemType>>& inputs, std::vector<Values<ElemType>>& outputs)
+{
+    if (inputs.size() != outputs.size())
+        RuntimeError("Expected output buffers for %d sequences, but got %d.", (int)inputs.size(), (int)outputs.size());
+    if (inputs.empty())
+        RuntimeError("Expected at least one sequence.");
+
+    std::vector<const Values<ElemType>*> sequenceInputs(inputs.size());
+    std::vector<Values<ElemType>*> sequenceOutputs(outputs.size());
+    for (size_t k = 0; k < inputs.size(); ++k)
+    {
+        sequenceInputs[k] = &inputs[k];
+        sequenceOutputs[k] = &outputs[k];
+    }
+
+    ForwardPassImpl<ValueBuffer<ElemType>>(sequenceInputs, sequenceOutputs);
+}
+
+// Checks the buffer of a single sequence against the input matrix type and returns the number of samples in it.
+template<typename ElemType>
+template<typename ValueBufferType>
+size_t CNTKEvalExtended<ElemType>::GetNumSamples(const ComputationNodeBasePtr& node, MatrixType type, size_t numRows, const ValueBufferType& buffer)
+{
+    if (type == MatrixType::DENSE)
+    {
+        if (buffer.m_buffer.size() % numRows != 0)
+            RuntimeError("Input %ls: Expected input data to be a multiple of %ld, but it is %ld", node->GetName().c_str(), numRows, buffer.m_buffer.size());
+        if (buffer.m_buffer.size() == 0)
+            RuntimeError("Input %ls: Expected at least one element.", node->GetName().c_str());
+        return buffer.m_buffer.size() / numRows;
+    }
+    else if (type == MatrixType::SPARSE)
+    {
+        if (buffer.m_colIndices.size() < 2)
+            RuntimeError("Input %ls: Expected at least one element.", node->GetName().c_str());
+        if (buffer.m_colIndices[0] != 0)
+            RuntimeError("Input %ls: First element of column indices must be 0", node->GetName().c_str());
+        if (buffer.m_colIndices[buffer.m_colIndices.size()-1] != buffer.m_indices.size())
+            RuntimeError("Input %ls: Last element of column indices must be equal to the size of indices (%ld), but was %d", node->GetName().c_str(), buffer.m_indices.size(), buffer.m_colIndices[buffer.m_colIndices.size() - 1]);
+        return buffer.m_colIndices.size() - 1;
+    }
+    RuntimeError("Input %ls: Unsupported matrix type.", node->GetName().c_str());
+}
+
+// Packs the inputs of all sequences into the input matrices, runs the forward pass and scatters the
+// outputs back. A sequence is identified by its index in 'inputs', which is also used as its sequence id in the
+// MBLayout, such that outputs can be mapped back even if an output node has a different layout than the inputs.
+// With the ValueRefs API, which passes a single sequence, dense inputs are bound to the input matrices without copying
+// if the network runs on the CPU. They are unbound again before returning, so the network never holds on to the
+// caller's memory. The Values API, and the packing of several sequences, always copy.
+template<typename ElemType>
+template<typename ValueBufferType>
+void CNTKEvalExtended<ElemType>::ForwardPassImpl(const std::vector<const std::vector<ValueBufferType>*>& inputs, const std::vector<std::vector<ValueBufferType>*>& outputs)
 {
     if (!m_started)
         RuntimeError("ForwardPass() called before StartForwardEvaluation()");
 
-    if (inputs.size() != (size_t)std::distance(m_inputMatrices.begin(), m_inputMatrices.end()))
-        RuntimeError("Expected %d inputs, but got %d.", (int)std::distance(m_inputMatrices.begin(), m_inputMatrices.end()), (int)inputs.size());
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    const size_t numInputs = (size_t)std::distance(m_inputMatrices.begin(), m_inputMatrices.end());
+    const size_t numSequences = inputs.size();
+    for (size_t k = 0; k < numSequences; ++k)
+    {
+        if (inputs[k]->size() != numInputs)
+            RuntimeError("Expected %d inputs, but got %d.", (int)numInputs, (int)inputs[k]->size());
+
+        if (outputs[k]->size() != m_outputNodes.size())
+            RuntimeError("Expected %d outputs, but got %d.", (int)m_outputNodes.size(), (int)outputs[k]->size());
+    }
 
-    if (outputs.size() != m_outputNodes.size())
-        RuntimeError("Expected %d outputs, but got %d.", (int)m_outputNodes.size(), (int)outputs.size());
+    // input matrices bound to memory that is not owned by the network; released when leaving this function
+    std::vector<shared_ptr<Matrix<ElemType>>> boundMatrices;
+    auto unbindInputs = MakeScopeExit([&boundMatrices]()
+    {
+        for (auto& matrix : boundMatrices)
+            matrix->SetValue(0, 0, CPUDEVICE, nullptr, matrixFlagNormal);
+    });
 
     size_t i = 0;
     for (auto& input : m_inputMatrices)
     {
-        ValueBuffer<ElemType> buffer = inputs[i];
         shared_ptr<Matrix<ElemType>> matrix = dynamic_pointer_cast<Matrix<ElemType>>(input.second.matrix);
         auto type = matrix->GetMatrixType();
-        int numRows = input.second.sampleLayout.GetNumElements();
+        size_t numRows = input.second.sampleLayout.GetNumElements();
 
-        if (type == MatrixType::DENSE)
+        // determine the sequence lengths and pack the sequences into parallel streams
+        m_sequenceInfos.resize(numSequences);
+        for (size_t k = 0; k < numSequences; ++k)
         {
-            if (buffer.m_buffer.size() % numRows != 0)
-                RuntimeError("Input %ls: Expected input data to be a multiple of %ld, but it is %ld", m_inputNodes[i]->GetName().c_str(), numRows, buffer.m_buffer.size());
-            if (buffer.m_buffer.size() == 0)
-                RuntimeError("Input %ls: Expected at least one element.", m_inputNodes[i]->GetName().c_str());
+            size_t numSamples = GetNumSamples(m_inputNodes[i], type, numRows, (*inputs[k])[i]);
+            assert(numSamples >= 1);
+            m_sequenceInfos[k] = MBLayout::SequenceInfo{ k, SIZE_MAX, 0, numSamples };
         }
-        else if (type == MatrixType::SPARSE)
+        auto& pMBLayout = input.second.pMBLayout;
+        pMBLayout->InitAsPackedSequences(m_sequenceInfos, m_placementBuffer, m_rowAllocationsBuffer);
+
+        const size_t numParallelSequences = pMBLayout->GetNumParallelSequences();
+        const size_t numCols = pMBLayout->GetNumCols();
+
+        if (numSequences == 1)
         {
-            if (buffer.m_colIndices.size() < 2)
-                RuntimeError("Input %ls: Expected at least one element.", m_inputNodes[i]->GetName().c_str());
-            if (buffer.m_colIndices[0] != 0)
-                RuntimeError("Input %ls: First element of column indices must be 0", m_inputNodes[i]->GetName().c_str());
-            if (buffer.m_colIndices[buffer.m_colIndices.size()-1] != buffer.m_indices.size())
-                RuntimeError("Input %ls: Last element of column indices must be equal to the size of indices (%ld), but was %d", m_inputNodes[i]->GetName().c_str(), buffer.m_indices.size(), buffer.m_colIndices[buffer.m_colIndices.size() - 1]);
+            // single sequence: the buffer already has the minibatch layout
+            // The network never writes into its inputs, so memory referenced by the caller can be used as is.
+            const bool bindInput = std::is_same<ValueBufferType, ValueBufferRef<ElemType>>::value && matrix->GetDeviceId() == CPUDEVICE;
+            const ValueBufferType& buffer = (*inputs[0])[i];
+            if (type == MatrixType::DENSE)
+            {
+                matrix->SetValue(numRows, numCols, matrix->GetDeviceId(), const_cast<ElemType*>(buffer.m_buffer.data()), bindInput ? matrixFlagDontOwnBuffer : matrixFlagNormal);
+                if (bindInput)
+                    boundMatrices.push_back(matrix);
+            }
+            else
+                // In the sparse case the m_data layout is identical to CUDA's CSC layout
+                // (see http://docs.nvidia.com/cuda/cusparse/#compressed-sparse-column-format-csc).
+                matrix->SetMatrixFromCSCFormat(buffer.m_colIndices.data(), buffer.m_indices.data(), buffer.m_buffer.data(), buffer.m_buffer.size(), numRows, numCols);
         }
-
-        int numCols = type == MatrixType::DENSE ? buffer.m_buffer.size() / numRows : buffer.m_colIndices.size() - 1;
-        assert(numCols >= 1);
-        input.second.pMBLayout->Init(1, numCols);
-        input.second.pMBLayout->AddSequence(0, 0, 0, numCols);
-       
-        if (type == MatrixType::DENSE)
+        else if (type == MatrixType::DENSE)
         {
-            matrix->SetValue(numRows, numCols, matrix->GetDeviceId(), buffer.m_buffer.data(), matrixFlagNormal);
+            // interleave the samples of all sequences; gaps are left as zero
+            m_packedDenseValues.assign(numRows * numCols, 0);
+            for (const auto& seq : pMBLayout->GetAllSequences())
+            {
+                if (seq.seqId == GAP_SEQUENCE_ID)
+                    continue;
+                const auto& buffer = (*inputs[seq.seqId])[i].m_buffer;
+                for (size_t t = 0; t < seq.GetNumTimeSteps(); ++t)
+                {
+                    size_t col = pMBLayout->GetColumnIndex(seq, t);
+                    std::copy(buffer.begin() + t * numRows, buffer.begin() + (t + 1) * numRows, m_packedDenseValues.begin() + col * numRows);
+                }
+            }
+            matrix->SetValue(numRows, numCols, matrix->GetDeviceId(), m_packedDenseValues.data(), matrixFlagNormal);
         }
-        else if (type == MatrixType::SPARSE)
+        else
         {
-            // In the sparse case the m_data layout is identical to CUDA's CSC layout
-            // (see http://docs.nvidia.com/cuda/cusparse/#compressed-sparse-column-format-csc).
-            matrix->SetMatrixFromCSCFormat(buffer.m_colIndices.data(), buffer.m_indices.data(), buffer.m_buffer.data(), buffer.m_buffer.size(), numRows, numCols);
+            // build a combined CSC structure: find the source of every column first, then concatenate
+            m_columnSources.assign(numCols, std::make_pair(SIZE_MAX, (size_t)0));
+            size_t nnz = 0;
+            for (const auto& seq : pMBLayout->GetAllSequences())
+            {
+                if (seq.seqId == GAP_SEQUENCE_ID)
+                    continue;
+                for (size_t t = 0; t < seq.GetNumTimeSteps(); ++t)
+                    m_columnSources[pMBLayout->GetColumnIndex(seq, t)] = std::make_pair((size_t)seq.seqId, t);
+                nnz += (*inputs[seq.seqId])[i].m_indices.size();
+            }
+
+            m_packedSparseValues.resize(nnz);
+            m_packedIndices.resize(nnz);
+            m_packedColIndices.resize(numCols + 1);
+            m_packedColIndices[0] = 0;
+            for (size_t col = 0; col < numCols; ++col)
+            {
+                int start = m_packedColIndices[col];
+                int end = start;
+                if (m_columnSources[col].first != SIZE_MAX)
+                {
+                    const ValueBufferType& buffer = (*inputs[m_columnSources[col].first])[i];
+                    size_t t = m_columnSources[col].second;
+                    int srcStart = buffer.m_colIndices[t];
+                    int srcEnd = buffer.m_colIndices[t + 1];
+                    std::copy(buffer.m_buffer.begin() + srcStart, buffer.m_buffer.begin() + srcEnd, m_packedSparseValues.begin() + start);
+                    std::copy(buffer.m_indices.begin() + srcStart, buffer.m_indices.begin() + srcEnd, m_packedIndices.begin() + start);
+                    end += srcEnd - srcStart;
+                }
+                m_packedColIndices[col + 1] = end;
+            }
+            matrix->SetMatrixFromCSCFormat(m_packedColIndices.data(), m_packedIndices.data(), m_packedSparseValues.data(), nnz, numRows, numCols);
         }
 
         ++i;
     }
 
     ComputationNetwork::BumpEvalTimeStamp(m_inputNodes);
-    
+
     for (size_t i = 0; i < m_outputNodes.size(); ++i)
     {
         auto node = m_outputNodes[i];
         m_net->ForwardProp(node);
         shared_ptr<Matrix<ElemType>> outputMatrix = dynamic_pointer_cast<Matrix<ElemType>>(node->ValuePtr());
         auto pMBLayout = node->GetMBLayout();
-        if (!pMBLayout) 
+        if (!pMBLayout)
         {
             pMBLayout = make_shared<MBLayout>();
             pMBLayout->InitAsFrameMode(1); // treat this as if we have one single sample
         }
 
-        const auto& seq = pMBLayout->GetAllSequences();
-        if (seq.size() != 1)
+        const auto& seqs = pMBLayout->GetAllSequences();
+        size_t numSequencesFound = 0;
+        for (const auto& seq : seqs)
+            if (seq.seqId != GAP_SEQUENCE_ID)
+                numSequencesFound++;
+
+        // an output without dynamic axis is shared by all sequences
+        const bool isShared = !node->HasMBLayout();
+        if (!isShared && numSequencesFound != numSequences)
+            RuntimeError("Output %ls: Expected %d output sequences, but got %d.", node->GetName().c_str(), (int)numSequences, (int)numSequencesFound);
+
+        size_t numElements = outputMatrix->GetNumElements();
+        if (isShared || (numSequences == 1 && pMBLayout->GetNumParallelSequences() == 1))
         {
-            RuntimeError("Only 1 output sequence supported by this API");
+            // the output matrix can be copied as is
+            for (size_t k = 0; k < numSequences; ++k)
+            {
+                auto& vec = (*outputs[k])[i].m_buffer;
+                if (vec.data() == nullptr && BorrowOutput(vec, *outputMatrix))
+                    continue;
+
+                if (vec.capacity() < numElements)
+                {
+                    // Bad luck - we can't reallocate memory of an external object at this point.
+                    RuntimeError("Not enough space in output buffer for output '%ls'.", node->GetName().c_str());
+                }
+
+                vec.resize(numElements);
+                ElemType* data = const_cast<ElemType*>(vec.data());
+                outputMatrix->CopyToArray(data, numElements);
+            }
+            continue;
         }
 
-        std::vector<ElemType>& vec = outputs[i].m_buffer;
-        
-        size_t numElements = outputMatrix->GetNumElements();
+        // copy the whole matrix once, then scatter the columns to the per-sequence buffers
+        size_t numRows = outputMatrix->GetNumRows();
+        m_packedOutputValues.resize(numElements);
+        ElemType* packed = m_packedOutputValues.data();
+        outputMatrix->CopyToArray(packed, numElements);
 
-        if (vec.capacity() < numElements)
+        for (const auto& seq : seqs)
         {
-            // Bad luck - we can't reallocate memory of an external object at this point.
-            RuntimeError("Not enough space in output buffer for output '%ls'.", node->GetName().c_str());
+            if (seq.seqId == GAP_SEQUENCE_ID)
+                continue;
+            if (seq.seqId >= numSequences)
+                LogicError("Output %ls: Unexpected sequence id %d.", node->GetName().c_str(), (int)seq.seqId);
+
+            auto& vec = (*outputs[seq.seqId])[i].m_buffer;
+            size_t numSeqElements = numRows * seq.GetNumTimeSteps();
+            if (vec.capacity() < numSeqElements)
+            {
+                // Bad luck - we can't reallocate memory of an external object at this point.
+                RuntimeError("Not enough space in output buffer for output '%ls'.", node->GetName().c_str());
+            }
+
+            vec.resize(numSeqElements);
+            for (size_t t = 0; t < seq.GetNumTimeSteps(); ++t)
+            {
+                size_t col = pMBLayout->GetColumnIndex(seq, t);
+                std::copy(packed + col * numRows, packed + (col + 1) * numRows, vec.begin() + t * numRows);
+            }
         }
+    }
+}
 
-        vec.resize(numElements);
-        ElemType* data = const_cast<ElemType*>(vec.data());
-        outputMatrix->CopyToArray(data, numElements);
+template <typename ElemType>
+IEvaluateModelExtended<ElemType>* CNTKEvalExtended<ElemType>::Clone()
+{
+    if (m_net == nullptr)
+        RuntimeError("Clone() called before CreateNetwork()");
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto clone = new CNTKEvalExtended<ElemType>();
+    clone->m_config = m_config;
+    clone->m_net = m_net->CloneWithSharedParameters();
+    if (m_started)
+    {
+        std::vector<wstring> outputNodeNames;
+        for (const auto& node : m_outputNodes)
+            outputNodeNames.push_back(node->NodeName());
+        clone->StartForwardEvaluation(outputNodeNames);
     }
+    return clone;
 }
 
 template <typename ElemType>
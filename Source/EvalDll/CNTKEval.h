@@ -13,6 +13,7 @@
 #include <string>
 #include <map>
 #include <vector>
+#include <mutex>
 
 #include "Eval.h"
 #include "EvalReader.h"
@@ -47,6 +48,11 @@ public:
 template <typename ElemType>
 class CNTKEval : public CNTKEvalBase<ElemType>, public IEvaluateModel<ElemType>
 {
+    typedef CNTKEvalBase<ElemType> Base;
+    using Base::m_config;
+    using Base::m_net;
+    using typename Base::ComputationNodePtr;
+
     EvalReader<ElemType>* m_reader;
     EvalWriter<ElemType>* m_writer;
     std::map<std::wstring, size_t> m_dimensions;
@@ -89,6 +95,11 @@ public:
 template <typename ElemType>
 class CNTKEvalExtended : public CNTKEvalBase<ElemType>, public IEvaluateModelExtended<ElemType>
 {
+    typedef CNTKEvalBase<ElemType> Base;
+    using Base::m_config;
+    using Base::m_net;
+    using typename Base::ComputationNodePtr;
+
 public:
     CNTKEvalExtended() : CNTKEvalBase<ElemType>(), m_started(false) {}
 
@@ -100,6 +111,12 @@ public:
 
     virtual void ForwardPass(const Values<ElemType>& inputs, Values<ElemType>& output) override;
 
+    virtual void ForwardPass(const ValueRefs<ElemType>& inputs, ValueRefs<ElemType>& outputs) override;
+
+    virtual void ForwardPass(const std::vector<Values<ElemType>>& inputs, std::vector<Values<ElemType>>& outputs) override;
+
+    virtual IEvaluateModelExtended<ElemType>* Clone() override;
+
     virtual void Destroy() override;
 
     virtual void CreateNetwork(const std::string& networkDescription) override
@@ -113,10 +130,29 @@ public:
     }
 private:
     static VariableLayout ToVariableLayout(const ComputationNodeBasePtr n);
+    template<typename ValueBufferType>
+    static size_t GetNumSamples(const ComputationNodeBasePtr& node, MatrixType type, size_t numRows, const ValueBufferType& buffer);
+    template<typename ValueBufferType>
+    void ForwardPassImpl(const std::vector<const std::vector<ValueBufferType>*>& inputs, const std::vector<std::vector<ValueBufferType>*>& outputs);
+
     std::vector<ComputationNodeBasePtr> m_outputNodes;
     std::shared_ptr<ScopedNetworkOperationMode> m_scopedNetworkOperationMode;
     std::vector<ComputationNodeBasePtr> m_inputNodes;
     StreamMinibatchInputs m_inputMatrices;
     bool m_started;
+
+    // serializes ForwardPass() against Clone(), which reads the node values of this network
+    std::mutex m_mutex;
+
+    // temp buffers for packing several sequences into one minibatch (kept to avoid reallocation)
+    std::vector<MBLayout::SequenceInfo> m_sequenceInfos;
+    std::vector<std::pair<size_t, size_t>> m_placementBuffer;
+    std::vector<size_t> m_rowAllocationsBuffer;
+    std::vector<std::pair<size_t, size_t>> m_columnSources;
+    std::vector<ElemType> m_packedDenseValues;
+    std::vector<ElemType> m_packedSparseValues;
+    std::vector<ElemType> m_packedOutputValues;
+    std::vector<int> m_packedIndices;
+    std::vector<int> m_packedColIndices;
 };
 } } }
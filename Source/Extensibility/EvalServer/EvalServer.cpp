@@ -0,0 +1,207 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// EvalServer.cpp : Reference evaluation server on top of the extended evaluation interface (IEvaluateModelExtended).
+//
+// Requests that arrive concurrently are collected into batches of up to 'maxBatchSize' requests, waiting at most
+// 'maxDelayMs' after the first request of a batch, and evaluated in a single batched ForwardPass(). Every worker
+// thread owns a Clone() of the model, so the parameters are shared among all workers.
+//
+// Usage:
+//   EvalServer modelPath=<model> [outputNodeNames=<a:b>] [deviceId=-1] [maxBatchSize=32] [maxDelayMs=2]
+//              [numWorkers=1] [socket=<path>]
+// All other key=value arguments are passed on to CreateNetwork().
+//
+// Protocol (line based text, over stdin/stdout or, if 'socket' is given, a local UNIX domain socket):
+//   request:  one line per request holding the values of all inputs in the order of the input schema, inputs
+//             separated by '|', values separated by blanks. An input with N * dim values is a sequence of N samples.
+//   response: one line per request, in request order, holding the values of all outputs (separated by '|'),
+//             or a line starting with "ERROR" if the request could not be evaluated.
+//   "#stats": returns the current latency and throughput statistics as a single line.
+// Latency (p50/p99) and throughput statistics are printed to stderr when the server shuts down (end of stdin,
+// or SIGINT/SIGTERM in socket mode).
+//
+
+#include "EvalServer.h"
+
+#include <errno.h>
+#include <string.h>
+#include <atomic>
+#include <list>
+#include <map>
+
+#ifndef _WIN32
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+using namespace Microsoft::MSR::CNTK;
+using namespace Microsoft::MSR::CNTK::EvalServer;
+
+template <typename ElemType>
+using GetEvalProc = void (*)(IEvaluateModelExtended<ElemType>**);
+
+#ifndef _WIN32
+static volatile sig_atomic_t s_shutdown = 0;
+
+static void OnShutdownSignal(int)
+{
+    s_shutdown = 1;
+}
+
+// a connected client, served on its own thread
+// The streams are owned by the accepting thread and only closed after the client thread has been joined.
+struct Client
+{
+    FILE* m_in;
+    FILE* m_out;
+    std::thread m_thread;
+    std::atomic<bool> m_done;
+
+    Client(Server& server, int connection)
+        : m_in(fdopen(connection, "r")), m_out(fdopen(dup(connection), "w")), m_done(false)
+    {
+        if (!m_in || !m_out)
+            RuntimeError("EvalServer: cannot open client connection: %s", strerror(errno));
+        m_thread = std::thread([this, &server]
+        {
+            server.Serve(m_in, m_out);
+            m_done = true;
+        });
+    }
+
+    // let a client that is still connected finish: no more requests are read, pending responses are written
+    void Finish()
+    {
+        if (!m_done)
+            shutdown(fileno(m_in), SHUT_RD);
+        m_thread.join();
+        fclose(m_out);
+        fclose(m_in);
+    }
+};
+
+// join and release the clients that have disconnected, or all clients if 'all'
+static void FinishClients(std::list<std::unique_ptr<Client>>& clients, bool all)
+{
+    for (auto iter = clients.begin(); iter != clients.end();)
+    {
+        if (all || (*iter)->m_done)
+        {
+            (*iter)->Finish();
+            iter = clients.erase(iter);
+        }
+        else
+            iter++;
+    }
+}
+
+// accept connections on a UNIX domain socket, serving every client on its own thread, until SIGINT/SIGTERM
+static void ServeSocket(Server& server, const std::string& path)
+{
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0)
+        RuntimeError("EvalServer: cannot create socket: %s", strerror(errno));
+
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path))
+        InvalidArgument("EvalServer: socket path '%s' is too long.", path.c_str());
+    strcpy(address.sun_path, path.c_str());
+    unlink(path.c_str());
+    if (bind(listener, (sockaddr*) &address, sizeof(address)) < 0 || listen(listener, SOMAXCONN) < 0)
+        RuntimeError("EvalServer: cannot listen on '%s': %s", path.c_str(), strerror(errno));
+
+    // no SA_RESTART, so that accept() returns when a shutdown signal arrives
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = OnShutdownSignal;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    signal(SIGPIPE, SIG_IGN);
+
+    fprintf(stderr, "EvalServer: listening on '%s'\n", path.c_str());
+    std::list<std::unique_ptr<Client>> clients;
+    while (!s_shutdown)
+    {
+        int connection = accept(listener, nullptr, nullptr);
+        if (connection < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            FinishClients(clients, /*all=*/true);
+            RuntimeError("EvalServer: accept failed: %s", strerror(errno));
+        }
+        FinishClients(clients, /*all=*/false);
+        clients.push_back(std::unique_ptr<Client>(new Client(server, connection)));
+    }
+    FinishClients(clients, /*all=*/true);
+    close(listener);
+    unlink(path.c_str());
+}
+#endif
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        // server options; everything else is passed to CreateNetwork()
+        std::map<std::string, std::string> options = { { "maxBatchSize", "32" }, { "maxDelayMs", "2" }, { "numWorkers", "1" }, { "socket", "" } };
+        std::string networkConfiguration;
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            auto eq = arg.find('=');
+            if (eq == std::string::npos)
+                InvalidArgument("EvalServer: expected key=value arguments, got '%s'.", arg.c_str());
+            auto option = options.find(arg.substr(0, eq));
+            if (option != options.end())
+                option->second = arg.substr(eq + 1);
+            else
+                networkConfiguration += arg + "\n";
+        }
+        size_t maxBatchSize = std::max(atoi(options["maxBatchSize"].c_str()), 1);
+        size_t numWorkers = std::max(atoi(options["numWorkers"].c_str()), 1);
+        double maxDelayMs = std::max(atof(options["maxDelayMs"].c_str()), 0.0);
+
+        Plugin plugin;
+        auto getEvalProc = (GetEvalProc<float>) plugin.Load(L"EvalDll", "GetEvalExtendedF");
+        IEvaluateModelExtended<float>* model;
+        getEvalProc(&model);
+        model->CreateNetwork(networkConfiguration);
+
+        std::vector<std::wstring> outputNames;
+        for (const auto& output : model->GetOutputSchema())
+            outputNames.push_back(output.m_name);
+        model->StartForwardEvaluation(outputNames);
+
+        Server server(model, maxBatchSize, maxDelayMs);
+        server.Start(numWorkers);
+        fprintf(stderr, "EvalServer: %d worker(s), maxBatchSize = %d, maxDelayMs = %.3f\n", (int) numWorkers, (int) maxBatchSize, maxDelayMs);
+
+        if (options["socket"].empty())
+            server.Serve(stdin, stdout);
+        else
+        {
+#ifdef _WIN32
+            InvalidArgument("EvalServer: 'socket' is not supported on this platform, use stdin/stdout.");
+#else
+            ServeSocket(server, options["socket"]);
+#endif
+        }
+
+        server.Stop();
+        fprintf(stderr, "EvalServer: %s\n", server.Report().c_str());
+        model->Destroy();
+    }
+    catch (const std::exception& e)
+    {
+        fprintf(stderr, "EvalServer: %s\n", e.what());
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
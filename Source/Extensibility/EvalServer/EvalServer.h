@@ -0,0 +1,377 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// EvalServer.h : Request batching of the evaluation server (see EvalServer.cpp for the protocol).
+//
+
+#pragma once
+
+#include "Basics.h"
+#include "Eval.h"
+
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace EvalServer {
+
+typedef std::chrono::steady_clock Clock;
+
+// a single client request, completed by one of the workers
+struct Request
+{
+    Values<float> m_inputs;
+    Clock::time_point m_arrival;
+    std::promise<std::string> m_response;
+};
+
+typedef std::shared_ptr<Request> RequestPtr;
+
+// ---------------------------------------------------------------------------
+// RequestQueue -- queue of pending requests, handed out to the workers in batches
+// ---------------------------------------------------------------------------
+
+class RequestQueue
+{
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<RequestPtr> m_requests;
+    bool m_closed = false;
+
+public:
+    void Push(const RequestPtr& request)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_closed)
+                return request->m_response.set_value("ERROR server is shutting down");
+            m_requests.push_back(request);
+        }
+        m_cv.notify_one();
+    }
+
+    // no more requests will arrive; workers drain the queue and then stop
+    void Close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_closed = true;
+        }
+        m_cv.notify_all();
+    }
+
+    // Wait for the next batch. A batch is complete when it holds maxBatchSize requests, or when its first
+    // request has waited for maxDelay. Returns false once the queue is closed and empty.
+    bool PopBatch(size_t maxBatchSize, Clock::duration maxDelay, std::vector<RequestPtr>& batch)
+    {
+        batch.clear();
+        std::unique_lock<std::mutex> lock(m_mutex);
+        do
+        {
+            m_cv.wait(lock, [this] { return !m_requests.empty() || m_closed; });
+            if (m_requests.empty())
+                return false;
+
+            auto deadline = m_requests.front()->m_arrival + maxDelay;
+            m_cv.wait_until(lock, deadline, [&] { return m_requests.size() >= maxBatchSize || m_closed; });
+        } while (m_requests.empty()); // another worker took the requests while we were waiting
+
+        size_t n = std::min(maxBatchSize, m_requests.size());
+        batch.assign(m_requests.begin(), m_requests.begin() + n);
+        m_requests.erase(m_requests.begin(), m_requests.begin() + n);
+        if (!m_requests.empty())
+            m_cv.notify_one(); // more work for another worker
+        return true;
+    }
+};
+
+// ---------------------------------------------------------------------------
+// ServerStats -- latency and throughput measurements
+// ---------------------------------------------------------------------------
+
+class ServerStats
+{
+    std::mutex m_mutex;
+    std::vector<double> m_latencies; // in milliseconds, from arrival to completion of a request
+    size_t m_numBatches = 0;
+    size_t m_numFailedBatches = 0;
+    size_t m_numFailedRequests = 0;
+    Clock::time_point m_start = Clock::now();
+
+    static double Percentile(const std::vector<double>& sorted, double p)
+    {
+        if (sorted.empty())
+            return 0;
+        size_t rank = (size_t) ceil(p * sorted.size());
+        return sorted[std::max(rank, (size_t) 1) - 1];
+    }
+
+public:
+    void AddBatch(const std::vector<RequestPtr>& batch, Clock::time_point completion)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_numBatches++;
+        for (const auto& request : batch)
+            m_latencies.push_back(std::chrono::duration<double, std::milli>(completion - request->m_arrival).count());
+    }
+
+    // a batch whose evaluation failed; its requests are answered with an error and not part of the latencies
+    void AddFailedBatch(const std::vector<RequestPtr>& batch)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_numFailedBatches++;
+        m_numFailedRequests += batch.size();
+    }
+
+    std::string Report()
+    {
+        std::vector<double> sorted;
+        size_t numBatches, numFailedBatches, numFailedRequests;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            sorted = m_latencies;
+            numBatches = m_numBatches;
+            numFailedBatches = m_numFailedBatches;
+            numFailedRequests = m_numFailedRequests;
+        }
+        std::sort(sorted.begin(), sorted.end());
+        double seconds = std::chrono::duration<double>(Clock::now() - m_start).count();
+        return msra::strfun::strprintf("requests = %d; batches = %d; avg batch size = %.2f; throughput = %.1f requests/s; latency p50 = %.3f ms; p99 = %.3f ms; failed batches = %d (%d requests)",
+                                       (int) sorted.size(), (int) numBatches, numBatches > 0 ? (double) sorted.size() / numBatches : 0.0,
+                                       seconds > 0 ? sorted.size() / seconds : 0.0, Percentile(sorted, 0.5), Percentile(sorted, 0.99),
+                                       (int) numFailedBatches, (int) numFailedRequests);
+    }
+};
+
+// ---------------------------------------------------------------------------
+// request parsing and response formatting
+// ---------------------------------------------------------------------------
+
+// parse "v v v | v v" into one buffer per input; returns an error message, or an empty string on success
+static std::string ParseRequest(const std::string& line, const VariableSchema& inputSchema, Values<float>& inputs)
+{
+    inputs.assign(inputSchema.size(), ValueBuffer<float>());
+    size_t i = 0;
+    for (const char* p = line.c_str(); *p;)
+    {
+        char* end;
+        float value = strtof(p, &end);
+        if (end != p)
+        {
+            if (i >= inputs.size())
+                return msra::strfun::strprintf("ERROR request has more than the expected %d inputs", (int) inputs.size());
+            inputs[i].m_buffer.push_back(value);
+            p = end;
+        }
+        else if (*p == '|')
+            i++, p++;
+        else if (isspace((unsigned char) *p))
+            p++;
+        else
+            return msra::strfun::strprintf("ERROR unexpected character '%c' in request", *p);
+    }
+    if (i + 1 != inputs.size())
+        return msra::strfun::strprintf("ERROR request has %d inputs, expected %d", (int) i + 1, (int) inputs.size());
+    for (i = 0; i < inputs.size(); i++)
+    {
+        size_t dim = inputSchema[i].m_numElements;
+        if (inputs[i].m_buffer.empty() || inputs[i].m_buffer.size() % dim != 0)
+            return msra::strfun::strprintf("ERROR input '%ls' has %d values, expected a non-zero multiple of %d",
+                                           inputSchema[i].m_name.c_str(), (int) inputs[i].m_buffer.size(), (int) dim);
+    }
+    return std::string();
+}
+
+static std::string FormatResponse(const Values<float>& outputs)
+{
+    std::string response;
+    char value[32];
+    for (size_t i = 0; i < outputs.size(); i++)
+    {
+        if (i > 0)
+            response += " |";
+        for (float v : outputs[i].m_buffer)
+        {
+            sprintf(value, " %.9g", v);
+            response += value;
+        }
+    }
+    return response.empty() ? response : response.substr(1);
+}
+
+static bool ReadLine(FILE* f, std::string& line)
+{
+    line.clear();
+    char buf[4096];
+    while (fgets(buf, sizeof(buf), f))
+    {
+        line += buf;
+        if (!line.empty() && line.back() == '\n')
+        {
+            line.pop_back();
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+            return true;
+        }
+    }
+    return !line.empty();
+}
+
+// ---------------------------------------------------------------------------
+// Server -- workers and front-ends
+// ---------------------------------------------------------------------------
+
+class Server
+{
+    IEvaluateModelExtended<float>* m_model;
+    VariableSchema m_inputSchema;
+    VariableSchema m_outputSchema;
+    size_t m_maxBatchSize;
+    Clock::duration m_maxDelay;
+    RequestQueue m_queue;
+    ServerStats m_stats;
+    std::vector<std::thread> m_workers;
+
+    void RunWorker(IEvaluateModelExtended<float>* model)
+    {
+        std::vector<RequestPtr> batch;
+        std::vector<Values<float>> inputs;
+        std::vector<Values<float>> outputs;
+        while (m_queue.PopBatch(m_maxBatchSize, m_maxDelay, batch))
+        {
+            inputs.resize(batch.size());
+            outputs.resize(batch.size());
+            for (size_t k = 0; k < batch.size(); k++)
+            {
+                inputs[k].swap(batch[k]->m_inputs);
+
+                // ForwardPass() does not allocate outputs: reserve room for as many samples as the longest input
+                size_t numSamples = 1;
+                for (size_t i = 0; i < m_inputSchema.size(); i++)
+                    numSamples = std::max(numSamples, inputs[k][i].m_buffer.size() / m_inputSchema[i].m_numElements);
+                outputs[k].resize(m_outputSchema.size());
+                for (size_t j = 0; j < m_outputSchema.size(); j++)
+                    outputs[k][j].m_buffer.reserve(m_outputSchema[j].m_numElements * numSamples);
+            }
+            try
+            {
+                model->ForwardPass(inputs, outputs);
+                m_stats.AddBatch(batch, Clock::now());
+                for (size_t k = 0; k < batch.size(); k++)
+                    batch[k]->m_response.set_value(FormatResponse(outputs[k]));
+            }
+            catch (const std::exception& e)
+            {
+                m_stats.AddFailedBatch(batch);
+                std::string error = std::string("ERROR ") + e.what();
+                std::replace(error.begin(), error.end(), '\n', ' ');
+                for (auto& request : batch)
+                    request->m_response.set_value(error);
+            }
+        }
+        if (model != m_model)
+            model->Destroy();
+    }
+
+public:
+    Server(IEvaluateModelExtended<float>* model, size_t maxBatchSize, double maxDelayMs)
+        : m_model(model), m_inputSchema(model->GetInputSchema()), m_outputSchema(model->GetOutputSchema()), m_maxBatchSize(maxBatchSize),
+          m_maxDelay(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(maxDelayMs)))
+    {
+    }
+
+    void Start(size_t numWorkers)
+    {
+        for (size_t w = 0; w < numWorkers; w++)
+        {
+            auto model = w == 0 ? m_model : m_model->Clone();
+            m_workers.push_back(std::thread([this, model] { RunWorker(model); }));
+        }
+    }
+
+    // finish all pending requests and stop the workers
+    void Stop()
+    {
+        m_queue.Close();
+        for (auto& worker : m_workers)
+            worker.join();
+        m_workers.clear();
+    }
+
+    std::string Report() { return m_stats.Report(); }
+
+    // Serve one client: read requests from 'in' and write the responses to 'out' in request order.
+    // Requests are queued as soon as they are read, so that a single client can fill a batch by pipelining.
+    void Serve(FILE* in, FILE* out)
+    {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<std::future<std::string>> pending;
+        bool done = false;
+
+        std::thread writer([&]
+        {
+            for (;;)
+            {
+                std::future<std::string> response;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    cv.wait(lock, [&] { return !pending.empty() || done; });
+                    if (pending.empty())
+                        return;
+                    response = std::move(pending.front());
+                    pending.pop_front();
+                }
+                std::string line = response.get();
+                fprintf(out, "%s\n", line.c_str());
+                fflush(out);
+            }
+        });
+
+        std::string line;
+        while (ReadLine(in, line))
+        {
+            if (line.find_first_not_of(" \t") == std::string::npos)
+                continue;
+
+            auto request = std::make_shared<Request>();
+            request->m_arrival = Clock::now();
+            auto response = request->m_response.get_future();
+            if (line == "#stats")
+                request->m_response.set_value(Report());
+            else
+            {
+                std::string error = ParseRequest(line, m_inputSchema, request->m_inputs);
+                if (error.empty())
+                    m_queue.Push(request);
+                else
+                    request->m_response.set_value(error);
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            pending.push_back(std::move(response));
+            cv.notify_one();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            done = true;
+        }
+        cv.notify_one();
+        writer.join();
+    }
+};
+
+}}}}
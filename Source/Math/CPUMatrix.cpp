@@ -885,8 +885,9 @@ void CPUMatrix<ElemType>::SetValue(const size_t numRows, const size_t numCols, E
     // if it's externally managed, then populate the structure
     if (matrixFlags & matrixFlagDontOwnBuffer)
     {
-        // free previous array allocation if any before overwriting
-		delete[] Buffer();
+        // free previous array allocation if any before overwriting (unless it is itself externally managed)
+        if (!HasExternalBuffer())
+            delete[] Buffer();
 
         m_numRows = numRows;
         m_numCols = numCols;
@@ -895,6 +896,16 @@ void CPUMatrix<ElemType>::SetValue(const size_t numRows, const size_t numCols, E
     }
     else
     {
+        // copying into a matrix that is bound to external memory gives it its own storage again
+        if (HasExternalBuffer())
+        {
+            SetBuffer(nullptr, 0);
+            SetSizeAllocated(0);
+            m_sliceViewOffset = 0;
+            m_numRows = 0;
+            m_numCols = 0;
+        }
+
         RequireSize(numRows, numCols);
 
         if (!IsEmpty())
@@ -1164,47 +1175,31 @@ ElemType CPUMatrix<ElemType>::Adagrad(CPUMatrix<ElemType>& gradients, const bool
     assert(GetNumRows() == gradients.GetNumRows() && GetNumCols() == gradients.GetNumCols());
 
     ElemType *a = Data(), *d_v = gradients.Data();
-    size_t n = GetNumElements();
+    long n = (long) GetNumElements(); // note: OpenMP requires loop indices to be long, not size_t
 
     const ElemType floor = 1e-16f;
-    ElemType a0, a1, a2, a3;
 
-    // disable omp here because aveMultiper needs to be added atomically. however, it seems the result is incorrect even if rmp atomic and amp critical are used.
-    // #pragma omp parallel for
-    for (long i = 0; i < (n & ~3); i += 4) // four-way unrolling
+    // Each element is updated independently, so the update is identical to the serial loop regardless of the
+    // number of threads. Only the summation order of aveMultiplier differs, which is why it is a reduction variable
+    // (the previous omp version raced on it). The loop body is kept branch-free so that it can be vectorized.
+    if (needAveMultiplier)
     {
-        a[i] += d_v[i] * d_v[i];
-        a[i + 1] += d_v[i + 1] * d_v[i + 1];
-        a[i + 2] += d_v[i + 2] * d_v[i + 2];
-        a[i + 3] += d_v[i + 3] * d_v[i + 3];
-
-        a0 = sqrt(a[i] + floor);
-        a1 = sqrt(a[i + 1] + floor);
-        a2 = sqrt(a[i + 2] + floor);
-        a3 = sqrt(a[i + 3] + floor);
-
-        d_v[i] /= a0;
-        d_v[i + 1] /= a1;
-        d_v[i + 2] /= a2;
-        d_v[i + 3] /= a3;
-
-        if (needAveMultiplier)
+#pragma omp parallel for reduction(+ : aveMultiplier)
+        for (long i = 0; i < n; i++)
         {
-            aveMultiplier += 1 / a0 + 1 / a1 + 1 / a2 + 1 / a3;
+            a[i] += d_v[i] * d_v[i];
+            ElemType temp = sqrt(a[i] + floor);
+            d_v[i] /= temp;
+            aveMultiplier += 1 / temp;
         }
     }
-
-    // get the last few elements if any
-    for (long i = n & ~3; i < n; i++)
+    else
     {
-        a[i] += d_v[i] * d_v[i];
-
-        a0 = sqrt(a[i] + floor);
-        d_v[i] /= a0;
-
-        if (needAveMultiplier)
+#pragma omp parallel for
+        for (long i = 0; i < n; i++)
         {
-            aveMultiplier += 1 / a0;
+            a[i] += d_v[i] * d_v[i];
+            d_v[i] /= sqrt(a[i] + floor);
         }
     }
 
@@ -1232,36 +1227,56 @@ void CPUMatrix<ElemType>::FSAdagrad(CPUMatrix<ElemType>& gradients,
 
     assert((GetNumRows() == gradients.GetNumRows()) && (GetNumCols() == numColsNeeded));
 
-    size_t n = gradients.GetNumElements();
+    long n = (long) gradients.GetNumElements();
     ElemType* grad = gradients.Data();
     ElemType* smoothAda = Data();
     ElemType* smoothMom = Data() + n;
     ElemType* val = functionValues.Data();
-#pragma omp parallel for
-    // TODO: Unroll 4-times for better performance leveraging vectorization
-    for (long i = 0; i < n; i++)
+
+    // loop-invariant terms are hoisted and the momentum test is moved out of the loop, so that the inner loops are
+    // branch-light and can be vectorized; per-element results are unchanged
+    const ElemType oneMinusAdaWeight = 1.0f - adaWeight;
+    const ElemType oneMinusMomentum = 1.0f - momentum;
+    if (momentum > 0.0f)
     {
-        ElemType g = grad[i];
-        ElemType adaSqr = adaWeight * smoothAda[i] + (1.0f - adaWeight) * g * g;
-        smoothAda[i] = adaSqr;
-        if (adaSqr != 0.0f)
+#pragma omp parallel for
+        for (long i = 0; i < n; i++)
         {
-            ElemType ada = sqrt(adaSqr);
-            ElemType w = adaMul * ((ElemType) 1.0 / ada);
-
-            if (w > 10.0f)
-                w = 10.0f;
-            g *= w;
-        }
+            ElemType g = grad[i];
+            ElemType adaSqr = adaWeight * smoothAda[i] + oneMinusAdaWeight * g * g;
+            smoothAda[i] = adaSqr;
+            if (adaSqr != 0.0f)
+            {
+                ElemType w = adaMul * ((ElemType) 1.0 / sqrt(adaSqr));
+                if (w > 10.0f)
+                    w = 10.0f;
+                g *= w;
+            }
 
-        if (momentum > 0.0f)
-        {
-            g = momentum * smoothMom[i] + (1.0f - momentum) * g;
+            g = momentum * smoothMom[i] + oneMinusMomentum * g;
             smoothMom[i] = g;
+
+            val[i] -= g * learnRatePerSample;
         }
+    }
+    else
+    {
+#pragma omp parallel for
+        for (long i = 0; i < n; i++)
+        {
+            ElemType g = grad[i];
+            ElemType adaSqr = adaWeight * smoothAda[i] + oneMinusAdaWeight * g * g;
+            smoothAda[i] = adaSqr;
+            if (adaSqr != 0.0f)
+            {
+                ElemType w = adaMul * ((ElemType) 1.0 / sqrt(adaSqr));
+                if (w > 10.0f)
+                    w = 10.0f;
+                g *= w;
+            }
 
-        g *= learnRatePerSample;
-        val[i] -= g;
+            val[i] -= g * learnRatePerSample;
+        }
     }
 }
 
@@ -1276,7 +1291,7 @@ ElemType CPUMatrix<ElemType>::RmsProp(CPUMatrix<ElemType>& gradients,
 {
     const ElemType floor = 1e-6f;
 
-    size_t n = gradients.GetNumElements();
+    long n = (long) gradients.GetNumElements(); // note: OpenMP requires loop indices to be long, not size_t
     ElemType* curr_grad = gradients.Data();
 
     if (IsEmpty() || GetNumCols() < gradients.GetNumCols() * 3)
@@ -1287,13 +1302,13 @@ ElemType CPUMatrix<ElemType>::RmsProp(CPUMatrix<ElemType>& gradients,
         ElemType* avars = Data();         // accumulated variances for RMS scaling
         ElemType* steps = Data() + 2 * n; // current step size
 
-        // initialize moving average of gradient-squared
+        // initialize moving average of gradient-squared and starting step size
+#pragma omp parallel for
         for (long i = 0; i < n; i++)
+        {
             avars[i] = curr_grad[i] * curr_grad[i];
-
-        // initialize starting step size
-        for (long i = 0; i < n; i++)
             steps[i] = ElemType(0.02);
+        }
     }
 
     ElemType* avars = Data();         // accumulated variances for RMS scaling
@@ -1336,7 +1351,10 @@ ElemType CPUMatrix<ElemType>::RmsProp(CPUMatrix<ElemType>& gradients,
     //    curr_grad[i] *= steps[i] / sqrt(avars[i] + floor);
     //      }
 
-    ElemType aveMultiplier = 0, a;
+    // elements are independent; aveMultiplier is accumulated as an OpenMP reduction (only its summation order
+    // depends on the number of threads, the updated values do not)
+    ElemType aveMultiplier = 0;
+#pragma omp parallel for reduction(+ : aveMultiplier)
     for (long i = 0; i < n; i++)
     {
         avars[i] = RMS_GAMMA * avars[i] + ONE_MINUS_GAMMA * (curr_grad[i] * curr_grad[i]);
@@ -1347,12 +1365,11 @@ ElemType CPUMatrix<ElemType>::RmsProp(CPUMatrix<ElemType>& gradients,
         else
             steps[i] = std::max(steps[i] * RMS_WGT_DEC, RMS_WGT_MIN);
 
-        a = steps[i] / sqrt(avars[i] + floor);
+        ElemType a = steps[i] / sqrt(avars[i] + floor);
         curr_grad[i] *= a;
         signs[i] = (ElemType) grad_sign;
 
-        if (needAveMultiplier)
-            aveMultiplier += a;
+        aveMultiplier += a;
     }
 
     if (needAveMultiplier)
@@ -5048,6 +5065,74 @@ void CPUMatrix<ElemType>::AssignScaledDifference(const CPUMatrix<ElemType>& alph
 
     AssignScaledDifference(alpha(0, 0), a, b, c);
 }
+
+/// <summary>Column-wise softmax and cross entropy in one pass, without materializing the softmax:
+/// logSumExp(0,j) = log (sum_i exp (z(i,j))), crossEntropy(0,j) = -sum_i target(i,j) * (z(i,j) - logSumExp(0,j))</summary>
+/// <param name="target">Target distributions (e.g. one-hot labels)</param>
+/// <param name="z">Unnormalized log probabilities, same dimensions as target</param>
+/// <param name="logSumExp">Resulting row vector, needed by AddScaledSoftmaxDifference()</param>
+/// <param name="crossEntropy">Resulting row vector of per-column cross entropies</param>
+template <class ElemType>
+void CPUMatrix<ElemType>::SoftmaxCrossEntropy(const CPUMatrix<ElemType>& target, const CPUMatrix<ElemType>& z, CPUMatrix<ElemType>& logSumExp, CPUMatrix<ElemType>& crossEntropy)
+{
+    if (z.IsEmpty())
+        LogicError("SoftmaxCrossEntropy:  Input matrix z is empty.");
+    if (target.GetNumRows() != z.GetNumRows() || target.GetNumCols() != z.GetNumCols())
+        InvalidArgument("SoftmaxCrossEntropy:  target and z must have the same dimensions.");
+
+    logSumExp.RequireSize(1, z.GetNumCols());
+    crossEntropy.RequireSize(1, z.GetNumCols());
+
+#pragma omp parallel for
+    foreach_column (j, z)
+    {
+        // we need to extract max before applying exp to avoid overflow
+        ElemType maxV = z(0, j);
+        foreach_row (i, z)
+            maxV = std::max(maxV, z(i, j));
+
+        // z - logSumExp = (z - maxV) - log (sum), so the target terms can be accumulated in the same pass as the sum
+        ElemType sum = 0, targetSum = 0, targetDotShifted = 0;
+        foreach_row (i, z)
+        {
+            const ElemType shifted = z(i, j) - maxV;
+            sum += exp(shifted);
+            targetSum += target(i, j);
+            targetDotShifted += target(i, j) * shifted;
+        }
+        sum = log(sum);
+        logSumExp(0, j) = maxV + sum;
+        crossEntropy(0, j) = targetSum * sum - targetDotShifted;
+    }
+}
+
+/// <summary>c += alpha * (softmax(z) - target), where softmax(z) = exp (z - logSumExp) is computed on the fly</summary>
+/// <param name="alpha">1X1 matrix</param>
+/// <param name="z">Unnormalized log probabilities</param>
+/// <param name="logSumExp">Row vector as computed by SoftmaxCrossEntropy()</param>
+/// <param name="target">Target distributions, same dimensions as z</param>
+/// <param name="c">Resulting matrix, user is responsible for allocating this</param>
+template <class ElemType>
+void CPUMatrix<ElemType>::AddScaledSoftmaxDifference(const CPUMatrix<ElemType>& alpha, const CPUMatrix<ElemType>& z, const CPUMatrix<ElemType>& logSumExp, const CPUMatrix<ElemType>& target, CPUMatrix<ElemType>& c)
+{
+    if (!(alpha.GetNumElements() == 1))
+        InvalidArgument("AddScaledSoftmaxDifference:  alpha must be a 1X1 matrix.");
+    if (z.IsEmpty())
+        LogicError("AddScaledSoftmaxDifference:  Input matrix z is empty.");
+    if (target.GetNumRows() != z.GetNumRows() || target.GetNumCols() != z.GetNumCols() ||
+        c.GetNumRows() != z.GetNumRows() || c.GetNumCols() != z.GetNumCols() ||
+        logSumExp.GetNumRows() != 1 || logSumExp.GetNumCols() != z.GetNumCols())
+        InvalidArgument("AddScaledSoftmaxDifference:  Inconsistent matrix dimensions.");
+
+    const ElemType a = alpha(0, 0);
+#pragma omp parallel for
+    foreach_column (j, z)
+    {
+        const ElemType lse = logSumExp(0, j);
+        foreach_row (i, z)
+            c(i, j) += a * (exp(z(i, j) - lse) - target(i, j));
+    }
+}
 /// <summary>Matrix-scalar multiply with col-major matrices: c = alpha * a</summary>
 /// <param name="alpha">Scalar</param>
 /// <param name="a">Input matrix</param>
@@ -5915,6 +6000,202 @@ void CPUMatrix<ElemType>::_rcrfTransGrdCompute(size_t i,
         }
     }
 };
+
+// -----------------------------------------------------------------------
+// fused LSTM and GRU cells
+// Each function processes one time step for all columns (parallel sequences) at once. The matrix products of the
+// input (W x) and of the previous output (R h(t-1)) are computed by the caller with large GEMMs; these kernels do
+// everything else in a single pass over the gates.
+// LSTM gates are stacked as [i; f; g; o] (input, forget, cell candidate, output), with optional peephole weights
+// [H x 3] for i, f, o (pass an empty matrix to disable them). GRU gates are stacked as [r; u; n] (reset, update,
+// candidate), with r applied to the recurrent contribution of n (n = tanh (Wn x + bn + r .* (Rn h(t-1)))).
+// -----------------------------------------------------------------------
+
+// in:  gates = W x(t), recurrence = R h(t-1); out: gates = activated gate values [i; f; g; o], cell = c(t), output = h(t)
+template <class ElemType>
+void CPUMatrix<ElemType>::LSTMStepForward(CPUMatrix<ElemType>& gates, const CPUMatrix<ElemType>& recurrence, const CPUMatrix<ElemType>& bias,
+                                          const CPUMatrix<ElemType>& peepholes, const CPUMatrix<ElemType>& prevCell,
+                                          CPUMatrix<ElemType>& cell, CPUMatrix<ElemType>& output)
+{
+    const long H = (long) output.GetNumRows();
+    const long S = (long) output.GetNumCols();
+    if (gates.GetNumRows() != 4 * H || gates.GetNumCols() != S || recurrence.GetNumRows() != 4 * H || recurrence.GetNumCols() != S ||
+        bias.GetNumElements() != 4 * H || prevCell.GetNumRows() != H || prevCell.GetNumCols() != S || cell.GetNumRows() != H || cell.GetNumCols() != S ||
+        (!peepholes.IsEmpty() && peepholes.GetNumElements() != 3 * H))
+        InvalidArgument("LSTMStepForward: Inconsistent matrix dimensions.");
+
+    ElemType* z = gates.Data();
+    const ElemType* r = recurrence.Data();
+    const ElemType* b = bias.Data();
+    const ElemType* p = peepholes.IsEmpty() ? nullptr : peepholes.Data();
+    const ElemType* cp = prevCell.Data();
+    ElemType* c = cell.Data();
+    ElemType* h = output.Data();
+
+#pragma omp parallel for
+    for (long k = 0; k < H; k++)
+    {
+        const ElemType pi = p ? p[k] : 0, pf = p ? p[k + H] : 0, po = p ? p[k + 2 * H] : 0;
+        for (long j = 0; j < S; j++)
+        {
+            ElemType* zj = z + j * 4 * H;
+            const ElemType* rj = r + j * 4 * H;
+            const ElemType cPrev = cp[k + j * H];
+            const ElemType it = Sigmoid(zj[k]         + rj[k]         + b[k]         + pi * cPrev);
+            const ElemType ft = Sigmoid(zj[k + H]     + rj[k + H]     + b[k + H]     + pf * cPrev);
+            const ElemType gt = tanh_  (zj[k + 2 * H] + rj[k + 2 * H] + b[k + 2 * H]);
+            const ElemType ct = ft * cPrev + it * gt;
+            const ElemType ot = Sigmoid(zj[k + 3 * H] + rj[k + 3 * H] + b[k + 3 * H] + po * ct);
+            zj[k] = it;
+            zj[k + H] = ft;
+            zj[k + 2 * H] = gt;
+            zj[k + 3 * H] = ot;
+            c[k + j * H] = ct;
+            h[k + j * H] = ot * tanh_(ct);
+        }
+    }
+}
+
+// in:  gates = activated gate values, outputGradient = dh(t) (from above and from t+1), cellGradient = dc(t) from t+1
+// out: gates = gradients of the gate pre-activations, cellGradient = dc(t-1); peepholeGradient is accumulated into
+template <class ElemType>
+void CPUMatrix<ElemType>::LSTMStepBackward(CPUMatrix<ElemType>& gates, const CPUMatrix<ElemType>& peepholes,
+                                           const CPUMatrix<ElemType>& prevCell, const CPUMatrix<ElemType>& cell,
+                                           const CPUMatrix<ElemType>& outputGradient, CPUMatrix<ElemType>& cellGradient,
+                                           CPUMatrix<ElemType>& peepholeGradient)
+{
+    const long H = (long) cell.GetNumRows();
+    const long S = (long) cell.GetNumCols();
+    if (gates.GetNumRows() != 4 * H || gates.GetNumCols() != S || prevCell.GetNumRows() != H || prevCell.GetNumCols() != S ||
+        outputGradient.GetNumRows() != H || outputGradient.GetNumCols() != S || cellGradient.GetNumRows() != H || cellGradient.GetNumCols() != S ||
+        (!peepholes.IsEmpty() && (peepholes.GetNumElements() != 3 * H || peepholeGradient.GetNumElements() != 3 * H)))
+        InvalidArgument("LSTMStepBackward: Inconsistent matrix dimensions.");
+
+    ElemType* z = gates.Data();
+    const ElemType* p = peepholes.IsEmpty() ? nullptr : peepholes.Data();
+    ElemType* dp = peepholes.IsEmpty() ? nullptr : peepholeGradient.Data();
+    const ElemType* cp = prevCell.Data();
+    const ElemType* c = cell.Data();
+    const ElemType* dh = outputGradient.Data();
+    ElemType* dc = cellGradient.Data();
+
+#pragma omp parallel for
+    for (long k = 0; k < H; k++)
+    {
+        const ElemType pi = p ? p[k] : 0, pf = p ? p[k + H] : 0, po = p ? p[k + 2 * H] : 0;
+        ElemType dpi = 0, dpf = 0, dpo = 0;
+        for (long j = 0; j < S; j++)
+        {
+            ElemType* zj = z + j * 4 * H;
+            const ElemType it = zj[k], ft = zj[k + H], gt = zj[k + 2 * H], ot = zj[k + 3 * H];
+            const ElemType cPrev = cp[k + j * H];
+            const ElemType tct = tanh_(c[k + j * H]);
+            const ElemType dhj = dh[k + j * H];
+            const ElemType dzo = dhj * tct * ot * (1 - ot);
+            const ElemType dct = dc[k + j * H] + dhj * ot * (1 - tct * tct) + dzo * po;
+            const ElemType dzi = dct * gt * it * (1 - it);
+            const ElemType dzf = dct * cPrev * ft * (1 - ft);
+            const ElemType dzg = dct * it * (1 - gt * gt);
+            dc[k + j * H] = dct * ft + dzi * pi + dzf * pf;
+            dpi += dzi * cPrev;
+            dpf += dzf * cPrev;
+            dpo += dzo * c[k + j * H];
+            zj[k] = dzi;
+            zj[k + H] = dzf;
+            zj[k + 2 * H] = dzg;
+            zj[k + 3 * H] = dzo;
+        }
+        if (dp)
+        {
+            dp[k] += dpi;
+            dp[k + H] += dpf;
+            dp[k + 2 * H] += dpo;
+        }
+    }
+}
+
+// in:  gates = W x(t), recurrence = R h(t-1); out: gates = activated gate values [r; u; n], candidateRecurrence = Rn h(t-1) (needed for backprop), output = h(t)
+template <class ElemType>
+void CPUMatrix<ElemType>::GRUStepForward(CPUMatrix<ElemType>& gates, const CPUMatrix<ElemType>& recurrence, const CPUMatrix<ElemType>& bias,
+                                         const CPUMatrix<ElemType>& prevOutput, CPUMatrix<ElemType>& candidateRecurrence,
+                                         CPUMatrix<ElemType>& output)
+{
+    const long H = (long) output.GetNumRows();
+    const long S = (long) output.GetNumCols();
+    if (gates.GetNumRows() != 3 * H || gates.GetNumCols() != S || recurrence.GetNumRows() != 3 * H || recurrence.GetNumCols() != S ||
+        bias.GetNumElements() != 3 * H || prevOutput.GetNumRows() != H || prevOutput.GetNumCols() != S ||
+        candidateRecurrence.GetNumRows() != H || candidateRecurrence.GetNumCols() != S)
+        InvalidArgument("GRUStepForward: Inconsistent matrix dimensions.");
+
+    ElemType* z = gates.Data();
+    const ElemType* r = recurrence.Data();
+    const ElemType* b = bias.Data();
+    const ElemType* hp = prevOutput.Data();
+    ElemType* rn = candidateRecurrence.Data();
+    ElemType* h = output.Data();
+
+#pragma omp parallel for
+    for (long k = 0; k < H; k++)
+    {
+        for (long j = 0; j < S; j++)
+        {
+            ElemType* zj = z + j * 3 * H;
+            const ElemType* rj = r + j * 3 * H;
+            const ElemType rt = Sigmoid(zj[k]     + rj[k]     + b[k]);
+            const ElemType ut = Sigmoid(zj[k + H] + rj[k + H] + b[k + H]);
+            const ElemType nt = tanh_  (zj[k + 2 * H] + b[k + 2 * H] + rt * rj[k + 2 * H]);
+            zj[k] = rt;
+            zj[k + H] = ut;
+            zj[k + 2 * H] = nt;
+            rn[k + j * H] = rj[k + 2 * H];
+            h[k + j * H] = (1 - ut) * nt + ut * hp[k + j * H];
+        }
+    }
+}
+
+// in:  gates = activated gate values, outputGradient = dh(t) (from above and from t+1)
+// out: gates = gradients of the pre-activations w.r.t. W x(t) and the bias, recurrenceGradient = gradient w.r.t. R h(t-1),
+//      prevOutputGradient = direct (not through R) contribution to dh(t-1)
+template <class ElemType>
+void CPUMatrix<ElemType>::GRUStepBackward(CPUMatrix<ElemType>& gates, const CPUMatrix<ElemType>& candidateRecurrence,
+                                          const CPUMatrix<ElemType>& prevOutput, const CPUMatrix<ElemType>& outputGradient,
+                                          CPUMatrix<ElemType>& prevOutputGradient, CPUMatrix<ElemType>& recurrenceGradient)
+{
+    const long H = (long) prevOutput.GetNumRows();
+    const long S = (long) prevOutput.GetNumCols();
+    if (gates.GetNumRows() != 3 * H || gates.GetNumCols() != S || candidateRecurrence.GetNumRows() != H || candidateRecurrence.GetNumCols() != S ||
+        outputGradient.GetNumRows() != H || outputGradient.GetNumCols() != S || prevOutputGradient.GetNumRows() != H || prevOutputGradient.GetNumCols() != S ||
+        recurrenceGradient.GetNumRows() != 3 * H || recurrenceGradient.GetNumCols() != S)
+        InvalidArgument("GRUStepBackward: Inconsistent matrix dimensions.");
+
+    ElemType* z = gates.Data();
+    const ElemType* rn = candidateRecurrence.Data();
+    const ElemType* hp = prevOutput.Data();
+    const ElemType* dh = outputGradient.Data();
+    ElemType* dhp = prevOutputGradient.Data();
+    ElemType* dr = recurrenceGradient.Data();
+
+#pragma omp parallel for
+    for (long k = 0; k < H; k++)
+    {
+        for (long j = 0; j < S; j++)
+        {
+            ElemType* zj = z + j * 3 * H;
+            ElemType* drj = dr + j * 3 * H;
+            const ElemType rt = zj[k], ut = zj[k + H], nt = zj[k + 2 * H];
+            const ElemType dhj = dh[k + j * H];
+            const ElemType dzn = dhj * (1 - ut) * (1 - nt * nt);
+            const ElemType dzu = dhj * (hp[k + j * H] - nt) * ut * (1 - ut);
+            const ElemType dzr = dzn * rn[k + j * H] * rt * (1 - rt);
+            dhp[k + j * H] = dhj * ut;
+            zj[k] = drj[k] = dzr;
+            zj[k + H] = drj[k + H] = dzu;
+            zj[k + 2 * H] = dzn;
+            drj[k + 2 * H] = dzn * rt;
+        }
+    }
+}
+
 template <class ElemType>
 CPUMatrix<ElemType>& CPUMatrix<ElemType>::DropFrame(const CPUMatrix<ElemType>& label, const CPUMatrix<ElemType>& gamma, const ElemType& threshhold)
 {
@@ -394,6 +394,8 @@ public:
     static void AssignScaledDifference(const ElemType alpha, const CPUMatrix<ElemType>& a, const CPUMatrix<ElemType>& b, CPUMatrix<ElemType>& c);
     static void AddScaledDifference(const CPUMatrix<ElemType>& alpha, const CPUMatrix<ElemType>& a, const CPUMatrix<ElemType>& b, CPUMatrix<ElemType>& c);    // alpha must be 1X1
     static void AssignScaledDifference(const CPUMatrix<ElemType>& alpha, const CPUMatrix<ElemType>& a, const CPUMatrix<ElemType>& b, CPUMatrix<ElemType>& c); // alpha must be 1X1
+    static void SoftmaxCrossEntropy(const CPUMatrix<ElemType>& target, const CPUMatrix<ElemType>& z, CPUMatrix<ElemType>& logSumExp, CPUMatrix<ElemType>& crossEntropy);
+    static void AddScaledSoftmaxDifference(const CPUMatrix<ElemType>& alpha, const CPUMatrix<ElemType>& z, const CPUMatrix<ElemType>& logSumExp, const CPUMatrix<ElemType>& target, CPUMatrix<ElemType>& c); // alpha must be 1X1
 
     static void AddElementToElement(ElemType beta, const CPUMatrix<ElemType>& a, const size_t ai, const size_t aj, CPUMatrix<ElemType>& c, const size_t ci, const size_t cj);
 
@@ -452,13 +454,9 @@ public:
         size_t numRows, numCols;
         int format;
         stream >> matrixName >> format >> numRows >> numCols;
-        ElemType* d_array = new ElemType[numRows * numCols];
-        for (size_t i = 0; i < numRows * numCols; ++i)
-            stream >> d_array[i];
+        us.RequireSize(numRows, numCols);
+        stream.ReadArray(us.Data(), us.GetNumElements()); // read directly into the matrix, in a single call for binary files
         stream.GetMarker(fileMarkerEndSection, std::wstring(L"EMAT"));
-        us.SetValue(numRows, numCols, d_array, matrixFlagNormal);
-
-        delete[] d_array;
         return stream;
     }
     friend File& operator<<(File& stream, const CPUMatrix<ElemType>& us)
@@ -471,8 +469,7 @@ public:
         stream << s << format;
 
         stream << us.m_numRows << us.m_numCols;
-        for (size_t i = 0; i < us.GetNumElements(); ++i)
-            stream << us.Buffer()[i];
+        stream.WriteArray(us.Buffer(), us.GetNumElements());
         stream.PutMarker(fileMarkerEndSection, std::wstring(L"EMAT"));
         return stream;
     }
@@ -504,6 +501,21 @@ public:
                                      const size_t tPos // position
                                      );
 
+    // fused LSTM and GRU cells, one time step over all columns (parallel sequences); see FusedRNNNode
+    static void LSTMStepForward(CPUMatrix<ElemType>& gates, const CPUMatrix<ElemType>& recurrence, const CPUMatrix<ElemType>& bias,
+                                const CPUMatrix<ElemType>& peepholes, const CPUMatrix<ElemType>& prevCell,
+                                CPUMatrix<ElemType>& cell, CPUMatrix<ElemType>& output);
+    static void LSTMStepBackward(CPUMatrix<ElemType>& gates, const CPUMatrix<ElemType>& peepholes,
+                                 const CPUMatrix<ElemType>& prevCell, const CPUMatrix<ElemType>& cell,
+                                 const CPUMatrix<ElemType>& outputGradient, CPUMatrix<ElemType>& cellGradient,
+                                 CPUMatrix<ElemType>& peepholeGradient);
+    static void GRUStepForward(CPUMatrix<ElemType>& gates, const CPUMatrix<ElemType>& recurrence, const CPUMatrix<ElemType>& bias,
+                               const CPUMatrix<ElemType>& prevOutput, CPUMatrix<ElemType>& candidateRecurrence,
+                               CPUMatrix<ElemType>& output);
+    static void GRUStepBackward(CPUMatrix<ElemType>& gates, const CPUMatrix<ElemType>& candidateRecurrence,
+                                const CPUMatrix<ElemType>& prevOutput, const CPUMatrix<ElemType>& outputGradient,
+                                CPUMatrix<ElemType>& prevOutputGradient, CPUMatrix<ElemType>& recurrenceGradient);
+
 protected:
     size_t LocateElement(const size_t i, const size_t j) const;
     size_t LocateColumn(const size_t j) const;
@@ -267,7 +267,7 @@ void CPUSparseMatrix<ElemType>::SetValue(const CPUSparseMatrix<ElemType>& v)
     if (v.m_sliceViewOffset > 0)
     {
         CPUSPARSE_INDEX_TYPE* loc = (GetFormat() == matrixFormatSparseCSC) ? ColLocation() : RowLocation();
-        size_t len = (GetFormat() == matrixFormatSparseCSC) ? ColSize() : RowSize();
+        size_t len = SecondaryIndexCount(); // (a count of indices, not bytes)
         CPUSPARSE_INDEX_TYPE offset = loc[0];
         for (size_t c = 0; c < len; c++)
             loc[c] -= offset;
@@ -325,6 +325,49 @@ void CPUSparseMatrix<ElemType>::MaskColumnsValue(const CPUMatrix<char>& columnsM
 #endif
 }
 
+// Reinterpret the column-major element sequence as a [numRows x numCols] matrix, like CPUMatrix::Reshape().
+// Only the index arrays change; nonzeros keep their relative (column-major) order.
+template <class ElemType>
+void CPUSparseMatrix<ElemType>::Reshape(const size_t numRows, const size_t numCols)
+{
+    if (numRows == GetNumRows() && numCols == GetNumCols())
+        return;
+
+    VerifyWritable(__func__);
+
+    if (GetFormat() != MatrixFormat::matrixFormatSparseCSC)
+        NOT_IMPLEMENTED;
+
+    if (numRows * numCols != GetNumRows() * GetNumCols())
+        LogicError("Reshape: Total number of elements does not match.");
+
+    const size_t oldNumRows = GetNumRows();
+    const size_t oldNumCols = GetNumCols();
+    const size_t nz = NzCount();
+    const CPUSPARSE_INDEX_TYPE* oldColStart = SecondaryIndexLocation();
+    const CPUSPARSE_INDEX_TYPE* oldRow = MajorIndexLocation();
+    const ElemType* oldVal = Data();
+
+    // Nonzeros are already sorted by linear index j * oldNumRows + i, so the new column starts follow from a
+    // counting pass, and row indices and values are carried over in the same order.
+    std::vector<CPUSPARSE_INDEX_TYPE> newColStart(numCols + 1, 0);
+    std::vector<CPUSPARSE_INDEX_TYPE> newRow(nz);
+    std::vector<ElemType> newVal(oldVal, oldVal + nz);
+    for (size_t j = 0; j < oldNumCols; j++)
+    {
+        for (CPUSPARSE_INDEX_TYPE p = oldColStart[j]; p < oldColStart[j + 1]; p++)
+        {
+            const size_t k = p - oldColStart[0];
+            const size_t index = j * oldNumRows + oldRow[k];
+            newRow[k] = (CPUSPARSE_INDEX_TYPE) (index % numRows);
+            newColStart[index / numRows + 1]++;
+        }
+    }
+    for (size_t j = 0; j < numCols; j++)
+        newColStart[j + 1] += newColStart[j];
+
+    SetMatrixFromCSCFormat(newColStart.data(), newRow.data(), newVal.data(), nz, numRows, numCols);
+}
 
 template <class ElemType>
 void CPUSparseMatrix<ElemType>::Print(const char* matrixName) const
@@ -1305,18 +1348,9 @@ MATH_API File& operator>>(File& stream, CPUSparseMatrix<ElemType>& us)
         CPUSPARSE_INDEX_TYPE* compressedIndex = us.SecondaryIndexLocation();
 
         // read in the sparse matrix info
-        for (size_t i = 0; i < nz; ++i)
-        {
-            stream >> dataBuffer[i];
-        }
-        for (size_t i = 0; i < nz; ++i)
-        {
-            stream >> unCompressedIndex[i];
-        }
-        for (size_t i = 0; i < compressedSize; ++i)
-        {
-            stream >> compressedIndex[i];
-        }
+        stream.ReadArray(dataBuffer, nz);
+        stream.ReadArray(unCompressedIndex, nz);
+        stream.ReadArray(compressedIndex, compressedSize);
     }
     stream.GetMarker(fileMarkerEndSection, std::wstring(L"EMAT"));
 
@@ -1348,18 +1382,9 @@ MATH_API File& operator<<(File& stream, const CPUSparseMatrix<ElemType>& us)
         CPUSPARSE_INDEX_TYPE* unCompressedIndex = us.MajorIndexLocation();
         CPUSPARSE_INDEX_TYPE* compressedIndex = us.SecondaryIndexLocation();
 
-        for (size_t i = 0; i < nz; ++i)
-        {
-            stream << dataBuffer[i];
-        }
-        for (size_t i = 0; i < nz; ++i)
-        {
-            stream << unCompressedIndex[i];
-        }
-        for (size_t i = 0; i < compressedSize; ++i)
-        {
-            stream << compressedIndex[i];
-        }
+        stream.WriteArray(dataBuffer, nz);
+        stream.WriteArray(unCompressedIndex, nz);
+        stream.WriteArray(compressedIndex, compressedSize);
     }
     stream.PutMarker(fileMarkerEndSection, std::wstring(L"EMAT"));
 
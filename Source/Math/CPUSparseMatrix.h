@@ -106,6 +106,8 @@ public:
     CPUMatrix<ElemType> CopyColumnSliceToDense(size_t startColumn, size_t numCols) const;
     void AssignColumnSliceToDense(CPUMatrix<ElemType>& slice, size_t startColumn, size_t numCols) const;
 
+    void Reshape(const size_t numRows, const size_t numCols);
+
     CPUMatrix<ElemType> DiagonalToDense() const;
 
     void SetGaussianRandomValue(const ElemType /*mean*/, const ElemType /*sigma*/, unsigned long /*seed*/)
@@ -3559,6 +3559,49 @@ void GPUMatrix<ElemType>::AddScaledDifference(const GPUMatrix<ElemType>& alpha,
     }
 }
 
+/// <summary>Column-wise softmax and cross entropy in one pass, see CPUMatrix<ElemType>::SoftmaxCrossEntropy()</summary>
+template <class ElemType>
+void GPUMatrix<ElemType>::SoftmaxCrossEntropy(const GPUMatrix<ElemType>& target, const GPUMatrix<ElemType>& z, GPUMatrix<ElemType>& logSumExp, GPUMatrix<ElemType>& crossEntropy)
+{
+    if (z.IsEmpty())
+        LogicError("SoftmaxCrossEntropy: Input matrix z is empty.");
+    if (target.GetNumRows() != z.GetNumRows() || target.GetNumCols() != z.GetNumCols())
+        InvalidArgument("SoftmaxCrossEntropy: target and z must have the same dimensions.");
+    if (target.GetComputeDeviceId() != z.GetComputeDeviceId())
+        InvalidArgument("All matrices must be on the same GPU");
+
+    logSumExp.RequireSize(1, z.GetNumCols());
+    crossEntropy.RequireSize(1, z.GetNumCols());
+
+    z.PrepareDevice();
+    CUDA_LONG N = (CUDA_LONG) z.GetNumCols();
+    CUDA_LONG M = (CUDA_LONG) z.GetNumRows();
+    SyncGuard syncGuard;
+    _softmaxCrossEntropy<ElemType><<<N, 512, 0, t_stream>>>(target.Data(), z.Data(), logSumExp.Data(), crossEntropy.Data(), N, M);
+}
+
+/// <summary>c += alpha * (softmax(z) - target), see CPUMatrix<ElemType>::AddScaledSoftmaxDifference()</summary>
+template <class ElemType>
+void GPUMatrix<ElemType>::AddScaledSoftmaxDifference(const GPUMatrix<ElemType>& alpha, const GPUMatrix<ElemType>& z, const GPUMatrix<ElemType>& logSumExp, const GPUMatrix<ElemType>& target, GPUMatrix<ElemType>& c)
+{
+    if (!(alpha.GetNumElements() == 1))
+        InvalidArgument("AddScaledSoftmaxDifference: alpha must be a 1X1 matrix.");
+    if (z.IsEmpty())
+        LogicError("AddScaledSoftmaxDifference: Input matrix z is empty.");
+    if (target.GetNumRows() != z.GetNumRows() || target.GetNumCols() != z.GetNumCols() ||
+        c.GetNumRows() != z.GetNumRows() || c.GetNumCols() != z.GetNumCols() ||
+        logSumExp.GetNumRows() != 1 || logSumExp.GetNumCols() != z.GetNumCols())
+        InvalidArgument("AddScaledSoftmaxDifference: Inconsistent matrix dimensions.");
+    if (z.GetComputeDeviceId() != c.GetComputeDeviceId())
+        InvalidArgument("All matrices must be on the same GPU");
+
+    z.PrepareDevice();
+    CUDA_LONG n = (CUDA_LONG) z.GetNumElements();
+    int blocksPerGrid = (int) ceil(1.0 * n / GridDim::maxThreadsPerBlock);
+    SyncGuard syncGuard;
+    _addScaledSoftmaxDifference<ElemType><<<blocksPerGrid, GridDim::maxThreadsPerBlock, 0, t_stream>>>(alpha.Data(), z.Data(), logSumExp.Data(), target.Data(), c.Data(), n, (CUDA_LONG) z.GetNumRows());
+}
+
 /// <summary> c = alpha * (a-b)</summary>
 /// if a, b, c  must have same dim
 /// <param name="alpha">Scalar</param>
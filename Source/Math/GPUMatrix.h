@@ -469,6 +469,8 @@ public:
     static void AssignScaledDifference(const ElemType alpha, const GPUMatrix<ElemType>& a, const GPUMatrix<ElemType>& b, GPUMatrix<ElemType>& c);
     static void AddScaledDifference(const GPUMatrix<ElemType>& alpha, const GPUMatrix<ElemType>& a, const GPUMatrix<ElemType>& b, GPUMatrix<ElemType>& c);
     static void AssignScaledDifference(const GPUMatrix<ElemType>& alpha, const GPUMatrix<ElemType>& a, const GPUMatrix<ElemType>& b, GPUMatrix<ElemType>& c);
+    static void SoftmaxCrossEntropy(const GPUMatrix<ElemType>& target, const GPUMatrix<ElemType>& z, GPUMatrix<ElemType>& logSumExp, GPUMatrix<ElemType>& crossEntropy);
+    static void AddScaledSoftmaxDifference(const GPUMatrix<ElemType>& alpha, const GPUMatrix<ElemType>& z, const GPUMatrix<ElemType>& logSumExp, const GPUMatrix<ElemType>& target, GPUMatrix<ElemType>& c);
 
     static void AddElementToElement(ElemType beta, const GPUMatrix<ElemType>& a, const size_t ai, const size_t aj, GPUMatrix<ElemType>& c, const size_t ci, const size_t cj);
 
@@ -547,8 +549,7 @@ public:
         int format;
         stream >> matrixNameDummy >> format >> numRows >> numCols;
         ElemType* d_array = new ElemType[numRows * numCols];
-        for (size_t i = 0; i < numRows * numCols; ++i)
-            stream >> d_array[i];
+        stream.ReadArray(d_array, numRows * numCols);
         stream.GetMarker(fileMarkerEndSection, std::wstring(L"EMAT"));
         us.SetValue(numRows, numCols, us.GetComputeDeviceId(), d_array, matrixFlagNormal | format);
         delete[] d_array;
@@ -566,9 +567,7 @@ public:
 
         stream << us.m_numRows << us.m_numCols;
         ElemType* pArray = us.CopyToArray();
-        for (size_t i = 0; i < us.GetNumElements(); ++i)
-            stream << pArray[i];
-        
+        stream.WriteArray(pArray, us.GetNumElements());
         delete[] pArray;
 
         stream.PutMarker(fileMarkerEndSection, std::wstring(L"EMAT"));
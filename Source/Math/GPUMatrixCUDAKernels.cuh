@@ -980,6 +980,88 @@ __global__ void _assignColumnwiseLogSoftmaxOf(
     }
 }
 
+// fused column-wise softmax and cross entropy, see CPUMatrix<ElemType>::SoftmaxCrossEntropy()
+// one block of 512 threads per column
+template <class ElemType>
+__global__ void _softmaxCrossEntropy(
+    const ElemType* target,
+    const ElemType* z,
+    ElemType* logSumExp,
+    ElemType* crossEntropy,
+    const CUDA_LONG m_numCols,
+    const CUDA_LONG m_numRows)
+{
+    __shared__ ElemType partials[512];
+    __shared__ ElemType partialTargetSums[512];
+    __shared__ ElemType partialTargetDots[512];
+    const ElemType* zj = z + IDX2C(0, blockIdx.x, m_numRows);
+    const ElemType* tj = target + IDX2C(0, blockIdx.x, m_numRows);
+
+    // max per column
+    ElemType maxV = zj[0];
+    for (int i = threadIdx.x; i < m_numRows; i += 512)
+        maxV = max(maxV, zj[i]);
+    partials[threadIdx.x] = maxV;
+    __syncthreads();
+    for (int s = 256; s > 0; s >>= 1)
+    {
+        if (threadIdx.x < s)
+            partials[threadIdx.x] = max(partials[threadIdx.x], partials[threadIdx.x + s]);
+        __syncthreads();
+    }
+    maxV = partials[0];
+    __syncthreads();
+
+    // sums of exp (z - max), of the target, and of target .* (z - max)
+    ElemType sum = 0, targetSum = 0, targetDot = 0;
+    for (int i = threadIdx.x; i < m_numRows; i += 512)
+    {
+        ElemType shifted = zj[i] - maxV;
+        sum += (sizeof(ElemType) == sizeof(float)) ? expf(shifted) : exp(shifted);
+        targetSum += tj[i];
+        targetDot += tj[i] * shifted;
+    }
+    partials[threadIdx.x] = sum;
+    partialTargetSums[threadIdx.x] = targetSum;
+    partialTargetDots[threadIdx.x] = targetDot;
+    __syncthreads();
+    for (int s = 256; s > 0; s >>= 1)
+    {
+        if (threadIdx.x < s)
+        {
+            partials[threadIdx.x] += partials[threadIdx.x + s];
+            partialTargetSums[threadIdx.x] += partialTargetSums[threadIdx.x + s];
+            partialTargetDots[threadIdx.x] += partialTargetDots[threadIdx.x + s];
+        }
+        __syncthreads();
+    }
+
+    if (threadIdx.x == 0)
+    {
+        ElemType logSum = (sizeof(ElemType) == sizeof(float)) ? logf(partials[0]) : log(partials[0]);
+        logSumExp[blockIdx.x] = maxV + logSum;
+        crossEntropy[blockIdx.x] = partialTargetSums[0] * logSum - partialTargetDots[0];
+    }
+}
+
+// c += alpha * (exp (z - logSumExp) - target), see CPUMatrix<ElemType>::AddScaledSoftmaxDifference()
+template <class ElemType>
+__global__ void _addScaledSoftmaxDifference(
+    const ElemType* alpha,
+    const ElemType* z,
+    const ElemType* logSumExp,
+    const ElemType* target,
+    ElemType* c,
+    const CUDA_LONG N,
+    const CUDA_LONG m_numRows)
+{
+    CUDA_LONG id = blockDim.x * blockIdx.x + threadIdx.x;
+    if (id >= N)
+        return;
+    ElemType shifted = z[id] - logSumExp[id / m_numRows];
+    c[id] += alpha[0] * (((sizeof(ElemType) == sizeof(float)) ? expf(shifted) : exp(shifted)) - target[id]);
+}
+
 template <class ElemType>
 __global__ void _logSoftMaxRowWise(
     ElemType* a,
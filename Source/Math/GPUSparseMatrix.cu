@@ -2718,23 +2718,16 @@ MATH_API File& operator>>(File& stream, GPUSparseMatrix<ElemType>& us)
         CPUSPARSE_INDEX_TYPE* unCompressedIndex = new CPUSPARSE_INDEX_TYPE[nz];
         CPUSPARSE_INDEX_TYPE* compressedIndex = new CPUSPARSE_INDEX_TYPE[compressedSize];
 
-        // read in the sparse matrix info
+        // read in the sparse matrix info; indices are stored as size_t
+        stream.ReadArray(dataBuffer, nz);
+        std::vector<size_t> vals(nz);
+        stream.ReadArray(vals.data(), vals.size());
         for (size_t i = 0; i < nz; ++i)
-        {
-            stream >> dataBuffer[i];
-        }
-        for (size_t i = 0; i < nz; ++i)
-        {
-            size_t val;
-            stream >> val;
-            unCompressedIndex[i] = val;
-        }
+            unCompressedIndex[i] = (CPUSPARSE_INDEX_TYPE) vals[i];
+        vals.resize(compressedSize);
+        stream.ReadArray(vals.data(), vals.size());
         for (size_t i = 0; i < compressedSize; ++i)
-        {
-            size_t val;
-            stream >> val;
-            compressedIndex[i] = val;
-        }
+            compressedIndex[i] = (CPUSPARSE_INDEX_TYPE) vals[i];
 
         if (us.GetFormat() == matrixFormatSparseCSC)
             us.SetMatrixFromCSCFormat(compressedIndex, unCompressedIndex, dataBuffer, nz, rownum, colnum);
@@ -2784,20 +2777,11 @@ MATH_API File& operator<<(File& stream, const GPUSparseMatrix<ElemType>& us)
         else
             NOT_IMPLEMENTED;
 
-        for (size_t i = 0; i < nz; ++i)
-        {
-            stream << dataBuffer[i];
-        }
-        for (size_t i = 0; i < nz; ++i)
-        {
-            size_t val = unCompressedIndex[i];
-            stream << val;
-        }
-        for (size_t i = 0; i < compressedSize; ++i)
-        {
-            size_t val = compressedIndex[i];
-            stream << val;
-        }
+        stream.WriteArray(dataBuffer, nz);
+        std::vector<size_t> vals(unCompressedIndex, unCompressedIndex + nz); // indices are stored as size_t
+        stream.WriteArray(vals.data(), vals.size());
+        vals.assign(compressedIndex, compressedIndex + compressedSize);
+        stream.WriteArray(vals.data(), vals.size());
 
         delete[] dataBuffer;
         delete[] unCompressedIndex;
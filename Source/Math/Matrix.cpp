@@ -627,6 +627,33 @@ void Matrix<ElemType>::Read(File& stream)
             M.SetDataLocation(GPU, SPARSE);
         }
     }
+    else if (type == 'a') // dense, with the elements stored as an aligned array (see File::PutAlignedArray())
+    {
+        stream.GetMarker(fileMarkerBeginSection, std::wstring(L"BMAT"));
+        size_t elsize, numRows, numCols;
+        stream >> elsize >> numRows >> numCols;
+        if (sizeof(ElemType) != elsize)
+            RuntimeError("Read: Template argument size doesn't match those in file");
+        size_t numBytes = numRows * numCols * sizeof(ElemType);
+        if (M.GetDeviceId() < 0 && !M.m_CPUMatrix)
+            M.m_CPUMatrix = make_shared<CPUMatrix<ElemType>>();
+        else if (M.GetDeviceId() >= 0 && !M.m_GPUMatrix)
+            M.m_GPUMatrix = make_shared<GPUMatrix<ElemType>>(M.GetDeviceId());
+        M.SetDataLocation(M.GetDeviceId() < 0 ? CPU : GPU, DENSE);
+
+        // If the file is mapped, a CPU matrix uses the elements in place (the mapping is copy-on-write), while
+        // a GPU matrix is copied straight from the mapping. Otherwise the array is read with a single read.
+        ElemType* mapped = (ElemType*) stream.MapAlignedArray(numBytes);
+        if (mapped)
+            M.SetValue(numRows, numCols, M.GetDeviceId(), mapped, M.GetDeviceId() < 0 ? matrixFlagDontOwnBuffer : matrixFlagNormal);
+        else
+        {
+            std::vector<ElemType> buffer(numRows * numCols);
+            stream.GetAlignedArray(buffer.data(), numBytes);
+            M.SetValue(numRows, numCols, M.GetDeviceId(), buffer.data(), matrixFlagNormal);
+        }
+        stream.GetMarker(fileMarkerEndSection, std::wstring(L"EMAT"));
+    }
     else
         LogicError("Read: Input file corrupt (invalid matrix type field 0x%02d, should be 'f' or 'd').", type);
 }
@@ -635,7 +662,21 @@ template <class ElemType>
 void Matrix<ElemType>::Write(File& stream) const
 {
     const Matrix<ElemType>& M = *this;
-    if (M.GetMatrixType() == MatrixType::DENSE)
+    if (M.GetMatrixType() == MatrixType::DENSE && stream.IsMappable() && M.GetNumElements() * sizeof(ElemType) >= File::s_minAlignedArraySize)
+    {
+        stream << 'a';
+        stream.PutMarker(fileMarkerBeginSection, std::wstring(L"BMAT"));
+        stream << sizeof(ElemType) << M.GetNumRows() << M.GetNumCols();
+        if (M.GetDeviceId() < 0)
+            stream.PutAlignedArray(M.m_CPUMatrix->Data(), M.GetNumElements() * sizeof(ElemType));
+        else
+        {
+            std::unique_ptr<ElemType[]> buffer(M.m_GPUMatrix->CopyToArray());
+            stream.PutAlignedArray(buffer.get(), M.GetNumElements() * sizeof(ElemType));
+        }
+        stream.PutMarker(fileMarkerEndSection, std::wstring(L"EMAT"));
+    }
+    else if (M.GetMatrixType() == MatrixType::DENSE)
     {
         stream << 'd';
         if (M.GetDeviceId() < 0)
@@ -1555,7 +1596,7 @@ void Matrix<ElemType>::Reshape(const size_t numRows, const size_t numCols)
         DISPATCH_MATRIX_ON_FLAG(this, this,
             { m_CPUMatrix->Reshape(numRows, numCols); },
             { m_GPUMatrix->Reshape(numRows, numCols); },
-            { NOT_IMPLEMENTED; },
+            { m_CPUSparseMatrix->Reshape(numRows, numCols); },
             { m_GPUSparseMatrix->Reshape(numRows, numCols); });
     }
 }
@@ -4698,6 +4739,54 @@ void Matrix<ElemType>::AssignScaledDifference(const Matrix<ElemType>& alpha, con
                             NOT_IMPLEMENTED);
 }
 
+/// <summary>Column-wise softmax and cross entropy in one pass, without materializing the softmax:
+/// logSumExp(0,j) = log (sum_i exp (z(i,j))), crossEntropy(0,j) = -sum_i target(i,j) * (z(i,j) - logSumExp(0,j))</summary>
+/// <param name="target">Target distributions, dense, same dimensions as z</param>
+/// <param name="z">Unnormalized log probabilities</param>
+/// <param name="logSumExp">Resulting row vector, to be passed to AddScaledSoftmaxDifference()</param>
+/// <param name="crossEntropy">Resulting row vector of per-column cross entropies</param>
+template <class ElemType>
+void Matrix<ElemType>::SoftmaxCrossEntropy(const Matrix<ElemType>& target, const Matrix<ElemType>& z, Matrix<ElemType>& logSumExp, Matrix<ElemType>& crossEntropy)
+{
+    DecideAndMoveToRightDevice(z, target, logSumExp, crossEntropy);
+
+    if (!(z.GetMatrixType() == DENSE && target.GetMatrixType() == DENSE))
+        NOT_IMPLEMENTED;
+
+    logSumExp.SwitchToMatrixType(DENSE, matrixFormatDense, false);
+    crossEntropy.SwitchToMatrixType(DENSE, matrixFormatDense, false);
+
+    DISPATCH_MATRIX_ON_FLAG(&z,
+                            nullptr,
+                            CPUMatrix<ElemType>::SoftmaxCrossEntropy(*target.m_CPUMatrix, *z.m_CPUMatrix, *logSumExp.m_CPUMatrix, *crossEntropy.m_CPUMatrix),
+                            GPUMatrix<ElemType>::SoftmaxCrossEntropy(*target.m_GPUMatrix, *z.m_GPUMatrix, *logSumExp.m_GPUMatrix, *crossEntropy.m_GPUMatrix),
+                            NOT_IMPLEMENTED,
+                            NOT_IMPLEMENTED);
+}
+
+/// <summary>c += alpha * (softmax(z) - target), where softmax(z) = exp (z - logSumExp) is computed on the fly</summary>
+/// <param name="alpha">1X1 matrix</param>
+/// <param name="z">Unnormalized log probabilities</param>
+/// <param name="logSumExp">Row vector as computed by SoftmaxCrossEntropy()</param>
+/// <param name="target">Target distributions, dense, same dimensions as z</param>
+/// <param name="c">Resulting matrix, user is responsible for allocating this</param>
+template <class ElemType>
+void Matrix<ElemType>::AddScaledSoftmaxDifference(const Matrix<ElemType>& alpha, const Matrix<ElemType>& z, const Matrix<ElemType>& logSumExp, const Matrix<ElemType>& target, Matrix<ElemType>& c)
+{
+    DecideAndMoveToRightDevice(c, z, logSumExp, target);
+    alpha._transferToDevice(c.GetDeviceId());
+
+    if (!(z.GetMatrixType() == DENSE && target.GetMatrixType() == DENSE && c.GetMatrixType() == DENSE && alpha.GetMatrixType() == DENSE))
+        NOT_IMPLEMENTED;
+
+    DISPATCH_MATRIX_ON_FLAG(&c,
+                            &c,
+                            CPUMatrix<ElemType>::AddScaledSoftmaxDifference(*alpha.m_CPUMatrix, *z.m_CPUMatrix, *logSumExp.m_CPUMatrix, *target.m_CPUMatrix, *c.m_CPUMatrix),
+                            GPUMatrix<ElemType>::AddScaledSoftmaxDifference(*alpha.m_GPUMatrix, *z.m_GPUMatrix, *logSumExp.m_GPUMatrix, *target.m_GPUMatrix, *c.m_GPUMatrix),
+                            NOT_IMPLEMENTED,
+                            NOT_IMPLEMENTED);
+}
+
 //c[ci,cj] += a[ai,aj]
 template <class ElemType>
 void Matrix<ElemType>::AddElementToElement(const Matrix<ElemType>& a, const size_t ai, const size_t aj, Matrix<ElemType>& c, const size_t ci, const size_t cj)
@@ -5260,6 +5349,74 @@ void Matrix<ElemType>::RCRFTransGrdCompute(const Matrix<ElemType>& lbls,
                             NOT_IMPLEMENTED);
 }
 
+// -----------------------------------------------------------------------
+// fused LSTM and GRU cells, see CPUMatrix.cpp
+// These operate in place on (column slices of) matrices that must all live on the CPU.
+// -----------------------------------------------------------------------
+
+template <class ElemType>
+void Matrix<ElemType>::LSTMStepForward(Matrix<ElemType>& gates, const Matrix<ElemType>& recurrence, const Matrix<ElemType>& bias,
+                                       const Matrix<ElemType>& peepholes, const Matrix<ElemType>& prevCell,
+                                       Matrix<ElemType>& cell, Matrix<ElemType>& output)
+{
+    CPUMatrix<ElemType> noPeepholes;
+    DISPATCH_MATRIX_ON_FLAG(&gates,
+                            &gates,
+                            CPUMatrix<ElemType>::LSTMStepForward(*gates.m_CPUMatrix, *recurrence.m_CPUMatrix, *bias.m_CPUMatrix,
+                                                                 peepholes.IsEmpty() ? noPeepholes : *peepholes.m_CPUMatrix,
+                                                                 *prevCell.m_CPUMatrix, *cell.m_CPUMatrix, *output.m_CPUMatrix),
+                            NOT_IMPLEMENTED,
+                            NOT_IMPLEMENTED,
+                            NOT_IMPLEMENTED);
+}
+
+template <class ElemType>
+void Matrix<ElemType>::LSTMStepBackward(Matrix<ElemType>& gates, const Matrix<ElemType>& peepholes,
+                                        const Matrix<ElemType>& prevCell, const Matrix<ElemType>& cell,
+                                        const Matrix<ElemType>& outputGradient, Matrix<ElemType>& cellGradient,
+                                        Matrix<ElemType>& peepholeGradient)
+{
+    CPUMatrix<ElemType> noPeepholes;
+    DISPATCH_MATRIX_ON_FLAG(&gates,
+                            &gates,
+                            CPUMatrix<ElemType>::LSTMStepBackward(*gates.m_CPUMatrix,
+                                                                  peepholes.IsEmpty() ? noPeepholes : *peepholes.m_CPUMatrix,
+                                                                  *prevCell.m_CPUMatrix, *cell.m_CPUMatrix, *outputGradient.m_CPUMatrix, *cellGradient.m_CPUMatrix,
+                                                                  peepholes.IsEmpty() ? noPeepholes : *peepholeGradient.m_CPUMatrix),
+                            NOT_IMPLEMENTED,
+                            NOT_IMPLEMENTED,
+                            NOT_IMPLEMENTED);
+}
+
+template <class ElemType>
+void Matrix<ElemType>::GRUStepForward(Matrix<ElemType>& gates, const Matrix<ElemType>& recurrence, const Matrix<ElemType>& bias,
+                                      const Matrix<ElemType>& prevOutput, Matrix<ElemType>& candidateRecurrence,
+                                      Matrix<ElemType>& output)
+{
+    DISPATCH_MATRIX_ON_FLAG(&gates,
+                            &gates,
+                            CPUMatrix<ElemType>::GRUStepForward(*gates.m_CPUMatrix, *recurrence.m_CPUMatrix, *bias.m_CPUMatrix,
+                                                                *prevOutput.m_CPUMatrix, *candidateRecurrence.m_CPUMatrix, *output.m_CPUMatrix),
+                            NOT_IMPLEMENTED,
+                            NOT_IMPLEMENTED,
+                            NOT_IMPLEMENTED);
+}
+
+template <class ElemType>
+void Matrix<ElemType>::GRUStepBackward(Matrix<ElemType>& gates, const Matrix<ElemType>& candidateRecurrence,
+                                       const Matrix<ElemType>& prevOutput, const Matrix<ElemType>& outputGradient,
+                                       Matrix<ElemType>& prevOutputGradient, Matrix<ElemType>& recurrenceGradient)
+{
+    DISPATCH_MATRIX_ON_FLAG(&gates,
+                            &gates,
+                            CPUMatrix<ElemType>::GRUStepBackward(*gates.m_CPUMatrix, *candidateRecurrence.m_CPUMatrix,
+                                                                 *prevOutput.m_CPUMatrix, *outputGradient.m_CPUMatrix,
+                                                                 *prevOutputGradient.m_CPUMatrix, *recurrenceGradient.m_CPUMatrix),
+                            NOT_IMPLEMENTED,
+                            NOT_IMPLEMENTED,
+                            NOT_IMPLEMENTED);
+}
+
 template <class ElemType>
 Matrix<ElemType>& Matrix<ElemType>::DropFrame(const Matrix<ElemType>& label, const Matrix<ElemType>& gamma, const ElemType& threshhold)
 {
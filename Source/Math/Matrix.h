@@ -530,6 +530,9 @@ public:
     static void AssignScaledDifference(const ElemType alpha, const Matrix<ElemType>& a, const Matrix<ElemType>& b, Matrix<ElemType>& c);
     static void AddScaledDifference(const Matrix<ElemType>& alpha, const Matrix<ElemType>& a, const Matrix<ElemType>& b, Matrix<ElemType>& c); // c += alpha * (a - b)
     static void AssignScaledDifference(const Matrix<ElemType>& alpha, const Matrix<ElemType>& a, const Matrix<ElemType>& b, Matrix<ElemType>& c);
+    // fused column-wise softmax and cross entropy (the softmax itself is never materialized)
+    static void SoftmaxCrossEntropy(const Matrix<ElemType>& target, const Matrix<ElemType>& z, Matrix<ElemType>& logSumExp, Matrix<ElemType>& crossEntropy);
+    static void AddScaledSoftmaxDifference(const Matrix<ElemType>& alpha, const Matrix<ElemType>& z, const Matrix<ElemType>& logSumExp, const Matrix<ElemType>& target, Matrix<ElemType>& c); // c += alpha * (softmax(z) - target)
 
     static void AddElementToElement(const Matrix<ElemType>& a, const size_t ai, const size_t aj, Matrix<ElemType>& c, const size_t ci, const size_t cj);
     // static void AddLogElementToElement(const Matrix<ElemType>& a, const size_t ai, const size_t aj, Matrix<ElemType>& c, const size_t ci, const size_t cj);
@@ -587,6 +590,21 @@ public:
                                     const int startLbl, // the time 0 start symbol in the output layer
                                     const int shift);
 
+    // fused LSTM and GRU cells (one time step); CPU only
+    static void LSTMStepForward(Matrix<ElemType>& gates, const Matrix<ElemType>& recurrence, const Matrix<ElemType>& bias,
+                                const Matrix<ElemType>& peepholes, const Matrix<ElemType>& prevCell,
+                                Matrix<ElemType>& cell, Matrix<ElemType>& output);
+    static void LSTMStepBackward(Matrix<ElemType>& gates, const Matrix<ElemType>& peepholes,
+                                 const Matrix<ElemType>& prevCell, const Matrix<ElemType>& cell,
+                                 const Matrix<ElemType>& outputGradient, Matrix<ElemType>& cellGradient,
+                                 Matrix<ElemType>& peepholeGradient);
+    static void GRUStepForward(Matrix<ElemType>& gates, const Matrix<ElemType>& recurrence, const Matrix<ElemType>& bias,
+                               const Matrix<ElemType>& prevOutput, Matrix<ElemType>& candidateRecurrence,
+                               Matrix<ElemType>& output);
+    static void GRUStepBackward(Matrix<ElemType>& gates, const Matrix<ElemType>& candidateRecurrence,
+                                const Matrix<ElemType>& prevOutput, const Matrix<ElemType>& outputGradient,
+                                Matrix<ElemType>& prevOutputGradient, Matrix<ElemType>& recurrenceGradient);
+
     template <typename T>
     friend class MatrixQuantizer;
 
@@ -1919,6 +1919,16 @@ void GPUMatrix<ElemType>::AddScaledDifference(const GPUMatrix<ElemType>& /*alpha
 {
 }
 
+template <class ElemType>
+void GPUMatrix<ElemType>::SoftmaxCrossEntropy(const GPUMatrix<ElemType>& /*target*/, const GPUMatrix<ElemType>& /*z*/, GPUMatrix<ElemType>& /*logSumExp*/, GPUMatrix<ElemType>& /*crossEntropy*/)
+{
+}
+
+template <class ElemType>
+void GPUMatrix<ElemType>::AddScaledSoftmaxDifference(const GPUMatrix<ElemType>& /*alpha*/, const GPUMatrix<ElemType>& /*z*/, const GPUMatrix<ElemType>& /*logSumExp*/, const GPUMatrix<ElemType>& /*target*/, GPUMatrix<ElemType>& /*c*/)
+{
+}
+
 /// <summary> c = alpha * (a-b)</summary>
 /// if a, b, c  must have same dim
 /// <param name="alpha">Scalar</param>
@@ -7,6 +7,8 @@
 
 #define __STDC_FORMAT_MACROS
 #include <inttypes.h>
+#include <atomic>
+#include <exception>
 #include "DataDeserializer.h"
 #include "../HTKMLFReader/htkfeatio.h"
 #include "UtteranceDescription.h"
@@ -112,7 +114,9 @@ public:
     // Pages-in the data for this chunk.
     // this function supports retrying since we read from the unreliable network, i.e. do not return in a broken state
     // We pass in the feature info variables to check that that data being read has expected properties.
-    void RequireData(const string& featureKind, size_t featureDimension, unsigned int samplePeriod, int verbosity = 0) const
+    // Utterances stored back to back in the same archive are read with a single read, and up to 'ioThreads'
+    // of these runs are read in parallel, which hides the per-file latency of network storage.
+    void RequireData(const string& featureKind, size_t featureDimension, unsigned int samplePeriod, int verbosity = 0, size_t ioThreads = 1) const
     {
         if (GetNumberOfUtterances() == 0)
         {
@@ -126,24 +130,60 @@ public:
 
         try
         {
-            // feature reader (we reinstantiate it for each block, i.e. we reopen the file actually)
-            // if this is the first feature read ever, we explicitly open the first file to get the information such as feature dimension
-            msra::asr::htkfeatreader reader;
-
-            // read all utterances; if they are in the same archive, htkfeatreader will be efficient in not closing the file
             m_frames.resize(featureDimension, m_totalFrames);
-            foreach_index(i, m_utterances)
+
+            // group the utterances into runs of adjacent archive entries; run r is [runBegin[r], runBegin[r + 1])
+            std::vector<size_t> runBegin;
+            for (size_t i = 0; i < m_utterances.size(); i++)
+            {
+                if (i == 0 || !m_utterances[i - 1].GetPath().isfollowedby(m_utterances[i].GetPath()))
+                    runBegin.push_back(i);
+            }
+            runBegin.push_back(m_utterances.size());
+            const int numRuns = (int)runBegin.size() - 1;
+
+            // Exceptions must not escape the parallel region; the first one is rethrown afterwards, retrying is up to the caller.
+            std::exception_ptr error;
+            std::atomic<bool> failed(false);
+#pragma omp parallel num_threads((int)std::max<size_t>(1, std::min<size_t>(ioThreads, numRuns)))
             {
-                // read features for this file
-                auto framesWrapper = GetUtteranceFrames(i);
-                reader.read(m_utterances[i].GetPath(), featureKind, samplePeriod, framesWrapper);
+                // feature reader per thread; if consecutive runs are in the same archive, htkfeatreader will be efficient in not closing the file
+                msra::asr::htkfeatreader reader;
+#pragma omp for schedule(dynamic)
+                for (int r = 0; r < numRuns; r++)
+                {
+                    if (failed)
+                        continue;
+                    try
+                    {
+                        const size_t first = runBegin[r], last = runBegin[r + 1] - 1;
+                        const size_t numFrames = m_firstFrames[last] + m_utterances[last].GetNumberOfFrames() - m_firstFrames[first];
+                        msra::dbn::matrixstripe frames(m_frames, m_firstFrames[first], numFrames);
+                        if (first == last)
+                            reader.read(m_utterances[first].GetPath(), featureKind, samplePeriod, frames);
+                        else
+                            reader.read(m_utterances[first].GetPath(), m_utterances[last].GetPath(), featureKind, samplePeriod, frames);
+                    }
+                    catch (...)
+                    {
+#pragma omp critical
+                        if (!failed)
+                        {
+                            error = std::current_exception();
+                            failed = true;
+                        }
+                    }
+                }
             }
+            if (failed)
+                std::rethrow_exception(error);
 
             if (verbosity)
             {
-                fprintf(stderr, "HTKChunkDescription::RequireData: read physical chunk %u (%" PRIu64 " utterances, %" PRIu64 " frames, %" PRIu64 " bytes)\n",
+                fprintf(stderr, "HTKChunkDescription::RequireData: read physical chunk %u (%" PRIu64 " utterances in %d reads, %" PRIu64 " frames, %" PRIu64 " bytes)\n",
                         m_chunkId,
                         m_utterances.size(),
+                        numRuns,
                         m_totalFrames,
                         sizeof(float) * m_frames.rows() * m_frames.cols());
             }
@@ -36,6 +36,7 @@ HTKDataDeserializer::HTKDataDeserializer(
     m_frameMode = (ConfigValue)cfg("frameMode", "true");
 
     m_verbosity = cfg(L"verbosity", 0);
+    m_ioThreads = cfg(L"ioThreads", (size_t)4);
 
     argvector<ConfigValue> inputs = cfg("input");
     if (inputs.size() != 1)
@@ -78,6 +79,7 @@ HTKDataDeserializer::HTKDataDeserializer(
     config.CheckFeatureType();
 
     m_verbosity = feature(L"verbosity", 0);
+    m_ioThreads = feature(L"ioThreads", (size_t)4);
 
     auto context = config.GetContextWindow();
     m_elementType = config.GetElementType();
@@ -319,7 +321,7 @@ public:
         // making several attempts
         msra::util::attempt(5, [&]()
         {
-            chunkDescription.RequireData(m_parent->m_featureKind, m_parent->m_ioFeatureDimension, m_parent->m_samplePeriod, m_parent->m_verbosity);
+            chunkDescription.RequireData(m_parent->m_featureKind, m_parent->m_ioFeatureDimension, m_parent->m_samplePeriod, m_parent->m_verbosity, m_parent->m_ioThreads);
         });
     }
 
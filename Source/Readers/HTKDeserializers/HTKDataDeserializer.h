@@ -67,6 +67,9 @@ private:
     // General configuration
     int m_verbosity;
 
+    // Maximum number of threads used to page in a chunk.
+    size_t m_ioThreads;
+
     // Total number of frames.
     size_t m_totalNumberOfFrames = 0;
 
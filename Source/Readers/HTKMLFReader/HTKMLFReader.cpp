@@ -274,6 +274,7 @@ void HTKMLFReader<ElemType>::PrepareForTrainingOrTesting(const ConfigRecordType&
 
     // get lattice toc file names
     std::pair<std::vector<wstring>, std::vector<wstring>> latticetocs;
+    wstring denLatMappedArchive;
     foreach_index (i, latticeNames) // only support one set of lattice now
     {
         const ConfigRecordType& thisLattice = readerConfig(latticeNames[i]);
@@ -289,6 +290,7 @@ void HTKMLFReader<ElemType>::PrepareForTrainingOrTesting(const ConfigRecordType&
             latticetocs.first.insert(latticetocs.first.end(), paths.begin(), paths.end());
         }
         RootPathInLatticeTocs = (wstring) thisLattice(L"prefixPathInToc", L"");
+        denLatMappedArchive = (wstring) thisLattice(L"denLatMappedArchive", L"");
     }
 
     // get HMM related file names
@@ -306,6 +308,14 @@ void HTKMLFReader<ElemType>::PrepareForTrainingOrTesting(const ConfigRecordType&
     if (cdphonetyingpaths.size() > 0 && statelistpaths.size() > 0 && transPspaths.size() > 0)
         m_hset.loadfromfile(cdphonetyingpaths[0], statelistpaths[0], transPspaths[0]);
 
+    // read the denominator lattices from a mapped lattice archive (.latmap) instead; it is converted from the TOCs on first use
+    if (!denLatMappedArchive.empty())
+    {
+        if (!fexists(denLatMappedArchive))
+            msra::lattices::archive::convertmapped(latticetocs.second, denLatMappedArchive, m_hset.getsymmap(), RootPathInLatticeTocs);
+        latticetocs.second.assign(1, denLatMappedArchive);
+    }
+
     if (iFeat != scriptpaths.size() || iLabel != mlfpathsmulti.size())
         RuntimeError("# of inputs files vs. # of inputs or # of output files vs # of outputs inconsistent\n");
 
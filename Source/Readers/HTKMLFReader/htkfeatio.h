@@ -19,6 +19,7 @@
 #include <stdint.h>
 #include <limits.h>
 #include <wchar.h>
+#include <string.h>
 #include "simplesenonehmm.h"
 #include <array>
 #include "minibatchsourcehelpers.h"
@@ -331,6 +332,7 @@ class htkfeatreader : protected htkfeatio
     vector<float> a, b;                  // for decompression
     vector<short> tmp;                   // for decompression
     vector<unsigned char> tmpByteVector; // for decompression of idx files
+    vector<char> blockbuffer;            // raw bytes of a whole range of frames, see read(MATRIX&, ts, te)
     size_t curframe;                     // current # samples read so far
     size_t numframes;                    // number of samples for current logical file
     size_t energyElements;               // how many energy elements to add if addEnergy is true
@@ -443,6 +445,12 @@ public:
             return archivepath();
         }
 
+        // true if 'next' is the archive entry stored right after this one, such that both can be read with a single read
+        bool isfollowedby(const parsedpath& next) const
+        {
+            return isarchive && next.isarchive && archivePathIdx == next.archivePathIdx && next.s == e + 1;
+        }
+
         // Gets logical path of the utterance.
         string GetLogicalPath() const
         {
@@ -609,25 +617,35 @@ public:
     // Returns number of frames in that file.
     // This understands the more complex syntax a=b[s,e] and optimizes a little
     size_t open(const parsedpath& ppath)
+    {
+        return open(ppath, ppath);
+    }
+    // open a run of archive entries that are stored back to back (see parsedpath::isfollowedby()), as if they were one
+    // Returns the total number of frames of the run.
+    size_t open(const parsedpath& first, const parsedpath& last)
     {
         // do not reopen the file if it is the same; use fsetpos() instead
-        if (f == NULL || ppath.physicallocation() != physicalpath)
-            openphysical(ppath);
+        if (f == NULL || first.physicallocation() != physicalpath)
+            openphysical(first);
 
-        if (ppath.isarchive) // reading a sub-range from an archive
+        if (first.isarchive) // reading a sub-range from an archive
         {
-            if (ppath.s > ppath.e)
-                RuntimeError("open: start frame %d > end frame %d in '%ls'", (int)ppath.s, (int)ppath.e, ((wstring)ppath).c_str());
-            if (ppath.e >= physicalframes)
-                RuntimeError("open: end frame exceeds archive's total number of frames %d in '%ls'", (int)physicalframes, ((wstring)ppath).c_str());
-
-            int64_t dataoffset = physicaldatastart + ppath.s * vecbytesize;
+            if (&first != &last && (!last.isarchive || last.physicallocation() != first.physicallocation()))
+                LogicError("open: '%ls' and '%ls' are not in the same archive", ((wstring)first).c_str(), ((wstring)last).c_str());
+            if (first.s > last.e)
+                RuntimeError("open: start frame %d > end frame %d in '%ls'", (int)first.s, (int)last.e, ((wstring)first).c_str());
+            if (last.e >= physicalframes)
+                RuntimeError("open: end frame exceeds archive's total number of frames %d in '%ls'", (int)physicalframes, ((wstring)last).c_str());
+
+            int64_t dataoffset = physicaldatastart + first.s * vecbytesize;
             fsetpos(f, dataoffset); // we assume fsetpos(), which is our own, is smart to not flush the read buffer
             curframe = 0;
-            numframes = ppath.e + 1 - ppath.s;
+            numframes = last.e + 1 - first.s;
         }
         else // reading a full file
         {
+            if (&first != &last)
+                LogicError("open: a run of entries can only be opened inside an archive ('%ls')", ((wstring)first).c_str());
             curframe = 0;
             numframes = physicalframes;
             assert(fgetpos(f) == physicaldatastart);
@@ -691,30 +709,98 @@ public:
         curframe++;
     }
     // read a sequence of vectors from the open file into a range of frames [ts,te)
+    // The whole range is fetched with a single read and then converted straight into the columns of 'feat',
+    // so the Matrix type must keep each column contiguous (as ssematrix does).
     template <class MATRIX>
     void read(MATRIX& feat, size_t ts, size_t te)
     {
-        // read vectors from file and push to our target structure
-        vector<float> v(featdim + energyElements);
-        for (size_t t = ts; t < te; t++)
+        if (te <= ts)
+            return;
+        const size_t n = te - ts;
+        if (curframe + n > numframes)
+            RuntimeError("htkfeatreader:attempted to read beyond end");
+        blockbuffer.resize(n * vecbytesize);
+        freadOrDie(blockbuffer.data(), vecbytesize, n, f);
+        // we add the energy elements (all zero) at the end of each section of features, (features, delta, delta-delta)
+        const size_t posIncrement = addEnergy ? featdim / energyElements : featdim;
+        for (size_t t = 0; t < n; t++)
+        {
+            const char* src = blockbuffer.data() + t * vecbytesize;
+            float* dst = &feat(0, ts + t);
+            if (!addEnergy)
+                decode(src, 0, featdim, dst);
+            else
+            {
+                size_t k = 0;
+                for (size_t i = 0; i < energyElements; i++, k += posIncrement)
+                {
+                    decode(src, k, k + posIncrement, dst);
+                    dst += posIncrement;
+                    *dst++ = 0.0f;
+                }
+                decode(src, k, featdim, dst); // remainder if featdim is not a multiple of energyElements
+            }
+        }
+        curframe += n;
+    }
+
+private:
+    static uint16_t bswap16(uint16_t u)
+    {
+        return (uint16_t)((u >> 8) | (u << 8));
+    }
+    static uint32_t bswap32(uint32_t u)
+    {
+        return (u >> 24) | ((u >> 8) & 0xff00) | ((u << 8) & 0xff0000) | (u << 24);
+    }
+
+    // convert elements [k0,k1) of one frame, as stored in the file, into floats at 'dst'
+    // The loops are kept free of branches so that the compiler can vectorize them.
+    void decode(const char* src, size_t k0, size_t k1, float* dst) const
+    {
+        const size_t n = k1 - k0;
+        if (isidxformat)
+        {
+            const unsigned char* p = (const unsigned char*) src + k0;
+            for (size_t k = 0; k < n; k++)
+                dst[k] = (float) p[k];
+        }
+        else if (!compressed) // not compressed--the easy one
+        {
+            memcpy(dst, src + k0 * sizeof(float), n * sizeof(float));
+            if (needbyteswapping)
+            {
+                uint32_t* u = (uint32_t*) dst;
+                for (size_t k = 0; k < n; k++)
+                    u[k] = bswap32(u[k]);
+            }
+        }
+        else // need to decompress
         {
-            read(v);
-            // add the energy elements (all zero) if needed
-            if (addEnergy)
+            const float* pa = a.data() + k0;
+            const float* pb = b.data() + k0;
+            const char* p = src + k0 * sizeof(short);
+            uint16_t u;
+            if (needbyteswapping)
+            {
+                for (size_t k = 0; k < n; k++)
+                {
+                    memcpy(&u, p + k * sizeof(u), sizeof(u));
+                    dst[k] = ((short) bswap16(u) + pb[k]) / pa[k];
+                }
+            }
+            else
             {
-                // we add the energy elements at the end of each section of features, (features, delta, delta-delta)
-                size_t posIncrement = featdim / energyElements;
-                size_t pos = posIncrement;
-                for (size_t i = 0; i < energyElements; i++, pos += posIncrement)
+                for (size_t k = 0; k < n; k++)
                 {
-                    auto iter = v.begin() + pos + i;
-                    v.insert(iter, 0.0f);
+                    memcpy(&u, p + k * sizeof(u), sizeof(u));
+                    dst[k] = ((short) u + pb[k]) / pa[k];
                 }
             }
-            foreach_index(k, v)
-                feat(k, t) = v[k];
         }
     }
+
+public:
     // read an entire utterance into an already allocated matrix
     // Matrix type needs to have operator(i,j)
     template <class MATRIX>
@@ -758,6 +844,27 @@ public:
             throw;
         }
     }
+    // read a run of archive entries stored back to back, [first, last], into an already allocated matrix with a single read
+    // The entries' frames are placed consecutively, i.e. 'feat' must have as many columns as the run has frames.
+    template <class MATRIX>
+    void read(const parsedpath& first, const parsedpath& last, const string& kindstr, const unsigned int period, MATRIX& feat)
+    {
+        size_t numframes = open(first, last);
+        if (feat.cols() != numframes || feat.rows() != featdim)
+            LogicError("read: stripe read called with wrong dimensions");
+        if (kindstr != featkind || period != featperiod)
+            LogicError("read: attempting to mixing different feature kinds");
+
+        try
+        {
+            read(feat, 0, numframes);
+        }
+        catch (...)
+        {
+            close();
+            throw;
+        }
+    }
     // read an entire utterance into a virgen, allocatable matrix
     // Matrix type needs to have operator(i,j) and resize(n,m)
     template <class MATRIX>
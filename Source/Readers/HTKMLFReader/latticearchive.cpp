@@ -524,6 +524,96 @@ void lattice::dedup()
     fprintf(stderr, "converted %d lattices\n", toclines.size());
 }
 
+// convert lattice archives (given by their TOC files) into a single mapped lattice archive (.latmap)
+// Lattices are stored in uniqued V2 form with units already mapped to the model's, such that reading one back
+// amounts to copying three arrays out of the memory mapping (see archive::getlattice()).
+// The keys are hashed into an index at the end of the file, which replaces the TOC.
+// The archive is written under a per-process temporary name and renamed when complete, so readers never see a partial file.
+/*static*/ void archive::convertmapped(const std::vector<std::wstring> &intocpaths, const std::wstring &outpath,
+                                       const std::unordered_map<std::string, size_t> &modelsymmap, const std::wstring &prefixPath)
+{
+    const size_t spunit = tryfind(modelsymmap, "sp", SIZE_MAX);
+
+    msra::lattices::archive archive(intocpaths, modelsymmap, prefixPath); // (this also rejects duplicate keys)
+
+    msra::files::make_intermediate_dirs(outpath);
+    const std::wstring tmppath = outpath + L"." + std::to_wstring(GetCurrentProcessId()) + L".tmp";
+    auto_file_ptr f(fopenOrDie(tmppath, L"wb"));
+
+    // header; rewritten at the end once the index location is known
+    mappedheader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, mappedmagic(), sizeof(header.magic));
+    fwriteOrDie(&header, sizeof(header), 1, f);
+
+    // lattice records, in order of the TOC files
+    std::vector<std::string> keys;
+    std::vector<uint64_t> recordoffsets;
+    for (const auto &intocpath : intocpaths)
+    {
+        std::vector<char> textbuffer;
+        auto toclines = msra::files::fgetfilelines(intocpath, textbuffer);
+        foreach_index (i, toclines)
+        {
+            const char *line = toclines[i];
+            const char *p = strchr(line, '=');
+            if (p == NULL)
+                RuntimeError("convertmapped: invalid TOC line (no = sign): %s", line);
+            const std::string key(line, p - line);
+
+            lattice L;
+            archive.getlattice(msra::strfun::utf16(key), L);
+            L.builduniquealignments(spunit);
+
+            keys.push_back(key);
+            recordoffsets.push_back(fgetpos(f));
+            L.fwritemapped(f);
+        }
+    }
+
+    // keys
+    std::vector<uint64_t> keyoffsets;
+    keyoffsets.reserve(keys.size());
+    for (const auto &key : keys)
+    {
+        keyoffsets.push_back(fgetpos(f));
+        fwriteOrDie(key.c_str(), sizeof(char), key.size() + 1, f);
+    }
+    lattice::fwritemappedpadding(f);
+
+    // hash index, at most half full
+    uint64_t numbuckets = 1;
+    while (numbuckets < 2 * keys.size() + 1)
+        numbuckets *= 2;
+    std::vector<mappedindexentry> index(numbuckets);
+    memset(index.data(), 0, index.size() * sizeof(index[0]));
+    foreach_index (i, keys)
+    {
+        const uint64_t hash = mappedhash(keys[i]);
+        uint64_t b = hash & (numbuckets - 1);
+        while (index[b].recordoffset != 0)
+            b = (b + 1) & (numbuckets - 1);
+        index[b].hash = hash;
+        index[b].keyoffset = keyoffsets[i];
+        index[b].recordoffset = recordoffsets[i];
+    }
+    header.numlattices = keys.size();
+    header.numbuckets = numbuckets;
+    header.indexoffset = fgetpos(f);
+    fwriteOrDie(index.data(), sizeof(index[0]), index.size(), f);
+
+    fsetpos(f, (uint64_t) 0);
+    fwriteOrDie(&header, sizeof(header), 1, f);
+    fflushOrDie(f);
+    f = NULL; // (this closes the file)
+
+    // unit map, read back by getcachedidmap()
+    writeunitmap(outpath + L".symlist", modelsymmap);
+    renameOrDie(tmppath, outpath);
+
+    fprintf(stderr, "convertmapped: converted %d lattices into '%ls'\n", (int) keys.size(), outpath.c_str());
+}
+
 // ---------------------------------------------------------------------------
 // reading lattices from external formats (HTK lat, MLF)
 // ---------------------------------------------------------------------------
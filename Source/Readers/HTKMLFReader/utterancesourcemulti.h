@@ -811,6 +811,15 @@ class minibatchutterancesourcemulti : public minibatchsource
             return v[first + i];
         }
     };
+    // verify that the state labels of an utterance end in the boundary marker appended when they were read
+    void checkclassidsboundary(const utterancechunkdata &chunkdata, size_t utteranceindex) const
+    {
+        const size_t classidsbegin = chunkdata.getclassidsbegin(utteranceindex);
+        const size_t n = chunkdata.numframes(utteranceindex);
+        foreach_index (i, classids)
+            if ((*classids[i])[classidsbegin + n] != (CLASSIDTYPE) -1)
+                LogicError("getclassids: expected boundary marker not found, internal data structure screwed up");
+    }
     template <class UTTREF>
     std::vector<shiftedvector<biggrowablevector<CLASSIDTYPE>>> getclassids(const UTTREF &uttref) // return sub-vector of classids[] for a given utterance
     {
@@ -826,12 +835,9 @@ class minibatchutterancesourcemulti : public minibatchsource
         const auto &chunkdata = chunk.getchunkdata();
         const size_t classidsbegin = chunkdata.getclassidsbegin(uttref.utteranceindex()); // index of first state label in global concatenated classids[] array
         const size_t n = chunkdata.numframes(uttref.utteranceindex());
+        checkclassidsboundary(chunkdata, uttref.utteranceindex());
         foreach_index (i, classids)
-        {
-            if ((*classids[i])[classidsbegin + n] != (CLASSIDTYPE) -1)
-                LogicError("getclassids: expected boundary marker not found, internal data structure screwed up");
             allclassids.push_back(std::move(shiftedvector<biggrowablevector<CLASSIDTYPE>>((*classids[i]), classidsbegin, n)));
-        }
         return allclassids; // nothing to return
     }
     template <class UTTREF>
@@ -1784,11 +1790,12 @@ public:
                 }
             }
 
-            // return randomized frames for the time range of those utterances
-            size_t currmpinodeframecount = 0;
+            // determine the randomized frames that this MPI node returns
+            std::vector<frameref> selectedframerefs; // [output column] -> frame
+            selectedframerefs.reserve(feat[0].cols());
             for (size_t j = 0; j < mbframes; j++)
             {
-                if (currmpinodeframecount >= feat[0].cols()) // MPI/data-parallel mode: all nodes return the same #frames, which is how feat(,) is allocated
+                if (selectedframerefs.size() >= feat[0].cols()) // MPI/data-parallel mode: all nodes return the same #frames, which is how feat(,) is allocated
                     break;
 
                 // map to time index inside arrays
@@ -1800,42 +1807,69 @@ public:
 
                 // random utterance
                 readfromdisk |= requirerandomizedchunk(frameref.chunkindex, windowbegin, windowend); // (this is just a check; should not actually page in anything)
+                // check the labels here, since the parallel gather below reads them directly and must not throw
+                // (This is one comparison per stream, cheaper than remembering which utterances were checked already.)
+                if (issupervised())
+                    checkclassidsboundary(randomizedchunks[0][frameref.chunkindex].getchunkdata(), frameref.utteranceindex());
+                selectedframerefs.push_back(frameref);
+            }
 
+            // neighbor-frame augmentation per stream; it is the same for all frames, so we determine it once from the first frame
+            std::vector<size_t> leftextents(randomizedchunks.size(), 0);
+            std::vector<size_t> rightextents(randomizedchunks.size(), 0);
+            if (!selectedframerefs.empty())
+            {
                 foreach_index (i, randomizedchunks)
                 {
-                    const auto &chunk = randomizedchunks[i][frameref.chunkindex];
-                    const auto &chunkdata = chunk.getchunkdata();
-                    auto uttframes = chunkdata.getutteranceframes(frameref.utteranceindex());
-                    matrixasvectorofvectors uttframevectors(uttframes); // (wrapper that allows m[.].size() and m[.][.] as required by augmentneighbors())
-                    const size_t n = uttframevectors.size();
-                    assert(n == uttframes.cols() && chunkdata.numframes(frameref.utteranceindex()) == n);
-                    n;
-
-                    // copy frame and class labels
-                    const size_t t = frameref.frameindex();
-
-                    size_t leftextent, rightextent;
-                    // page in the needed range of frames
                     if (leftcontext[i] == 0 && rightcontext[i] == 0)
                     {
-                        leftextent = rightextent = augmentationextent(uttframevectors[t].size(), vdim[i]);
+                        const auto &chunkdata = randomizedchunks[i][selectedframerefs[0].chunkindex].getchunkdata();
+                        leftextents[i] = rightextents[i] = augmentationextent(chunkdata.getutteranceframes(selectedframerefs[0].utteranceindex()).rows(), vdim[i]);
                     }
                     else
                     {
-                        leftextent = leftcontext[i];
-                        rightextent = rightcontext[i];
+                        leftextents[i] = leftcontext[i];
+                        rightextents[i] = rightcontext[i];
                     }
-                    augmentneighbors(uttframevectors, noboundaryflags, t, leftextent, rightextent, feat[i], currmpinodeframecount);
+                }
+            }
 
-                    if (issupervised() && i == 0)
+            // return randomized frames for the time range of those utterances
+            // Each frame goes into its own column, and all chunks are paged in by now, so the frames are gathered in parallel.
+            // Streams without neighbor frames are copied a frame at a time rather than element by element.
+            const bool supervised = issupervised();
+            const int numselectedframes = (int) selectedframerefs.size();
+#pragma omp parallel for schedule(static)
+            for (int j = 0; j < numselectedframes; j++)
+            {
+                const frameref &frameref = selectedframerefs[j];
+                const size_t t = frameref.frameindex();
+                foreach_index (i, randomizedchunks)
+                {
+                    const auto &chunkdata = randomizedchunks[i][frameref.chunkindex].getchunkdata();
+                    auto uttframes = chunkdata.getutteranceframes(frameref.utteranceindex());
+                    assert(t < uttframes.cols());
+
+                    // copy the frame
+                    if (leftextents[i] == 0 && rightextents[i] == 0)
+                    {
+                        assert(uttframes.rows() == vdim[i]);
+                        memcpy(&feat[i](0, j), &uttframes(0, t), vdim[i] * sizeof(float));
+                    }
+                    else
                     {
-                        auto frameclassids = getclassids(frameref);
-                        foreach_index (k, uids)
-                            uids[k][currmpinodeframecount] = frameclassids[k][t];
+                        matrixasvectorofvectors uttframevectors(uttframes); // (wrapper that allows m[.].size() and m[.][.] as required by augmentneighbors())
+                        augmentneighbors(uttframevectors, noboundaryflags, t, leftextents[i], rightextents[i], feat[i], j);
                     }
                 }
 
-                currmpinodeframecount++;
+                // copy the class labels (directly rather than through getclassids(), which allocates)
+                if (supervised)
+                {
+                    const size_t classidsbegin = randomizedchunks[0][frameref.chunkindex].getchunkdata().getclassidsbegin(frameref.utteranceindex());
+                    foreach_index (k, uids)
+                        uids[k][j] = (*classids[k])[classidsbegin + t];
+                }
             }
         }
         timegetbatch = timergetbatch;
@@ -15,6 +15,9 @@
 
 namespace Microsoft { namespace MSR { namespace CNTK {
 
+// Decodes an encoded image (e.g. a JPEG file in memory), see ByteReader::Read() for minDecodedSize.
+cv::Mat DecodeImage(const unsigned char* data, size_t size, bool grayscale, size_t minDecodedSize);
+
 class ByteReader
 {
 public:
@@ -22,7 +25,8 @@ public:
     virtual ~ByteReader() = default;
 
     virtual void Register(size_t seqId, const std::string& path) = 0;
-    virtual cv::Mat Read(size_t seqId, const std::string& path, bool grayscale) = 0;
+    // Images may be decoded at a reduced resolution, as long as their shorter side stays at least minDecodedSize (0 = full resolution).
+    virtual cv::Mat Read(size_t seqId, const std::string& path, bool grayscale, size_t minDecodedSize) = 0;
 
     DISABLE_COPY_AND_MOVE(ByteReader);
 };
@@ -31,7 +35,7 @@ class FileByteReader : public ByteReader
 {
 public:
     void Register(size_t, const std::string&) override {}
-    cv::Mat Read(size_t seqId, const std::string& path, bool grayscale) override;
+    cv::Mat Read(size_t seqId, const std::string& path, bool grayscale, size_t minDecodedSize) override;
 };
 
 #ifdef USE_ZIP
@@ -41,7 +45,7 @@ public:
     ZipByteReader(const std::string& zipPath);
 
     void Register(size_t seqId, const std::string& path) override;
-    cv::Mat Read(size_t seqId, const std::string& path, bool grayscale) override;
+    cv::Mat Read(size_t seqId, const std::string& path, bool grayscale, size_t minDecodedSize) override;
 
 private:
     using ZipPtr = std::unique_ptr<zip_t, void(*)(zip_t*)>;
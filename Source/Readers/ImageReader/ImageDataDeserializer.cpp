@@ -13,6 +13,9 @@
 #include "ImageConfigHelper.h"
 #include "StringUtil.h"
 #include "ConfigUtil.h"
+#include "fileutil.h"
+#include <atomic>
+#include <mutex>
 
 namespace Microsoft { namespace MSR { namespace CNTK {
 
@@ -56,10 +59,124 @@ private:
     vector<IndexType> m_indices;
 };
 
-// Used to keep track of the image. Accessed only using DenseSequenceData interface.
-struct DeserializedImage : DenseSequenceData
+// An in-memory cache of decoded images, shrunk to a fixed size of their shorter side (8 bit only).
+// Random crops and color jitter are applied by the transformers on top of the cached images,
+// so from the second epoch on, images that fit into the cache are neither read nor decoded again.
+// Images are added until the memory budget is used up; further images are written to the spill directory,
+// if one is given, or not cached. There is no eviction, since with random access over an epoch
+// any cached image is as likely to be needed next as any other. The spilled files are deleted with the cache.
+class ImageDataDeserializer::DecodedImageCache
 {
-    cv::Mat m_image;
+    struct Entry
+    {
+        cv::Mat m_image;   // empty if spilled
+        int m_rows;
+        int m_cols;
+        int m_type;
+        bool m_pending;    // being written to the spill directory
+    };
+
+    size_t m_shortSide;
+    size_t m_maxBytes;
+    size_t m_bytes;
+    std::string m_spillPath; // directory and file name prefix of the spilled images
+    std::unordered_map<size_t, Entry> m_entries;
+    std::mutex m_lock;
+
+    std::string SpillFile(size_t key) const
+    {
+        return m_spillPath + std::to_string(key) + ".img";
+    }
+
+public:
+    DecodedImageCache(size_t shortSide, size_t maxBytes, const std::string& spillDir)
+        : m_shortSide(shortSide), m_maxBytes(maxBytes), m_bytes(0)
+    {
+        if (!spillDir.empty())
+        {
+            // Several readers (e.g. of different processes) may share the directory.
+            static std::atomic<int> instances(0);
+            m_spillPath = spillDir + "/imagecache_" + std::to_string(GetCurrentProcessId()) + "_" + std::to_string(instances++) + "_";
+        }
+    }
+
+    ~DecodedImageCache()
+    {
+        // Every entry without an image has been (or was being) written to the spill directory.
+        for (const auto& entry : m_entries)
+        {
+            if (!entry.second.m_image.data)
+                std::remove(SpillFile(entry.first).c_str());
+        }
+    }
+
+    size_t ShortSide() const
+    {
+        return m_shortSide;
+    }
+
+    // Returns a private copy of the cached image (the transformers modify images in place), or an empty image.
+    cv::Mat Get(size_t key)
+    {
+        Entry entry;
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            auto found = m_entries.find(key);
+            if (found == m_entries.end() || found->second.m_pending)
+                return cv::Mat();
+            if (found->second.m_image.data)
+                return found->second.m_image.clone();
+            entry = found->second;
+        }
+
+        cv::Mat image(entry.m_rows, entry.m_cols, entry.m_type);
+        auto_file_ptr f(fopenOrDie(SpillFile(key), "rb"));
+        freadOrDie(image.data, 1, image.total() * image.elemSize(), f);
+        return image;
+    }
+
+    // Shrinks the image to the cache size (in place, so that cached and uncached images are the same)
+    // and adds it to the cache if there is room.
+    void Add(size_t key, cv::Mat& image)
+    {
+        if (image.depth() != CV_8U)
+            return;
+
+        size_t shortSide = (size_t)std::min(image.rows, image.cols);
+        if (shortSide > m_shortSide)
+        {
+            double factor = (double)m_shortSide / shortSide;
+            cv::resize(image, image, cv::Size(), factor, factor, cv::INTER_AREA);
+        }
+        if (!image.isContinuous())
+            image = image.clone();
+
+        size_t bytes = image.total() * image.elemSize();
+        Entry entry = { cv::Mat(), image.rows, image.cols, image.type(), false };
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (m_entries.find(key) != m_entries.end())
+                return;
+            if (m_bytes + bytes <= m_maxBytes)
+            {
+                m_bytes += bytes;
+                entry.m_image = image.clone();
+                m_entries[key] = entry;
+                return;
+            }
+            if (m_spillPath.empty())
+                return;
+            entry.m_pending = true;
+            m_entries[key] = entry;
+        }
+
+        auto_file_ptr f(fopenOrDie(SpillFile(key), "wb"));
+        fwriteOrDie(image.data, 1, bytes, f);
+        fflushOrDie(f);
+
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_entries[key].m_pending = false;
+    }
 };
 
 // For image, chunks correspond to a single image.
@@ -79,44 +196,109 @@ public:
         assert(sequenceId == m_description.m_id);
         const auto& imageSequence = m_description;
 
-        auto image = std::make_shared<DeserializedImage>();
-        image->m_image = std::move(m_parent.ReadImage(m_description.m_id, imageSequence.m_path, m_parent.m_grayscale));
-        auto& cvImage = image->m_image;
-
-        if (!cvImage.data)
+        size_t key = imageSequence.m_key.m_sequence;
+        cv::Mat image = m_parent.m_cache ? m_parent.m_cache->Get(key) : cv::Mat();
+        if (!image.data)
         {
-            RuntimeError("Cannot open file '%s'", imageSequence.m_path.c_str());
+            image = m_parent.ReadImage(m_description.m_id, imageSequence.m_path, m_parent.m_grayscale, m_parent.m_minDecodedSize);
+            if (!image.data)
+            {
+                RuntimeError("Cannot open file '%s'", imageSequence.m_path.c_str());
+            }
+            if (m_parent.m_cache)
+                m_parent.m_cache->Add(key, image);
         }
 
-        // Convert element type.
-        int dataType = m_parent.m_featureElementType == ElementType::tfloat ? CV_32F : CV_64F;
-        if (cvImage.type() != CV_MAKETYPE(dataType, cvImage.channels()))
-        {
-            cvImage.convertTo(cvImage, dataType);
-        }
+        m_parent.CreateSequenceData(std::move(image), imageSequence, shared_from_this(), result);
+    }
+};
+
+// For packed image files, a chunk corresponds to a whole pack.
+// The encoded images of the pack are read with a single sequential read when the first image is needed
+// (not at all if all images come from the cache), and are decoded from memory when the sequences are requested.
+class ImageDataDeserializer::PackedImageChunk : public Chunk, public std::enable_shared_from_this<PackedImageChunk>
+{
+    const ImagePack& m_pack;
+    ImageDataDeserializer& m_parent;
+    std::vector<unsigned char> m_data;
+    std::once_flag m_loaded;
+
+    void Load()
+    {
+        m_data.resize(m_pack.m_dataSize);
+        auto_file_ptr f(fopenOrDie(m_pack.m_path, "rb"));
+        fsetpos(f, m_pack.m_dataOffset);
+        freadOrDie(m_data.data(), 1, m_data.size(), f);
+    }
 
-        if (!cvImage.isContinuous())
+public:
+    PackedImageChunk(const ImagePack& pack, ImageDataDeserializer& parent)
+        : m_pack(pack), m_parent(parent)
+    {
+    }
+
+    virtual void GetSequence(size_t sequenceId, std::vector<SequenceDataPtr>& result) override
+    {
+        const auto& imageSequence = m_parent.m_imageSequences[sequenceId];
+        assert(imageSequence.m_id == sequenceId);
+        assert(imageSequence.m_packOffset + imageSequence.m_packSize <= m_pack.m_dataOffset + m_pack.m_dataSize);
+
+        size_t key = imageSequence.m_key.m_sequence;
+        cv::Mat image = m_parent.m_cache ? m_parent.m_cache->Get(key) : cv::Mat();
+        if (!image.data)
         {
-            cvImage = cvImage.clone();
+            std::call_once(m_loaded, [this]() { Load(); });
+            const unsigned char* encoded = m_data.data() + (imageSequence.m_packOffset - m_pack.m_dataOffset);
+            image = DecodeImage(encoded, imageSequence.m_packSize, m_parent.m_grayscale, m_parent.m_minDecodedSize);
+            if (!image.data)
+            {
+                RuntimeError("Cannot decode image '%s' in '%s'", imageSequence.m_path.c_str(), m_pack.m_path.c_str());
+            }
+            if (m_parent.m_cache)
+                m_parent.m_cache->Add(key, image);
         }
-        assert(cvImage.isContinuous());
-
-        image->m_data = image->m_image.data;
-        ImageDimensions dimensions(cvImage.cols, cvImage.rows, cvImage.channels());
-        image->m_sampleLayout = std::make_shared<TensorShape>(dimensions.AsTensorShape(HWC));
-        image->m_id = sequenceId;
-        image->m_numberOfSamples = 1;
-        image->m_chunk = shared_from_this();
-        result.push_back(image);
-
-        SparseSequenceDataPtr label = std::make_shared<SparseSequenceData>();
-        label->m_chunk = shared_from_this();
-        m_parent.m_labelGenerator->CreateLabelFor(imageSequence.m_classId, *label);
-        label->m_numberOfSamples = 1;
-        result.push_back(label);
+
+        m_parent.CreateSequenceData(std::move(image), imageSequence, shared_from_this(), result);
     }
 };
 
+// Creates the feature and label sequences for a decoded image.
+void ImageDataDeserializer::CreateSequenceData(cv::Mat&& decodedImage, const ImageSequenceDescription& imageSequence, const ChunkPtr& chunk, std::vector<SequenceDataPtr>& result)
+{
+    auto image = std::make_shared<ImageSequenceData>();
+    image->m_image = std::move(decodedImage);
+    auto& cvImage = image->m_image;
+
+    // Convert element type, unless the transformers take care of it. Cropping and scaling are much cheaper
+    // on the decoded 8 bit image, and the conversion then only touches the final (usually much smaller) image.
+    int dataType = m_featureElementType == ElementType::tfloat ? CV_32F : CV_64F;
+    bool keepImage = m_keepByteImages && cvImage.depth() == CV_8U;
+    if (!keepImage && cvImage.type() != CV_MAKETYPE(dataType, cvImage.channels()))
+    {
+        cvImage.convertTo(cvImage, dataType);
+    }
+
+    if (!cvImage.isContinuous())
+    {
+        cvImage = cvImage.clone();
+    }
+    assert(cvImage.isContinuous());
+
+    image->m_data = image->m_image.data;
+    ImageDimensions dimensions(cvImage.cols, cvImage.rows, cvImage.channels());
+    image->m_sampleLayout = std::make_shared<TensorShape>(dimensions.AsTensorShape(HWC));
+    image->m_id = imageSequence.m_id;
+    image->m_numberOfSamples = 1;
+    image->m_chunk = chunk;
+    result.push_back(image);
+
+    SparseSequenceDataPtr label = std::make_shared<SparseSequenceData>();
+    label->m_chunk = chunk;
+    m_labelGenerator->CreateLabelFor(imageSequence.m_classId, *label);
+    label->m_numberOfSamples = 1;
+    result.push_back(label);
+}
+
 // A new constructor to support new compositional configuration,
 // that allows composition of deserializers and transforms on inputs.
 ImageDataDeserializer::ImageDataDeserializer(CorpusDescriptorPtr corpus, const ConfigParameters& config)
@@ -144,6 +326,36 @@ ImageDataDeserializer::ImageDataDeserializer(CorpusDescriptorPtr corpus, const C
     features->m_storageType = StorageType::dense;
     features->m_elementType = AreEqualIgnoreCase(precision, "float") ? ElementType::tfloat : ElementType::tdouble;
     m_streams.push_back(features);
+    m_featureElementType = features->m_elementType;
+
+    // 8 bit images can be passed on only if all transforms come from this module and the last one converts
+    // the image to the stream element type.
+    argvector<ConfigParameters> transforms = featureSection("transforms");
+    m_keepByteImages = transforms.size() > 0;
+    for (size_t i = 0; i < transforms.size(); ++i)
+    {
+        if (transforms[i].ExistsCurrent(L"module"))
+            m_keepByteImages = false;
+    }
+    if (m_keepByteImages)
+    {
+        std::wstring lastTransform = transforms[transforms.size() - 1]("type");
+        m_keepByteImages = lastTransform == L"Mean" || lastTransform == L"Transpose";
+    }
+
+    // Images may be decoded at reduced resolution if they are scaled down right after an (optional) crop.
+    m_minDecodedSize = 0;
+    for (size_t i = 0; i < transforms.size() && !transforms[i].ExistsCurrent(L"module"); ++i)
+    {
+        std::wstring type = transforms[i]("type");
+        if (type == L"Scale")
+        {
+            m_minDecodedSize = GetMinDecodedSize(i > 0 ? &transforms[i - 1] : nullptr, transforms[i]);
+            break;
+        }
+        if (type != L"Crop" || i > 0)
+            break;
+    }
 
     // Label stream.
     ConfigParameters label = inputs(labelNames[0]);
@@ -161,6 +373,7 @@ ImageDataDeserializer::ImageDataDeserializer(CorpusDescriptorPtr corpus, const C
         std::make_shared<TypedLabelGenerator<double>>(labelDimension);
 
     m_grayscale = config(L"grayscale", false);
+    CreateCache(config);
 
     // TODO: multiview should be done on the level of randomizer/transformers - it is responsiblity of the
     // TODO: randomizer to collect how many copies each transform needs and request same sequence several times.
@@ -187,6 +400,16 @@ ImageDataDeserializer::ImageDataDeserializer(const ConfigParameters& config)
     feature->m_storageType = StorageType::dense;
 
     m_featureElementType = feature->m_elementType;
+
+    // The ImageReader pipeline always ends with the MeanTransformer (and possibly the TransposeTransformer),
+    // which convert the image to the stream element type.
+    m_keepByteImages = true;
+
+    // It also always starts with the CropTransformer and the ScaleTransformer, both configured by the feature section.
+    ConfigParameters featureSection = config(feature->m_name);
+    m_minDecodedSize = GetMinDecodedSize(&featureSection, featureSection);
+    CreateCache(config);
+
     size_t labelDimension = label->m_sampleLayout->GetDim(0);
 
     if (label->m_elementType == ElementType::tfloat)
@@ -205,10 +428,69 @@ ImageDataDeserializer::ImageDataDeserializer(const ConfigParameters& config)
     CreateSequenceDescriptions(std::make_shared<CorpusDescriptor>(), configHelper.GetMapPath(), labelDimension, configHelper.IsMultiViewCrop());
 }
 
+// Creates the cache of decoded images, if configured:
+//   cacheShortSide = 256       size of the shorter side of cached images (0 = no cache)
+//   cacheSizeMB = 4096         memory budget
+//   cacheSpillDir = "..."      optional local directory for images beyond the memory budget
+void ImageDataDeserializer::CreateCache(const ConfigParameters& config)
+{
+    size_t shortSide = config(L"cacheShortSide", (size_t)0);
+    if (shortSide == 0)
+        return;
+
+    size_t sizeInMB = config(L"cacheSizeMB", (size_t)4096);
+    std::string spillDir = config(L"cacheSpillDir", "");
+    m_cache = std::make_shared<DecodedImageCache>(shortSide, sizeInMB * 1024 * 1024, spillDir);
+
+    // Images are shrunk to the cache size anyway, so they never need to be decoded at a higher resolution.
+    m_minDecodedSize = std::max(m_minDecodedSize, shortSide);
+}
+
+// Computes the size that the shorter side of a decoded image must have at least, so that the crop
+// (with the smallest crop ratio and the largest aspect ratio jitter) is still scaled down, not up, to the target size.
+// JPEG images can then be decoded at 1/2, 1/4 or 1/8 of their resolution, which is much cheaper (see DecodeImage()).
+// Returns 0 if no such size can be determined.
+size_t ImageDataDeserializer::GetMinDecodedSize(const ConfigParameters* cropConfig, const ConfigParameters& scaleConfig)
+{
+    size_t width = scaleConfig(L"width");
+    size_t height = scaleConfig(L"height");
+
+    double cropRatio = 1.0;
+    double aspectRatioRadius = 0.0;
+    if (cropConfig)
+    {
+        floatargvector cropRatios = (*cropConfig)(L"cropRatio", "1.0");
+        cropRatio = cropRatios[0];
+        doubleargvector aspectRatioRadii = (*cropConfig)(L"aspectRatioRadius", ConfigParameters::Array(doubleargvector(vector<double>{0.0})));
+        for (size_t i = 0; i < aspectRatioRadii.size(); ++i)
+            aspectRatioRadius = std::max(aspectRatioRadius, (double)aspectRatioRadii[i]);
+    }
+
+    // The shorter crop side is at least cropRatio * sqrt(1 - aspectRatioRadius) times the shorter image side.
+    double minCropFraction = cropRatio * std::sqrt(std::max(1.0 - aspectRatioRadius, 0.0));
+    if (minCropFraction <= 0 || width == 0 || height == 0)
+        return 0;
+    return (size_t)std::ceil(std::max(width, height) / minCropFraction);
+}
+
 // Descriptions of chunks exposed by the image reader.
 ChunkDescriptions ImageDataDeserializer::GetChunkDescriptions()
 {
     ChunkDescriptions result;
+    if (!m_packs.empty())
+    {
+        result.reserve(m_packs.size());
+        for (size_t i = 0; i < m_packs.size(); ++i)
+        {
+            auto chunk = std::make_shared<ChunkDescription>();
+            chunk->m_id = (ChunkIdType)i;
+            chunk->m_numberOfSamples = m_packs[i].m_sequences.size();
+            chunk->m_numberOfSequences = m_packs[i].m_sequences.size();
+            result.push_back(chunk);
+        }
+        return result;
+    }
+
     result.reserve(m_imageSequences.size());
     for (auto const& s : m_imageSequences)
     {
@@ -224,12 +506,25 @@ ChunkDescriptions ImageDataDeserializer::GetChunkDescriptions()
 
 void ImageDataDeserializer::GetSequencesForChunk(ChunkIdType chunkId, std::vector<SequenceDescription>& result)
 {
+    if (!m_packs.empty())
+    {
+        for (size_t index : m_packs[chunkId].m_sequences)
+            result.push_back(m_imageSequences[index]);
+        return;
+    }
+
     // Currently a single sequence per chunk.
     result.push_back(m_imageSequences[chunkId]);
 }
 
 void ImageDataDeserializer::CreateSequenceDescriptions(CorpusDescriptorPtr corpus, std::string mapPath, size_t labelDimension, bool isMultiCrop)
 {
+    if (IsPackListPath(mapPath))
+    {
+        CreatePackedSequenceDescriptions(corpus, mapPath, labelDimension, isMultiCrop);
+        return;
+    }
+
     std::ifstream mapFile(mapPath);
     if (!mapFile)
     {
@@ -301,8 +596,148 @@ void ImageDataDeserializer::CreateSequenceDescriptions(CorpusDescriptorPtr corpu
     }
 }
 
+// Packed image files
+// A pack list file (*.imgpacklist) names one packed image file (*.imgpack) per line; relative paths are relative
+// to the list file. A packed image file contains many encoded images (typically 64-256 MB worth), so that a chunk
+// is read with a single sequential read instead of opening a file per image:
+//   header:  char magic[8] = "CNTKIPK1"; uint64 numRecords; uint64 indexOffset; uint64 indexSize
+//   data:    the encoded image files (e.g. JPEG), back to back
+//   index:   at indexOffset, per record: uint64 offset; uint32 size; uint32 classId; uint32 keyLength; char key[keyLength]
+// All numbers are little endian. A pack can be created from a map file with Examples/Image/Miscellaneous/ImagePackConverter.py.
+
+static const char s_imagePackMagic[8] = { 'C', 'N', 'T', 'K', 'I', 'P', 'K', '1' };
+static const size_t s_imagePackHeaderSize = sizeof(s_imagePackMagic) + 3 * sizeof(uint64_t);
+
+bool ImageDataDeserializer::IsPackListPath(const std::string& path)
+{
+    const std::string extension = ".imgpacklist";
+    return path.size() >= extension.size() && path.compare(path.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+template <class T>
+static T ReadPackValue(const std::vector<char>& buffer, size_t& pos, const std::string& path)
+{
+    if (pos + sizeof(T) > buffer.size())
+        RuntimeError("Packed image file '%s' has a truncated index.", path.c_str());
+    T value;
+    memcpy(&value, buffer.data() + pos, sizeof(T));
+    pos += sizeof(T);
+    return value;
+}
+
+void ImageDataDeserializer::CreatePackedSequenceDescriptions(CorpusDescriptorPtr corpus, const std::string& packListPath, size_t labelDimension, bool isMultiCrop)
+{
+    std::ifstream packListFile(packListPath);
+    if (!packListFile)
+    {
+        RuntimeError("Could not open %s for reading.", packListPath.c_str());
+    }
+
+    auto slashPos = packListPath.find_last_of("/\\");
+    std::string packListDir = slashPos == std::string::npos ? "" : packListPath.substr(0, slashPos + 1);
+
+    size_t itemsPerLine = isMultiCrop ? 10 : 1;
+    size_t curId = 0;
+    ImageSequenceDescription description;
+    description.m_numberOfSamples = 1;
+
+    auto& stringRegistry = corpus->GetStringRegistry();
+    std::string packPath;
+    while (std::getline(packListFile, packPath))
+    {
+        if (!packPath.empty() && packPath.back() == '\r')
+            packPath.pop_back();
+        if (packPath.empty())
+            continue;
+        if (packPath[0] != '/' && packPath[0] != '\\' && packPath.find(':') == std::string::npos)
+            packPath = packListDir + packPath;
+
+        // Read header and index.
+        auto_file_ptr f(fopenOrDie(packPath, "rb"));
+        std::vector<char> header(s_imagePackHeaderSize);
+        freadOrDie(header.data(), 1, header.size(), f);
+        if (memcmp(header.data(), s_imagePackMagic, sizeof(s_imagePackMagic)) != 0)
+            RuntimeError("'%s' is not a packed image file.", packPath.c_str());
+        size_t pos = sizeof(s_imagePackMagic);
+        uint64_t numRecords = ReadPackValue<uint64_t>(header, pos, packPath);
+        uint64_t indexOffset = ReadPackValue<uint64_t>(header, pos, packPath);
+        uint64_t indexSize = ReadPackValue<uint64_t>(header, pos, packPath);
+        if (indexOffset < s_imagePackHeaderSize)
+            RuntimeError("Packed image file '%s' has an invalid index offset.", packPath.c_str());
+        std::vector<char> index((size_t)indexSize);
+        fsetpos(f, indexOffset);
+        freadOrDie(index.data(), 1, index.size(), f);
+        f = NULL; // (this closes the file)
+
+        ImagePack pack;
+        pack.m_path = packPath;
+        pack.m_dataOffset = s_imagePackHeaderSize;
+        pack.m_dataSize = indexOffset - s_imagePackHeaderSize;
+
+        pos = 0;
+        for (uint64_t i = 0; i < numRecords; ++i)
+        {
+            uint64_t offset = ReadPackValue<uint64_t>(index, pos, packPath);
+            uint32_t size = ReadPackValue<uint32_t>(index, pos, packPath);
+            uint32_t cid = ReadPackValue<uint32_t>(index, pos, packPath);
+            uint32_t keyLength = ReadPackValue<uint32_t>(index, pos, packPath);
+            if (pos + keyLength > index.size())
+                RuntimeError("Packed image file '%s' has a truncated index.", packPath.c_str());
+            std::string sequenceKey(index.data() + pos, keyLength);
+            pos += keyLength;
+
+            if (offset < pack.m_dataOffset || offset + size > indexOffset)
+                RuntimeError("Image '%s' in packed image file '%s' is out of bounds.", sequenceKey.c_str(), packPath.c_str());
+
+            // Skipping sequences that are not included in corpus.
+            if (!corpus->IsIncluded(sequenceKey))
+            {
+                continue;
+            }
+
+            if (cid >= labelDimension)
+            {
+                RuntimeError(
+                    "Image '%s' has invalid class id '%" PRIu64 "'. Expected label dimension is '%" PRIu64 "'. Packed image file %s.",
+                    sequenceKey.c_str(), (size_t)cid, labelDimension, packPath.c_str());
+            }
+
+            if (CHUNKID_MAX < m_packs.size() + 1)
+            {
+                RuntimeError("Maximum number of chunks exceeded.");
+            }
+
+            for (size_t start = curId; curId < start + itemsPerLine; curId++)
+            {
+                description.m_id = curId;
+                description.m_chunkId = (ChunkIdType)m_packs.size();
+                description.m_path = sequenceKey;
+                description.m_classId = cid;
+                description.m_packOffset = offset;
+                description.m_packSize = size;
+                description.m_key.m_sequence = stringRegistry[sequenceKey];
+                description.m_key.m_sample = 0;
+
+                m_keyToSequence[description.m_key.m_sequence] = m_imageSequences.size();
+                pack.m_sequences.push_back(m_imageSequences.size());
+                m_imageSequences.push_back(description);
+            }
+        }
+
+        // Packs without any included images do not become chunks.
+        if (!pack.m_sequences.empty())
+            m_packs.push_back(std::move(pack));
+    }
+
+    if (m_packs.empty())
+        RuntimeError("No images found in the packed image files listed in %s.", packListPath.c_str());
+}
+
 ChunkPtr ImageDataDeserializer::GetChunk(ChunkIdType chunkId)
 {
+    if (!m_packs.empty())
+        return std::make_shared<PackedImageChunk>(m_packs[chunkId], *this);
+
     auto sequenceDescription = m_imageSequences[chunkId];
     return std::make_shared<ImageChunk>(sequenceDescription, *this);
 }
@@ -344,21 +779,93 @@ void ImageDataDeserializer::RegisterByteReader(size_t seqId, const std::string&
 #endif
 }
 
-cv::Mat ImageDataDeserializer::ReadImage(size_t seqId, const std::string& path, bool grayscale)
+cv::Mat ImageDataDeserializer::ReadImage(size_t seqId, const std::string& path, bool grayscale, size_t minDecodedSize)
 {
     assert(!path.empty());
 
     ImageDataDeserializer::SeqReaderMap::const_iterator r;
     if (m_readers.empty() || (r = m_readers.find(seqId)) == m_readers.end())
-        return m_defaultReader.Read(seqId, path, grayscale);
-    return (*r).second->Read(seqId, path, grayscale);
+        return m_defaultReader.Read(seqId, path, grayscale, minDecodedSize);
+    return (*r).second->Read(seqId, path, grayscale, minDecodedSize);
 }
 
-cv::Mat FileByteReader::Read(size_t, const std::string& path, bool grayscale)
+cv::Mat FileByteReader::Read(size_t, const std::string& path, bool grayscale, size_t minDecodedSize)
 {
     assert(!path.empty());
 
-    return cv::imread(path, grayscale ? cv::IMREAD_GRAYSCALE : cv::IMREAD_COLOR);
+    if (minDecodedSize == 0)
+        return cv::imread(path, grayscale ? cv::IMREAD_GRAYSCALE : cv::IMREAD_COLOR);
+
+    // We need to look at the header to pick the decoding resolution, so we read the file ourselves.
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f)
+        return cv::Mat(); // reported by the caller
+    std::vector<unsigned char> contents(filesize(f));
+    size_t bytesRead = fread(contents.data(), 1, contents.size(), f);
+    fclose(f);
+    if (bytesRead != contents.size())
+        RuntimeError("Could not read image file '%s'.", path.c_str());
+    return DecodeImage(contents.data(), contents.size(), grayscale, minDecodedSize);
+}
+
+// Reads the image dimensions from the frame header of a JPEG image. Returns false if the data is not a (valid) JPEG image.
+static bool GetJpegSize(const unsigned char* data, size_t size, int& width, int& height)
+{
+    if (size < 4 || data[0] != 0xFF || data[1] != 0xD8)
+        return false;
+
+    size_t pos = 2;
+    while (pos + 4 <= size)
+    {
+        if (data[pos] != 0xFF)
+            return false;
+        unsigned char marker = data[pos + 1];
+        if (marker == 0xFF) // fill byte
+        {
+            pos++;
+            continue;
+        }
+        pos += 2;
+        if (marker == 0x01 || (0xD0 <= marker && marker <= 0xD7)) // markers without a segment
+            continue;
+        if (marker == 0xD9 || marker == 0xDA) // end of image or start of scan before any frame header
+            return false;
+
+        size_t length = (data[pos] << 8) | data[pos + 1];
+        // SOF0..SOF15 (except DHT, JPG and DAC): length, precision, height, width
+        if (0xC0 <= marker && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC)
+        {
+            if (pos + 7 > size)
+                return false;
+            height = (data[pos + 3] << 8) | data[pos + 4];
+            width = (data[pos + 5] << 8) | data[pos + 6];
+            return width > 0 && height > 0;
+        }
+        pos += length;
+    }
+    return false;
+}
+
+cv::Mat DecodeImage(const unsigned char* data, size_t size, bool grayscale, size_t minDecodedSize)
+{
+    int flags = grayscale ? cv::IMREAD_GRAYSCALE : cv::IMREAD_COLOR;
+#if CV_VERSION_MAJOR > 3 || (CV_VERSION_MAJOR == 3 && CV_VERSION_MINOR >= 1)
+    // JPEG can be decoded at 1/2, 1/4 or 1/8 of the resolution by skipping DCT coefficients, which is much cheaper.
+    int width, height;
+    if (minDecodedSize > 0 && GetJpegSize(data, size, width, height))
+    {
+        size_t shorterSide = (size_t)std::min(width, height);
+        if (shorterSide >= 8 * minDecodedSize)
+            flags = grayscale ? cv::IMREAD_REDUCED_GRAYSCALE_8 : cv::IMREAD_REDUCED_COLOR_8;
+        else if (shorterSide >= 4 * minDecodedSize)
+            flags = grayscale ? cv::IMREAD_REDUCED_GRAYSCALE_4 : cv::IMREAD_REDUCED_COLOR_4;
+        else if (shorterSide >= 2 * minDecodedSize)
+            flags = grayscale ? cv::IMREAD_REDUCED_GRAYSCALE_2 : cv::IMREAD_REDUCED_COLOR_2;
+    }
+#else
+    UNUSED(minDecodedSize);
+#endif
+    return cv::imdecode(cv::Mat(1, (int)size, CV_8UC1, const_cast<unsigned char*>(data)), flags);
 }
 
 bool ImageDataDeserializer::GetSequenceDescriptionByKey(const KeyType& key, SequenceDescription& result)
@@ -13,9 +13,21 @@
 
 namespace Microsoft { namespace MSR { namespace CNTK {
 
+// An image sequence, as produced by the deserializer and passed between the image transformers.
+// The image keeps the element type it currently has, which is not necessarily the element type of the stream:
+// decoded 8 bit images stay 8 bit until a transformer needs floating point values (see ImageTransformers.h).
+struct ImageSequenceData : DenseSequenceData
+{
+    cv::Mat m_image;
+    // In case we do not copy data - we have to preserve the original sequence.
+    SequenceDataPtr m_original;
+};
+
 // Image data deserializer based on the OpenCV library.
 // The deserializer currently supports two output streams only: a feature and a label stream.
 // All sequences consist only of a single sample (image/label).
+// Images are either read from individual files (listed in a map file, one chunk per image), or from
+// packed image files (listed in a *.imgpacklist file, one chunk per pack; see CreatePackedSequenceDescriptions).
 // For features it uses dense storage format with different layout (dimensions) per sequence.
 // For labels it uses the csc sparse storage format.
 class ImageDataDeserializer : public DataDeserializerBase
@@ -44,14 +56,34 @@ private:
     // Creates a set of sequence descriptions.
     void CreateSequenceDescriptions(CorpusDescriptorPtr corpus, std::string mapPath, size_t labelDimension, bool isMultiCrop);
 
+    // Creates a set of sequence descriptions from a list of packed image files.
+    void CreatePackedSequenceDescriptions(CorpusDescriptorPtr corpus, const std::string& packListPath, size_t labelDimension, bool isMultiCrop);
+    static bool IsPackListPath(const std::string& path);
+
     // Image sequence descriptions. Currently, a sequence contains a single sample only.
     struct ImageSequenceDescription : public SequenceDescription
     {
-        std::string m_path;
+        std::string m_path; // for packed images the sequence key, used in messages
         size_t m_classId;
+        // Location of the encoded image in a packed image file.
+        uint64_t m_packOffset;
+        uint32_t m_packSize;
+    };
+
+    // A packed image file, which is a single chunk.
+    struct ImagePack
+    {
+        std::string m_path;
+        uint64_t m_dataOffset;             // position and size of the encoded images in the file
+        uint64_t m_dataSize;
+        std::vector<size_t> m_sequences;   // indices into m_imageSequences
     };
 
     class ImageChunk;
+    class PackedImageChunk;
+
+    // Creates the feature and label sequences for a decoded image.
+    void CreateSequenceData(cv::Mat&& decodedImage, const ImageSequenceDescription& imageSequence, const ChunkPtr& chunk, std::vector<SequenceDataPtr>& result);
 
     // A helper class for generation of type specific labels (currently float/double only).
     class LabelGenerator;
@@ -61,6 +93,9 @@ private:
     // Sequence descriptions for all input data.
     std::vector<ImageSequenceDescription> m_imageSequences;
 
+    // Packed image files, if the input is a pack list rather than a map file.
+    std::vector<ImagePack> m_packs;
+
     // Mapping of logical sequence key into sequence description.
     std::map<size_t, size_t> m_keyToSequence;
 
@@ -70,10 +105,24 @@ private:
     // whether images shall be loaded in grayscale 
     bool m_grayscale;
 
+    // Whether decoded 8 bit images are passed on as is, leaving the conversion to the stream element type
+    // to the transformers. Only safe if the transform pipeline ends in a transformer that converts (see ImageTransformers.h).
+    bool m_keepByteImages;
+
     // Not using nocase_compare here as it's not correct on Linux.
     using PathReaderMap = std::unordered_map<std::string, std::shared_ptr<ByteReader>>;
     void RegisterByteReader(size_t seqId, const std::string& path, PathReaderMap& knownReaders);
-    cv::Mat ReadImage(size_t seqId, const std::string& path, bool grayscale);
+    cv::Mat ReadImage(size_t seqId, const std::string& path, bool grayscale, size_t minDecodedSize);
+
+    static size_t GetMinDecodedSize(const ConfigParameters* cropConfig, const ConfigParameters& scaleConfig);
+
+    // Minimum size of the shorter side of decoded images (0 = always decode at full resolution).
+    size_t m_minDecodedSize;
+
+    // Optional cache of decoded images, shared by all chunks.
+    class DecodedImageCache;
+    void CreateCache(const ConfigParameters& config);
+    std::shared_ptr<DecodedImageCache> m_cache;
 
     // REVIEW alexeyk: can potentially use vector instead of map. Need to handle default reader and resizing though.
     using SeqReaderMap = std::unordered_map<size_t, std::shared_ptr<ByteReader>>;
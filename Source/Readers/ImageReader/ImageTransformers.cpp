@@ -8,6 +8,7 @@
 #include <unordered_map>
 #include <random>
 #include "ImageTransformers.h"
+#include "ImageDataDeserializer.h"
 #include "Config.h"
 #include "ConcStack.h"
 #include "StringUtil.h"
@@ -16,13 +17,6 @@
 namespace Microsoft { namespace MSR { namespace CNTK 
 {
 
-struct ImageSequenceData : DenseSequenceData
-{
-    cv::Mat m_image;
-    // In case we do not copy data - we have to preserve the original sequence.
-    SequenceDataPtr m_original;
-};
-
 ImageTransformerBase::ImageTransformerBase(const ConfigParameters& readerConfig) : m_imageElementType(0)
 {
     m_seed = readerConfig(L"seed", 0u);
@@ -67,8 +61,9 @@ SequenceDataPtr ImageTransformerBase::Transform(SequenceDataPtr sequence)
     int channels = static_cast<int>(dimensions.m_numChannels);
 
     auto result = std::make_shared<ImageSequenceData>();
-    int type = CV_MAKETYPE(m_imageElementType, channels);
-    cv::Mat buffer = cv::Mat(rows, columns, type, inputSequence.m_data);
+    // Images coming from the deserializer or another image transformer may still be 8 bit, so we take their actual type.
+    auto image = std::dynamic_pointer_cast<ImageSequenceData>(sequence);
+    cv::Mat buffer = image ? image->m_image : cv::Mat(rows, columns, CV_MAKETYPE(m_imageElementType, channels), inputSequence.m_data);
     Apply(sequence->m_id, buffer);
     if (!buffer.isContinuous())
     {
@@ -327,19 +322,20 @@ void ScaleTransformer::Apply(size_t id, cv::Mat &mat)
 {
     UNUSED(id);
 
-    // If matrix has not been converted to the right type, do it now as rescaling
-    // requires floating point type.
-    if (mat.type() != CV_MAKETYPE(m_imageElementType, m_imgChannels))
-    {
-        mat.convertTo(mat, m_imageElementType);
-    }
-
+    // Rescaling works on any element type. An 8 bit image is kept as is: it is cheaper to scale, and since
+    // the crop is only a view, this is a single resampling pass over the original pixels.
+    // Its result is rounded to 8 bit, which is within half a step of scaling in floating point for nearest and
+    // linear interpolation. Cubic and Lanczos interpolation overshoot at edges, and 8 bit would clip that,
+    // so for those the image is converted to the stream element type first.
     auto seed = GetSeed();
     auto rng = m_rngs.pop_or_create([seed]() { return std::make_unique<std::mt19937>(seed); });
 
     auto index = UniIntT(0, static_cast<int>(m_interp.size()) - 1)(*rng);
     assert(m_interp.size() > 0);
-    cv::resize(mat, mat, cv::Size((int)m_imgWidth, (int)m_imgHeight), 0, 0, m_interp[index]);
+    int interp = m_interp[index];
+    if (mat.depth() == CV_8U && interp != cv::INTER_NEAREST && interp != cv::INTER_LINEAR)
+        mat.convertTo(mat, m_imageElementType);
+    cv::resize(mat, mat, cv::Size((int)m_imgWidth, (int)m_imgHeight), 0, 0, interp);
 
     m_rngs.push(std::move(rng));
 }
@@ -381,6 +377,18 @@ void MeanTransformer::Apply(size_t id, cv::Mat &mat)
            (m_meanImg.size() == mat.size() &&
            m_meanImg.channels() == mat.channels()));
 
+    // An 8 bit image is converted to the stream element type here, in the same pass as the mean subtraction.
+    if (mat.depth() == CV_8U)
+    {
+        cv::Mat result;
+        if (m_meanImg.size() == mat.size())
+            cv::subtract(mat, m_meanImg, result, cv::noArray(), m_imageElementType);
+        else
+            mat.convertTo(result, m_imageElementType);
+        mat = result;
+        return;
+    }
+
     // REVIEW alexeyk: check type conversion (float/double).
     if (m_meanImg.size() == mat.size())
     {
@@ -429,6 +437,18 @@ struct DenseSequenceWithBuffer : DenseSequenceData
     std::vector<char> m_buffer;
 };
 
+template <class TElemType, class TSourceType>
+static void TransposeHWCToCHW(const TSourceType* src, TElemType* dst, size_t rowCount, size_t channelCount)
+{
+    for (size_t irow = 0; irow < rowCount; irow++)
+    {
+        for (size_t icol = 0; icol < channelCount; icol++)
+        {
+            dst[icol * rowCount + irow] = static_cast<TElemType>(src[irow * channelCount + icol]);
+        }
+    }
+}
+
 template <class TElemType>
 SequenceDataPtr TransposeTransformer::TypedTransform(SequenceDataPtr sequence)
 {
@@ -444,16 +464,14 @@ SequenceDataPtr TransposeTransformer::TypedTransform(SequenceDataPtr sequence)
     size_t rowCount = dimensions.m_height * dimensions.m_width;
     size_t channelCount = dimensions.m_numChannels;
 
-    auto src = reinterpret_cast<TElemType*>(inputSequence.m_data);
     auto dst = reinterpret_cast<TElemType*>(result->m_buffer.data());
 
-    for (size_t irow = 0; irow < rowCount; irow++)
-    {
-        for (size_t icol = 0; icol < channelCount; icol++)
-        {
-            dst[icol * rowCount + irow] = src[irow * channelCount + icol];
-        }
-    }
+    // An image that is still 8 bit is converted to the stream element type while transposing.
+    auto image = std::dynamic_pointer_cast<ImageSequenceData>(sequence);
+    if (image && image->m_image.depth() == CV_8U)
+        TransposeHWCToCHW(image->m_image.ptr<unsigned char>(), dst, rowCount, channelCount);
+    else
+        TransposeHWCToCHW(reinterpret_cast<TElemType*>(inputSequence.m_data), dst, rowCount, channelCount);
 
     result->m_sampleLayout = m_outputStream.m_sampleLayout;
     result->m_data = result->m_buffer.data();
@@ -501,6 +519,9 @@ void IntensityTransformer::Apply(size_t id, cv::Mat &mat)
     if (m_eigVal.empty() || m_eigVec.empty() || m_curStdDev == 0)
         return;
 
+    if (mat.depth() == CV_8U)
+        mat.convertTo(mat, m_imageElementType);
+
     if (mat.type() == CV_64FC(mat.channels()))
         Apply<double>(mat);
     else if (mat.type() == CV_32FC(mat.channels()))
@@ -575,6 +596,9 @@ void ColorTransformer::Apply(size_t id, cv::Mat &mat)
     if (m_curBrightnessRadius == 0 && m_curContrastRadius == 0 && m_curSaturationRadius == 0)
         return;
 
+    if (mat.depth() == CV_8U)
+        mat.convertTo(mat, m_imageElementType);
+
     if (mat.type() == CV_64FC(mat.channels()))
         Apply<double>(mat);
     else if (mat.type() == CV_32FC(mat.channels()))
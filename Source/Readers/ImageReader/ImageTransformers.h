@@ -20,6 +20,11 @@ class ConfigParameters;
 
 // Base class for image transformations based on OpenCV
 // that helps to wrap the sequences into OpenCV::Mat class.
+// Decoded images may arrive as 8 bit (see ImageSequenceData). Transformers that only move pixels (crop, and scale
+// with nearest or linear interpolation) keep them 8 bit; transformers that need floating point values convert them
+// to the stream element type first.
+// The MeanTransformer and the TransposeTransformer always output the stream element type, so one of them must end the pipeline
+// for 8 bit images to be passed through (the deserializer checks this).
 class ImageTransformerBase : public Transformer
 {
 public:
@@ -56,7 +56,7 @@ void ZipByteReader::Register(size_t seqId, const std::string& path)
     m_zips.push(std::move(zipFile));
 }
 
-cv::Mat ZipByteReader::Read(size_t seqId, const std::string& path, bool grayscale)
+cv::Mat ZipByteReader::Read(size_t seqId, const std::string& path, bool grayscale, size_t minDecodedSize)
 {
     // Find index of the file in .zip file.
     auto r = m_seqIdToIndex.find(seqId);
@@ -100,7 +100,7 @@ cv::Mat ZipByteReader::Read(size_t seqId, const std::string& path, bool grayscal
     m_zips.push(std::move(zipFile));
 
     cv::Mat img; 
-    img = cv::imdecode(cv::Mat(1, (int)size, CV_8UC1, contents.data()), grayscale ? cv::IMREAD_GRAYSCALE : cv::IMREAD_COLOR);
+    img = DecodeImage(contents.data(), (size_t)size, grayscale, minDecodedSize);
     assert(nullptr != img.data);
     m_workspace.push(std::move(contents));
     return img;
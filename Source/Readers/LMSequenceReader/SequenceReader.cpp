@@ -17,6 +17,7 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <algorithm>
 
 namespace Microsoft { namespace MSR { namespace CNTK {
 
@@ -604,9 +605,9 @@ void SequenceReader<ElemType>::ReadWord(char* word, FILE* fin)
 
 template <class ElemType>
 void SequenceReader<ElemType>::ReadClassInfo(const wstring& vocfile, int& classSize,
-                                             map<string, int>& word4idx,
+                                             unordered_map<string, int>& word4idx,
                                              map<int, string>& idx4word,
-                                             map<int, int>& idx4class,
+                                             vector<int>& idx4class,
                                              map<int, size_t>& idx4cnt,
                                              int nwords, // only used for a consistency check
                                              string mUnk,
@@ -643,6 +644,8 @@ void SequenceReader<ElemType>::ReadClassInfo(const wstring& vocfile, int& classS
         word4idx[strtmp] = b;
         idx4word[b] = strtmp;
 
+        if (idx4class.size() <= b)
+            idx4class.resize(b + 1, 0);
         idx4class[b] = clsidx;
         classSize = max(classSize, clsidx);
     }
@@ -650,8 +653,8 @@ void SequenceReader<ElemType>::ReadClassInfo(const wstring& vocfile, int& classS
     classSize++;
 
     // Note: If users specify labelDim = 0 (->nwords) this will not fail. Later we will interpret this as "infer".
-    if (idx4class.size() < nwords)
-        RuntimeError("ReadClassInfo: The actual number of words %d is smaller than the specified vocabulary size %d. Check if labelDim is too large. ", (int) idx4class.size(), (int) nwords);
+    if (idx4cnt.size() < nwords)
+        RuntimeError("ReadClassInfo: The actual number of words %d is smaller than the specified vocabulary size %d. Check if labelDim is too large. ", (int) idx4cnt.size(), (int) nwords);
 
     std::vector<double> counts(idx4cnt.size());
     for (const auto& p : idx4cnt)
@@ -1019,9 +1022,9 @@ void SequenceReader<ElemType>::GetLabelOutput(StreamMinibatchInputs& matrices,
         }
         else if (readerMode == ReaderMode::Class)
         {
-            int clsidx = idx4class[wrd];
             if (m_classSize > 0)
             {
+                int clsidx = idx4class[wrd];
                 labels.SetValue(1, j, (ElemType) clsidx);
                 // save the [begining ending_indx) of the class
                 labels.SetValue(2, j, (*m_classInfoLocal)(0, clsidx)); // begining index of the class
@@ -1564,12 +1567,27 @@ void BatchSequenceReader<ElemType>::InitFromConfig(const ConfigRecordType& reade
     m_featureCount = 1;
 
     wstring pathName = readerConfig(L"file", L"");
-    if (m_traceLevel > 0)
-        fwprintf(stderr, L"LMSequenceReader: Input file is '%s'.\n", pathName.c_str());
-
     const LabelInfo& labelIn = m_labelInfo[labelInfoIn];
     const LabelInfo& labelOut = m_labelInfo[labelInfoOut];
-    m_parser.ParseInit(pathName.c_str(), m_featureDim, labelIn.dim, labelOut.dim, labelIn.beginSequence, labelIn.endSequence, labelOut.beginSequence, labelOut.endSequence);
+
+    // Optionally, the corpus is tokenized once into a binary file of label ids, which is then memory-mapped
+    // instead of parsing the text and looking up every token again in each epoch.
+    // The binary file is created from 'file' if it does not exist yet; delete it to convert again.
+    // Under MPI, the main node creates its readers before the others (see DoTrain()), so only one process converts.
+    wstring binaryPath = readerConfig(L"binaryFile", L"");
+    if (!binaryPath.empty() && (labelIn.type != labelCategory || (labelOut.type != labelNextWord && labelOut.type != labelNone)))
+        InvalidArgument("BatchSequenceReader: 'binaryFile' requires category input labels and output labels of type 'nextWord' or 'none'.");
+
+    if (binaryPath.empty() || !fexists(binaryPath))
+    {
+        if (m_traceLevel > 0)
+            fwprintf(stderr, L"LMSequenceReader: Input file is '%ls'.\n", pathName.c_str());
+        m_parser.ParseInit(pathName.c_str(), m_featureDim, labelIn.dim, labelOut.dim, labelIn.beginSequence, labelIn.endSequence, labelOut.beginSequence, labelOut.endSequence);
+        if (!binaryPath.empty())
+            ConvertToBinaryCorpus(binaryPath);
+    }
+    if (!binaryPath.empty())
+        OpenBinaryCorpus(binaryPath);
 
     mRequestedNumParallelSequences = readerConfig(L"nbruttsineachrecurrentiter", (size_t) 1); // 0 indicates auto-fill mbSize
     // TODO: ^^ This should depend on the sequences themselves.
@@ -1673,10 +1691,150 @@ void BatchSequenceReader<ElemType>::StartMinibatchLoop(size_t mbSize, size_t epo
     m_idx2clsRead = false;
 
     m_parser.ParseReset();
+    m_binaryNextSentence = 0;
 
     Reset();
 }
 
+// header of the binary corpus file written by ConvertToBinaryCorpus()
+// It is followed by the token ids (uint32_t[numTokens], padded to a multiple of 8 bytes),
+// the sentence begins (uint64_t[numSentences + 1], the last one being numTokens),
+// and the word classes (int32_t[numClassEntries], indexed by word id, empty if there is no word-class file).
+struct BinaryCorpusHeader
+{
+    char magic[8];
+    uint64_t numSentences;
+    uint64_t numTokens;
+    uint64_t vocabularySize;  // input label dimension the ids were mapped with
+    uint64_t numClassEntries;
+};
+static const char binaryCorpusMagic[] = "CNTKLMB1";
+
+// ConvertToBinaryCorpus - tokenize the entire text corpus and write it as label ids into a binary file
+// Sentences are formed by the text parser, and label ids are determined as in GetMinibatchData().
+// The file is written under a temporary name and renamed when complete, so that no reader ever sees a partial file.
+template <class ElemType>
+void BatchSequenceReader<ElemType>::ConvertToBinaryCorpus(const wstring& binaryPath)
+{
+    LabelInfo& labelIn = m_labelInfo[labelInfoIn];
+    fprintf(stderr, "LMSequenceReader: Converting corpus to binary file '%ls'...", binaryPath.c_str()), fflush(stderr);
+
+    // The header is written last, so that an incomplete file never passes the magic check.
+    BinaryCorpusHeader header = {};
+    const wstring tmpPath = binaryPath + L".tmp";
+    FILE* f = fopenOrDie(tmpPath, L"wb");
+    fwriteOrDie(&header, sizeof(header), 1, f);
+
+    std::vector<uint64_t> sentenceBegins(1, 0);
+    std::vector<uint32_t> ids;
+    std::vector<LabelType> labels;
+    std::vector<ElemType> numbers;
+    std::vector<SequencePosition> seqPos;
+    m_parser.ParseReset();
+    for (;;)
+    {
+        labels.clear();
+        numbers.clear();
+        seqPos.clear();
+        m_parser.mSentenceIndex2SentenceInfo.clear();
+        if (m_parser.Parse(m_cacheBlockSize, &labels, &numbers, &seqPos) == 0)
+            break;
+        for (const auto& sentence : m_parser.mSentenceIndex2SentenceInfo)
+            sentenceBegins.push_back(sentenceBegins.back() + sentence.sLen);
+
+        ids.resize(labels.size());
+        for (size_t i = 0; i < labels.size(); i++)
+        {
+            // the end symbol is matched case-insensitively, as for 'nextWord' output labels
+            const auto& label = EqualCI(labels[i], labelIn.endSequence) ? labelIn.endSequence : labels[i];
+            ids[i] = (uint32_t) GetIdFromLabel(label, labelIn);
+        }
+        fwriteOrDie(ids, f);
+    }
+    m_parser.mSentenceIndex2SentenceInfo.clear();
+    m_parser.ParseReset();
+
+    header.numSentences = sentenceBegins.size() - 1;
+    header.numTokens = sentenceBegins.back();
+    header.vocabularySize = labelIn.dim;
+    header.numClassEntries = idx4class.size();
+    if (header.numTokens % 2 != 0)
+    {
+        uint32_t padding = 0;
+        fwriteOrDie(&padding, sizeof(padding), 1, f);
+    }
+    fwriteOrDie(sentenceBegins, f);
+    fwriteOrDie(idx4class, f);
+
+    memcpy(header.magic, binaryCorpusMagic, sizeof(header.magic));
+    fsetpos(f, (uint64_t) 0);
+    fwriteOrDie(&header, sizeof(header), 1, f);
+    fcloseOrDie(f);
+    renameOrDie(tmpPath, binaryPath);
+    fprintf(stderr, " %d sequences, %d tokens.\n", (int) header.numSentences, (int) header.numTokens);
+}
+
+// OpenBinaryCorpus - memory-map a binary corpus file written by ConvertToBinaryCorpus() and validate it against the vocabulary
+template <class ElemType>
+void BatchSequenceReader<ElemType>::OpenBinaryCorpus(const wstring& binaryPath)
+{
+    m_binaryCorpus.reset(new MappedFile(binaryPath));
+    const char* data = m_binaryCorpus->Data();
+    const size_t size = m_binaryCorpus->Size();
+
+    BinaryCorpusHeader header;
+    if (size < sizeof(header) || memcmp(data, binaryCorpusMagic, sizeof(header.magic)) != 0)
+        RuntimeError("LMSequenceReader: '%ls' is not a complete binary corpus file; delete it to convert again.", binaryPath.c_str());
+    memcpy(&header, data, sizeof(header));
+
+    const size_t tokensOffset = sizeof(header);
+    const size_t sentencesOffset = tokensOffset + (size_t) (header.numTokens + header.numTokens % 2) * sizeof(uint32_t);
+    const size_t classesOffset = sentencesOffset + (size_t) (header.numSentences + 1) * sizeof(uint64_t);
+    if (size != classesOffset + (size_t) header.numClassEntries * sizeof(int32_t))
+        RuntimeError("LMSequenceReader: Binary corpus file '%ls' has an unexpected size; delete it to convert again.", binaryPath.c_str());
+
+    const LabelInfo& labelIn = m_labelInfo[labelInfoIn];
+    if (header.vocabularySize != labelIn.dim)
+        RuntimeError("LMSequenceReader: Binary corpus file '%ls' was converted for %d input labels, but %d are configured; delete it to convert again.",
+                     binaryPath.c_str(), (int) header.vocabularySize, (int) labelIn.dim);
+
+    // the word classes are stored so that a corpus converted with a different word-class file is detected
+    const int32_t* classes = (const int32_t*) (data + classesOffset);
+    if (idx4class.empty())
+    {
+        idx4class.assign(classes, classes + header.numClassEntries);
+        m_classSize = idx4class.empty() ? 0 : *max_element(idx4class.begin(), idx4class.end()) + 1;
+    }
+    else if (header.numClassEntries != idx4class.size() || !equal(idx4class.begin(), idx4class.end(), classes))
+        RuntimeError("LMSequenceReader: Binary corpus file '%ls' was converted with different word classes; delete it to convert again.", binaryPath.c_str());
+
+    m_binaryTokenIds = (const uint32_t*) (data + tokensOffset);
+    m_binarySentenceBegins = (const uint64_t*) (data + sentencesOffset);
+    m_binaryNumSentences = (size_t) header.numSentences;
+    m_binaryNextSentence = 0;
+    if (m_traceLevel > 0)
+        fprintf(stderr, "LMSequenceReader: Binary corpus file '%ls' with %d sequences, %d tokens.\n", binaryPath.c_str(), (int) header.numSentences, (int) header.numTokens);
+}
+
+// ReadBinaryCorpusBlock - binary-corpus counterpart of m_parser.Parse(): append the next cache block of sentences to mSentenceIndex2SentenceInfo
+// Like the text parser, it takes whole sentences until at least m_cacheBlockSize tokens are read. sBegin refers to m_binaryTokenIds[].
+// Returns the number of sentences read, 0 at the end of the corpus.
+template <class ElemType>
+size_t BatchSequenceReader<ElemType>::ReadBinaryCorpusBlock()
+{
+    size_t numRead = 0;
+    size_t numTokens = 0;
+    for (; numTokens < m_cacheBlockSize && m_binaryNextSentence < m_binaryNumSentences; m_binaryNextSentence++, numRead++)
+    {
+        SentenceInfo sentence;
+        sentence.sBegin = (size_t) m_binarySentenceBegins[m_binaryNextSentence];
+        sentence.sLen = (size_t) (m_binarySentenceBegins[m_binaryNextSentence + 1] - sentence.sBegin);
+        m_parser.mSentenceIndex2SentenceInfo.push_back(sentence);
+        numTokens += sentence.sLen;
+    }
+    return numRead;
+}
+
 // fill mToProcess[] with the next set of sequences of the same length
 // This function updates mToProcess[] (only, except it also lazily initializes mProcessed[]).
 // If mToProcess[] is not empty, then it will check whether those sequences are done, and if not, just return with mToProcess[] unchanged.
@@ -1785,7 +1943,10 @@ bool BatchSequenceReader<ElemType>::GetMinibatchData(size_t& /*out*/ firstPosInS
 
         std::vector<SequencePosition> seqPos;
         fprintf(stderr, "LMSequenceReader: Reading epoch data..."), fflush(stderr);
-        mNumRead = m_parser.Parse(m_cacheBlockSize, &m_labelTemp, &m_featureTemp, &seqPos);
+        if (m_binaryCorpus)
+            mNumRead = ReadBinaryCorpusBlock();
+        else
+            mNumRead = m_parser.Parse(m_cacheBlockSize, &m_labelTemp, &m_featureTemp, &seqPos);
         fprintf(stderr, " %d sequences read.\n", (int) mNumRead);
         firstPosInSentence = mLastPosInSentence;
         if (mNumRead == 0)
@@ -1830,6 +1991,17 @@ bool BatchSequenceReader<ElemType>::GetMinibatchData(size_t& /*out*/ firstPosInS
             size_t seq = mToProcess[k];
             size_t pos = m_parser.mSentenceIndex2SentenceInfo[seq].sBegin + i;
 
+            if (m_binaryCorpus)
+            {
+                // tokens were mapped to ids during conversion; the output label can only be the next word
+                m_featureData.push_back((float) m_binaryTokenIds[pos]);
+                if (labelOut.type != labelNone)
+                    m_labelIdData.push_back(m_binaryTokenIds[pos + 1]);
+                m_totalSamples++;
+                m_epochSamplesReturned++;
+                continue;
+            }
+
             // labelIn should be a category label
             const auto& labelValue = m_labelTemp[pos];
             pos++; // consume it
@@ -2129,9 +2301,9 @@ void BatchSequenceReader<ElemType>::GetLabelOutput(StreamMinibatchInputs& matric
         }
         else if (readerMode == ReaderMode::Class)
         {
-            int clsidx = idx4class[wrd];
             if (m_classSize > 0)
             {
+                int clsidx = idx4class[wrd];
                 labels.SetValue(1, j, (ElemType) clsidx);
 
                 // save the [begining ending_indx) of the class
@@ -12,10 +12,13 @@
 #include "Config.h"
 #include "SequenceParser.h"
 #include "RandomOrdering.h"
+#include "MappedFile.h"
 #include <string>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <random>
+#include <memory>
 
 namespace Microsoft { namespace MSR { namespace CNTK {
 
@@ -118,9 +121,9 @@ protected:
     bool m_idx2probRead;
 
 public:
-    map<string, int> word4idx;
+    unordered_map<string, int> word4idx; // hashed: looked up for every token read
     map<int, string> idx4word;
-    map<int, int> idx4class;
+    vector<int> idx4class;               // [word id] -> class id
     map<int, size_t> idx4cnt;
     int nwords, dims, nsamps, nglen, nmefeats;
     Matrix<ElemType>* m_id2classLocal;  // CPU version
@@ -197,7 +200,7 @@ protected:
     {
         LabelKind type; // labels are categories, create mapping table
         std::map<LabelIdType, LabelType> mapIdToLabel;
-        std::map<LabelType, LabelIdType> mapLabelToId;
+        std::unordered_map<LabelType, LabelIdType> mapLabelToId;
         LabelIdType numIds;        // maximum label ID we have encountered so far
         LabelIdType dim;           // maximum label ID we will ever see (used for array dimensions)
         std::string beginSequence; // starting sequence string (i.e. <s>)
@@ -238,9 +241,9 @@ public:
         InitFromConfig(config);
     }
     static void ReadClassInfo(const wstring& vocfile, int& classSize,
-                              map<string, int>& word4idx,
+                              unordered_map<string, int>& word4idx,
                               map<int, string>& idx4word,
-                              map<int, int>& idx4class,
+                              vector<int>& idx4class,
                               map<int, size_t>& idx4cnt,
                               int nwords,
                               string mUnk,
@@ -371,6 +374,13 @@ private:
     std::vector<ElemType> m_featureTemp;
     std::vector<LabelType> m_labelTemp;
 
+    // pre-tokenized binary corpus (config 'binaryFile'), used instead of m_parser/m_labelTemp if present
+    std::unique_ptr<MappedFile> m_binaryCorpus;
+    const uint32_t* m_binaryTokenIds;       // [token] input label id
+    const uint64_t* m_binarySentenceBegins; // [sentence] index of first token in m_binaryTokenIds; [numSentences] = numTokens
+    size_t m_binaryNumSentences;
+    size_t m_binaryNextSentence;            // first sentence of the next cache block
+
     bool mSentenceEnd;
     //bool mSentenceBegin;
 
@@ -387,6 +397,10 @@ public:
         mLastPosInSentence = 0;
         mNumRead = 0;
         mSentenceEnd = false;
+        m_binaryTokenIds = nullptr;
+        m_binarySentenceBegins = nullptr;
+        m_binaryNumSentences = 0;
+        m_binaryNextSentence = 0;
     }
 
     template <class ConfigRecordType>
@@ -403,6 +417,9 @@ private:
     void Reset();
     size_t DetermineSequencesToProcess();
     bool GetMinibatchData(size_t& firstPosInSentence);
+    void ConvertToBinaryCorpus(const wstring& binaryPath);
+    void OpenBinaryCorpus(const wstring& binaryPath);
+    size_t ReadBinaryCorpusBlock();
     void GetLabelOutput(StreamMinibatchInputs& matrices, size_t m_mbStartSample, size_t actualmbsize);
 
 public:
@@ -67,7 +67,7 @@ void LMSequenceWriter<ElemType>::InitFromConfig(const ConfigRecordType& writerCo
 
 template <class ElemType>
 void LMSequenceWriter<ElemType>::ReadLabelInfo(const wstring& vocfile,
-                                               map<string, int>& word4idx,
+                                               unordered_map<string, int>& word4idx,
                                                map<int, string>& idx4word)
 {
     char strFileName[MAX_STRING];
@@ -6,6 +6,7 @@
 #include "DataWriter.h"
 #include "SequenceParser.h"
 #include <stdio.h>
+#include <unordered_map>
 
 #define MAX_STRING 2048
 
@@ -22,9 +23,9 @@ private:
     std::vector<size_t> udims;
     int m_classSize;
     map<wstring, map<int, vector<int>>> class_words;
-    map<wstring, map<string, int>> word4idx;
+    map<wstring, unordered_map<string, int>> word4idx;
     map<wstring, map<int, string>> idx4word;
-    map<wstring, map<int, int>> idx4class;
+    map<wstring, vector<int>> idx4class;
     map<wstring, map<int, size_t>> idx4cnt;
     int nwords;
 
@@ -39,7 +40,7 @@ private:
     void Save(std::wstring& outputFile, const Matrix<ElemType>& outputData, const map<int, string>& idx2wrd, const int& nbest = 1);
 
     void ReadLabelInfo(const wstring& vocfile,
-                       map<string, int>& word4idx,
+                       unordered_map<string, int>& word4idx,
                        map<int, string>& idx4word);
 
 public:
@@ -6,6 +6,7 @@
 #include "SGD.h"
 #include "NonlinearityNodes.h"          // for DropoutNode
 #include "SpecialPurposeNodes.h"        // for SequenceWithSoftmaxNode
+#include "InputAndParamNodes.h"         // for LearnableParameter
 #include "DataReaderHelpers.h"
 #include "MatrixQuantizerImpl.h"
 #ifdef CNTK_PARALLEL_TRAINING_SUPPORT
@@ -569,6 +570,7 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
                     // roll back
                     auto bestModelPath = GetModelNameForEpoch(i - m_learnRateAdjustInterval);
                     LOGPRINTF(stderr, "Loading (rolling back to) previous model with best training-criterion value: %ls.\n", bestModelPath.c_str());
+                    WaitForCheckPointWriteOnAllNodes();
                     net->RereadPersistableParameters<ElemType>(bestModelPath);
                     LoadCheckPointInfo(i - m_learnRateAdjustInterval,
                                        /*out*/ totalTrainingSamplesSeen,
@@ -653,6 +655,7 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
             if (loadedPrevModel)
             {
                 // If previous best model is loaded, we will first remove epochs that lead to worse results
+                WaitForCheckPointWrite(); // (a background write must not recreate a file we delete here)
                 for (int j = 1; j < m_learnRateAdjustInterval; j++)
                 {
                     int epochToDelete = i - j;
@@ -710,6 +713,9 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
     }
     // --- END OF MAIN EPOCH LOOP
 
+    // the last checkpoint file must be complete when we return
+    WaitForCheckPointWrite();
+
     // Synchronize all ranks before proceeding to ensure that
     // rank 0 has finished writing the model file
     if (m_mpi != nullptr)
@@ -1306,17 +1312,47 @@ bool SGD<ElemType>::PreCompute(ComputationNetworkPtr net,
         LOGPRINTF(stderr, "\t%ls = %ls()\n", node->NodeName().c_str(), node->OperationName().c_str());
     }
 
+    // reuse the values of an earlier run on the same data if cached
+    let cachePath = GetPreComputeCachePath(nodes);
+    if (!cachePath.empty() && fexists(cachePath))
+    {
+        LOGPRINTF(stderr, "Precomputing --> Loading cached values from '%ls'.\n\n", cachePath.c_str());
+        File fstream(cachePath, FileOptions::fileOptionsBinary | FileOptions::fileOptionsRead);
+        fstream.GetMarker(FileMarker::fileMarkerBeginSection, L"BPreCompute");
+        size_t numNodes;
+        fstream >> numNodes;
+        if (numNodes != nodes.size())
+            RuntimeError("PreCompute: Cache file '%ls' has %d nodes, but %d were expected. Please delete it.", cachePath.c_str(), (int) numNodes, (int) nodes.size());
+        for (auto & node : nodes)
+        {
+            wstring nodeName;
+            fstream >> nodeName;
+            if (nodeName != node->NodeName())
+                RuntimeError("PreCompute: Cache file '%ls' has node '%ls' where '%ls' was expected. Please delete it.", cachePath.c_str(), nodeName.c_str(), node->NodeName().c_str());
+            dynamic_pointer_cast<IPreComputeNode>(node)->LoadPreComputedValue(fstream);
+        }
+        fstream.GetMarker(FileMarker::fileMarkerEndSection, L"EPreCompute");
+        return true;
+    }
+
     // compute
     ScopedNetworkOperationMode modeGuard(net, NetworkOperationMode::preComputing);
 
+    // In parallel training, each worker accumulates over its share of the data, and the accumulators are combined at the end.
+    // The share is either read by a distributed reader, or decimated from the full minibatches.
+    bool useParallelPreCompute = m_mpi != nullptr && m_mpi->NumNodesInUse() > 1 && GetParallelizationMethod() != ParallelizationMethod::none;
+    bool useDistributedMBReading = useParallelPreCompute && m_enableDistributedMBReading && trainSetDataReader->SupportsDistributedMBRead();
+
     // trainSetDataReader->StartMinibatchLoop(m_mbSize[0],  0 , requestDataSize);
     // trainSetDataReader->StartMinibatchLoop(m_mbSize[0],  0 , m_epochSize); // only based on one epoch
     // To support large dataset, we usually partition whole dataset into several epoch's,
     // so we need to use all the data to do precomputing
-    if (m_useAllDataForPreComputedNode) // using all the data
-        trainSetDataReader->StartMinibatchLoop(m_mbSize[0], 0);
-    else // using only one epoch. Note: One epoch is often enough for feature mean/stddev, but not for estimating priors.
-        trainSetDataReader->StartMinibatchLoop(m_mbSize[0], 0, m_epochSize);
+    size_t epochSize = m_useAllDataForPreComputedNode ? requestDataSize // using all the data
+                                                      : m_epochSize;    // using only one epoch. Note: One epoch is often enough for feature mean/stddev, but not for estimating priors.
+    if (useDistributedMBReading)
+        trainSetDataReader->StartDistributedMinibatchLoop(m_mbSize[0], 0, m_mpi->CurrentNodeRank(), m_mpi->NumNodesInUse(), epochSize);
+    else
+        trainSetDataReader->StartMinibatchLoop(m_mbSize[0], 0, epochSize);
     net->StartEvaluateMinibatchLoop(nodes);
 
     // initialize
@@ -1325,18 +1361,27 @@ bool SGD<ElemType>::PreCompute(ComputationNetworkPtr net,
 
     const size_t numIterationsBeforePrintingProgress = 100;
     size_t numItersSinceLastPrintOfProgress = 0;
-    size_t actualMBSizeDummy;
-    while (DataReaderHelpers::GetMinibatchIntoNetwork<ElemType>(*trainSetDataReader, net, nullptr, false, false, *inputMatrices, actualMBSizeDummy, m_mpi))
+    size_t actualMBSize;
+    while (DataReaderHelpers::GetMinibatchIntoNetwork<ElemType>(*trainSetDataReader, net, nullptr, useDistributedMBReading, useParallelPreCompute, *inputMatrices, actualMBSize, m_mpi))
     {
         // TODO: move these into GetMinibatchIntoNetwork()  --but those are passed around; necessary? Can't we get them from 'net'?
         ComputationNetwork::BumpEvalTimeStamp(featureNodes);
         ComputationNetwork::BumpEvalTimeStamp(labelNodes);
 
-        net->ForwardProp(nodes);
+        if (actualMBSize > 0) // (this worker's share may be empty)
+            net->ForwardProp(nodes);
 
         numItersSinceLastPrintOfProgress = ProgressTracing::TraceFakeProgress(numIterationsBeforePrintingProgress, numItersSinceLastPrintOfProgress);
     }
 
+    // combine the accumulators of all workers
+    if (useParallelPreCompute)
+    {
+        auto mpi = m_mpi;
+        for (auto & node : nodes)
+            dynamic_pointer_cast<IPreComputeNode>(node)->AggregateAccumulators([mpi](vector<double>& v) { mpi->AllReduce(v); });
+    }
+
     // finalize
     for (auto & node : nodes)
         dynamic_pointer_cast<IPreComputeNode>(node)->MarkComputed(true /*done accumulating*/);
@@ -1344,9 +1389,51 @@ bool SGD<ElemType>::PreCompute(ComputationNetworkPtr net,
     fprintf(stderr, "\n");
     LOGPRINTF(stderr, "Precomputing --> Completed.\n\n");
 
+    // only the main node writes the cache; readers never see a partial file since it is renamed into place
+    if (!cachePath.empty() && (m_mpi == nullptr || m_mpi->IsMainNode()))
+    {
+        msra::files::make_intermediate_dirs(cachePath);
+        let tmpPath = cachePath + L".tmp";
+        {
+            File fstream(tmpPath, FileOptions::fileOptionsBinary | FileOptions::fileOptionsWrite);
+            fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BPreCompute");
+            fstream << nodes.size();
+            for (auto & node : nodes)
+            {
+                fstream << node->NodeName();
+                dynamic_pointer_cast<IPreComputeNode>(node)->SavePreComputedValue(fstream);
+            }
+            fstream.PutMarker(FileMarker::fileMarkerEndSection, L"EPreCompute");
+        }
+        renameOrDie(tmpPath, cachePath);
+        LOGPRINTF(stderr, "Precomputing --> Cached values as '%ls'.\n\n", cachePath.c_str());
+    }
+
     return true;
 }
 
+// path of the cached values of the given PreCompute nodes, or empty if they are not to be cached
+// The key covers the training data, the amount of it used, and each node with its input and shape.
+template <class ElemType>
+wstring SGD<ElemType>::GetPreComputeCachePath(const std::list<ComputationNodeBasePtr>& nodes) const
+{
+    if (m_preComputeCacheDir.empty())
+        return wstring();
+    if (m_trainingDataDescription.empty())
+    {
+        LOGPRINTF(stderr, "Precomputing --> 'preComputeCacheDir' ignored since the training data is not known.\n");
+        return wstring();
+    }
+    wstring key = m_trainingDataDescription;
+    key += L"\n" + wstring(ElemTypeName<ElemType>());
+    key += L"\n" + (m_useAllDataForPreComputedNode ? wstring(L"all") : to_wstring(m_epochSize));
+    for (const auto & node : nodes)
+        key += L"\n" + node->NodeName() + L" = " + node->OperationName() + L"(" + node->Input(0)->NodeName() + L") " + msra::strfun::utf16(string(node->GetSampleLayout()));
+    uint64_t hash = FnvHashSeed;
+    FnvHashString(hash, key);
+    return msra::strfun::wstrprintf(L"%ls/precompute_%016llx.bin", m_preComputeCacheDir.c_str(), (unsigned long long) hash);
+}
+
 // return a reasonable initial learning rate based on the initial mbsize
 template <class ElemType>
 double SGD<ElemType>::SearchForBestLearnRate(ComputationNetworkPtr net,
@@ -1383,6 +1470,7 @@ double SGD<ElemType>::SearchForBestLearnRate(ComputationNetworkPtr net,
     }
 
     int baseModelEpoch = epochNumber - 1;
+    WaitForCheckPointWriteOnAllNodes();
     net->RereadPersistableParameters<ElemType>(GetModelNameForEpoch(baseModelEpoch));
 
     double learnRate = learnRatePerSample;
@@ -1395,6 +1483,7 @@ double SGD<ElemType>::SearchForBestLearnRate(ComputationNetworkPtr net,
                        smoothedGradients,
                        /*out*/ prevCriterion,
                        /*out*/ dummyMinibatchSize);
+    SaveTrialStartState(net, smoothedGradients);
 
     // if model is not changed this is what we will get
     EpochCriterion baseCriterion;
@@ -1499,6 +1588,8 @@ double SGD<ElemType>::SearchForBestLearnRate(ComputationNetworkPtr net,
         bestLearnRatePerSample = (leftCriterion.Average() < rightCriterion.Average()) ? leftLearnRatePerSample : rightLearnRatePerSample;
     }
 
+    m_trialStartState.reset();
+
     LOGPRINTF(stderr, "Best Learn Rate Per Sample for Epoch[%d] = %.10g  baseCriterion=%.10g\n",
               epochNumber + 1, bestLearnRatePerSample, baseCriterion.Average());
 
@@ -1646,6 +1737,7 @@ size_t SGD<ElemType>::SearchForBestMinibatchSize(ComputationNetworkPtr net,
 
     size_t lastTriedTrialMinibatchSize = 0;
     EpochCriterion lastTriedTrialEpochCriterion(0);
+    SaveTrialStartState(net, smoothedGradients);
     for (float trialMinibatchSizeFloat = (float) minMinibatchSize;
          trialMinibatchSizeFloat <= maxMinibatchSize;
          trialMinibatchSizeFloat *= minibatchSizeTuningFactor)
@@ -1702,6 +1794,7 @@ size_t SGD<ElemType>::SearchForBestMinibatchSize(ComputationNetworkPtr net,
             }
         }
     }
+    m_trialStartState.reset();
     LOGPRINTF(stderr, "AdaptiveMinibatchSearch: Search successful. New minibatchSize is %d. epochCriterion = %.8f vs baseCriterion = %.8f\n\n",
               (int) lastTriedTrialMinibatchSize, lastTriedTrialEpochCriterion.Average(), baseCriterion.Average());
 
@@ -1741,7 +1834,14 @@ void SGD<ElemType>::TrainOneMiniEpochAndReloadModel(ComputationNetworkPtr net,
     fprintf(stderr, "learningRatePerSample = %.8g\n", learnRatePerSample);
 
     // go back to where we came from
+    if (m_trialStartState)
+    {
+        RestoreTrialStartState(smoothedGradients);
+        return;
+    }
+
     int baseModelEpoch = epochNumber - 1;
+    WaitForCheckPointWriteOnAllNodes();
     net->RereadPersistableParameters<ElemType>(GetModelNameForEpoch(baseModelEpoch));
 
     double dummyLearnRate;
@@ -1756,6 +1856,59 @@ void SGD<ElemType>::TrainOneMiniEpochAndReloadModel(ComputationNetworkPtr net,
                        /*out*/ dummyMinibatchSize);
 }
 
+// remember the parameters and smoothed gradients before a series of trial mini-epochs, if 'searchTrialsInMemory' is set
+// All parameter nodes are kept, not only those being learned, since e.g. batch-normalization statistics are updated during training as well.
+// With model averaging, the helper's state is only restored from the checkpoint file, so we keep rereading that instead; likewise for sparse matrices.
+template <class ElemType>
+void SGD<ElemType>::SaveTrialStartState(ComputationNetworkPtr net, const std::list<Matrix<ElemType>>& smoothedGradients)
+{
+    m_trialStartState.reset();
+    if (!m_searchTrialsInMemory || m_pMASGDHelper)
+        return;
+
+    auto copyToCPU = [](const Matrix<ElemType>& m)
+    {
+        std::vector<ElemType> values(m.GetNumElements());
+        if (!values.empty())
+        {
+            ElemType* data = m.CopyToArray();
+            std::copy(data, data + values.size(), values.begin());
+            delete[] data;
+        }
+        return values;
+    };
+    std::unique_ptr<TrialStartState> state(new TrialStartState());
+    for (const auto& node : net->GetNodesWithType(OperationNameOf(LearnableParameter)))
+    {
+        auto parameter = dynamic_pointer_cast<ComputationNode<ElemType>>(node);
+        if (parameter->Value().GetMatrixType() != MatrixType::DENSE)
+            return;
+        state->parameters.emplace_back(parameter, copyToCPU(parameter->Value()));
+    }
+    for (const auto& smoothedGradient : smoothedGradients)
+    {
+        if (smoothedGradient.GetMatrixType() != MatrixType::DENSE)
+            return;
+        state->smoothedGradients.push_back(copyToCPU(smoothedGradient));
+    }
+    m_trialStartState = std::move(state);
+}
+
+template <class ElemType>
+void SGD<ElemType>::RestoreTrialStartState(std::list<Matrix<ElemType>>& smoothedGradients)
+{
+    // (training does not change the dimensions, so the matrices still have those of the copies)
+    for (auto& parameter : m_trialStartState->parameters)
+    {
+        auto& value = parameter.first->Value();
+        value.SetValue(value.GetNumRows(), value.GetNumCols(), value.GetDeviceId(), parameter.second.data());
+        parameter.first->BumpEvalTimeStamp();
+    }
+    auto savedSmoothedGradient = m_trialStartState->smoothedGradients.begin();
+    for (auto& smoothedGradient : smoothedGradients)
+        smoothedGradient.SetValue(smoothedGradient.GetNumRows(), smoothedGradient.GetNumCols(), smoothedGradient.GetDeviceId(), (savedSmoothedGradient++)->data());
+}
+
 // Attemps to compute the error signal for the whole utterance, which will
 // be fed to the neural network as features. Currently it is a workaround
 // for the two-forward-pass sequence and ctc training, which allows
@@ -1993,45 +2146,104 @@ void SGD<ElemType>::SaveCheckPointInfo(const size_t epoch, const size_t totalSam
     if ((m_mpi == nullptr) || m_mpi->IsMainNode())
     {
         wstring checkPointFileName = GetCheckPointFileNameForEpoch(int(epoch));
-        // Saving into temporary file and then renaming it to the checkPointFileName
-        // This is a standard trick to avoid havign corrupted checkpoints files if process dies during writing
-        wstring tempFileName = checkPointFileName + L".tmp";
 
+        // only one checkpoint write may be in flight
+        WaitForCheckPointWrite();
+
+        // With asyncCheckPoint, we take a snapshot of the smoothed gradients in CPU memory, which is the only part
+        // that must be done before training continues and modifies them, and write the file on a background thread.
+        // The model-averaging state is serialized by m_pMASGDHelper straight from its live buffers, so that case stays synchronous.
+        bool canWriteAsync = m_asyncCheckPoint && !m_pMASGDHelper;
+        for (const auto& smoothedGradient : smoothedGradients)
+            canWriteAsync &= (smoothedGradient.GetMatrixType() == DENSE);
+
+        if (canWriteAsync)
         {
-            File fstream(tempFileName, FileOptions::fileOptionsBinary | FileOptions::fileOptionsWrite);
-            fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BVersion"); 
-            fstream << (size_t)CURRENT_CNTK_CHECKPOINT_VERSION; 
-            fstream.PutMarker(FileMarker::fileMarkerEndSection, L"EVersion");
+            auto snapshot = make_shared<std::list<Matrix<ElemType>>>();
+            for (const auto& smoothedGradient : smoothedGradients)
+            {
+                snapshot->emplace_back(smoothedGradient.GetNumRows(), smoothedGradient.GetNumCols(), CPUDEVICE);
+                ElemType* data = snapshot->back().Data();
+                size_t size = snapshot->back().GetNumElements();
+                if (size > 0)
+                    smoothedGradient.CopyToArray(data, size);
+            }
+            m_checkPointWriter = std::async(std::launch::async, [=]()
+            {
+                WriteCheckPointFile(checkPointFileName, totalSamplesSeen, learnRatePerSample, *snapshot, prevCriterion, minibatchSize, /*commitToDisk=*/true);
+            });
+        }
+        else
+            WriteCheckPointFile(checkPointFileName, totalSamplesSeen, learnRatePerSample, smoothedGradients, prevCriterion, minibatchSize, /*commitToDisk=*/false);
+    }
+}
 
-            fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BCKP");
-            fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BLearnRate");
-            fstream << totalSamplesSeen << learnRatePerSample << prevCriterion;
-            fstream.PutMarker(FileMarker::fileMarkerEndSection, L"ELearnRate");
+// write the checkpoint file; if 'commitToDisk' then it is fsync'ed before it replaces a previous file of the same name
+template <class ElemType>
+void SGD<ElemType>::WriteCheckPointFile(const wstring& checkPointFileName, const size_t totalSamplesSeen,
+                                        const double learnRatePerSample,
+                                        const std::list<Matrix<ElemType>>& smoothedGradients,
+                                        const double prevCriterion,
+                                        const size_t minibatchSize,
+                                        const bool commitToDisk)
+{
+    // Saving into temporary file and then renaming it to the checkPointFileName
+    // This is a standard trick to avoid havign corrupted checkpoints files if process dies during writing
+    wstring tempFileName = checkPointFileName + L".tmp";
 
-            fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BMinibatchSize");
-            fstream << minibatchSize;
-            fstream.PutMarker(FileMarker::fileMarkerEndSection, L"EMinibatchSize");
+    {
+        File fstream(tempFileName, FileOptions::fileOptionsBinary | FileOptions::fileOptionsWrite | (commitToDisk ? FileOptions::fileOptionsSync : 0));
+        fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BVersion"); 
+        fstream << (size_t)CURRENT_CNTK_CHECKPOINT_VERSION; 
+        fstream.PutMarker(FileMarker::fileMarkerEndSection, L"EVersion");
 
-            fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BGradient");
+        fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BCKP");
+        fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BLearnRate");
+        fstream << totalSamplesSeen << learnRatePerSample << prevCriterion;
+        fstream.PutMarker(FileMarker::fileMarkerEndSection, L"ELearnRate");
 
-            for (auto smoothedGradientIter = smoothedGradients.begin(); smoothedGradientIter != smoothedGradients.end(); smoothedGradientIter++)
-            {
-                const Matrix<ElemType>& smoothedGradient = *smoothedGradientIter;
-                fstream << smoothedGradient;
-            }
+        fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BMinibatchSize");
+        fstream << minibatchSize;
+        fstream.PutMarker(FileMarker::fileMarkerEndSection, L"EMinibatchSize");
 
-            fstream.PutMarker(FileMarker::fileMarkerEndSection, L"EGradient");
+        fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BGradient");
 
-            fstream.PutMarker(FileMarker::fileMarkerEndSection, L"ECKP");
-            if (m_pMASGDHelper)
-                m_pMASGDHelper->SaveToCheckPoint(fstream);
-            // Ensuring that data is written
-            fstream.Flush();
+        for (auto smoothedGradientIter = smoothedGradients.begin(); smoothedGradientIter != smoothedGradients.end(); smoothedGradientIter++)
+        {
+            const Matrix<ElemType>& smoothedGradient = *smoothedGradientIter;
+            fstream << smoothedGradient;
         }
 
-        _wunlink(checkPointFileName.c_str());
-        renameOrDie(tempFileName, checkPointFileName);
+        fstream.PutMarker(FileMarker::fileMarkerEndSection, L"EGradient");
+
+        fstream.PutMarker(FileMarker::fileMarkerEndSection, L"ECKP");
+        if (m_pMASGDHelper)
+            m_pMASGDHelper->SaveToCheckPoint(fstream);
+        // Ensuring that data is written
+        fstream.Flush();
     }
+
+    _wunlink(checkPointFileName.c_str());
+    renameOrDie(tempFileName, checkPointFileName);
+}
+
+// wait for a background checkpoint write to complete; rethrows its error, if any
+template <class ElemType>
+void SGD<ElemType>::WaitForCheckPointWrite()
+{
+    if (m_checkPointWriter.valid())
+        m_checkPointWriter.get();
+}
+
+// wait until the model and checkpoint files of the main node are in place, before any node rereads them
+// Only the main node writes them, possibly in the background (asyncCheckPoint), so under MPI the other nodes must wait for it.
+// This is a barrier under MPI, so all nodes must call it.
+template <class ElemType>
+void SGD<ElemType>::WaitForCheckPointWriteOnAllNodes()
+{
+    WaitForCheckPointWrite();
+    if (m_mpi != nullptr)
+        m_mpi->WaitAll();
 }
 
 template <class ElemType>
@@ -2042,6 +2254,8 @@ bool SGD<ElemType>::TryLoadCheckPointInfo(const size_t epochNumber,
                                           /*out*/ double& prevCriterion,
                                           /*out*/ size_t& minibatchSize)
 {
+    WaitForCheckPointWriteOnAllNodes(); // the file may still be being written
+
     // gracefully handle if a checkpoint file is missing
     // This means a user wanted to continue training from an older model, but that model had no checkpoint info anymore.
     // This is valid, we just don't get the features that require previous models, such as LR or MBSize control.
@@ -2070,6 +2284,8 @@ void SGD<ElemType>::LoadCheckPointInfo(const size_t epochNumber,
                                        /*out*/ double& prevCriterion,
                                        /*out*/ size_t& minibatchSize)
 {
+    WaitForCheckPointWrite();
+
     let checkPointFileName = GetCheckPointFileNameForEpoch(int(epochNumber));
     File fstream(checkPointFileName,
                  FileOptions::fileOptionsBinary | FileOptions::fileOptionsRead);
@@ -2477,6 +2693,10 @@ SGDParams::SGDParams(const ConfigRecordType& configSGD, size_t sizeofElemType)
     }
 
     m_useAllDataForPreComputedNode = configSGD(L"UseAllDataForPreComputedNode", true);
+    m_preComputeCacheDir = (const wstring&) configSGD(L"preComputeCacheDir", L"");
+    // The cache is keyed by the text of the reader config, which BrainScript does not retain (see DoTrain()).
+    if (!m_preComputeCacheDir.empty() && std::is_same<ConfigRecordType, ScriptableObjects::IConfigRecord>::value)
+        LOGPRINTF(stderr, "'preComputeCacheDir' is ignored: precomputed values are never cached when training is configured with BrainScript.\n");
 
     // consistency checks
     for (size_t i = 0; i < m_mbSize.size(); i++)
@@ -17,6 +17,7 @@
 #include "Config.h"
 #include <chrono>
 #include <random>
+#include <future>
 #include "Profiler.h"
 #include "MASGD.h"
 
@@ -245,6 +246,7 @@ protected:
     bool m_doUnitTest;
 
     bool m_useAllDataForPreComputedNode;
+    std::wstring m_preComputeCacheDir; // if given, precomputed values are stored here and reused by later runs on the same data
 
     // Parallel training
     MPIWrapperPtr m_mpi;
@@ -310,6 +312,8 @@ public:
           // TODO: The next few do not belong into SGD any more than the network or reader we operate on. Either move network and reader in here, or move these out.
           m_modelPath((const wstring&) configSGD(L"modelPath")),
           m_keepCheckPointFiles(configSGD(L"keepCheckPointFiles", false)),
+          m_asyncCheckPoint(configSGD(L"asyncCheckPoint", false)),
+          m_searchTrialsInMemory(configSGD(L"searchTrialsInMemory", false)),
           m_trainCriterionNodeName((const wstring&) configSGD(L"trainCriterionNodeName", L"")),
           m_evalCriterionNodeName ((const wstring&) configSGD(L"evalCriterionNodeName", L"")),
           m_traceNodeNamesReal    (configSGD(L"traceNodeNamesReal",     ConfigRecordType::Array(stringargvector()))),
@@ -345,6 +349,13 @@ public:
         }
     }
 
+    // description of the training data (e.g. the reader config and the size and time of its files), which keys the cache in 'preComputeCacheDir'
+    // Without it, precomputed values are not cached, since they could not be told apart from those of other data.
+    void SetTrainingDataDescription(const wstring& description)
+    {
+        m_trainingDataDescription = description;
+    }
+
     void Train(function<ComputationNetworkPtr(DEVICEID_TYPE)> createNetworkFn, DEVICEID_TYPE deviceId,
                IDataReader* trainSetDataReader,
                IDataReader* validationSetDataReader,
@@ -374,6 +385,7 @@ protected:
                     const std::vector<ComputationNodeBasePtr>& featureNodes,
                     const std::vector<ComputationNodeBasePtr>& labelNodes,
                     StreamMinibatchInputs* inputMatrices);
+    std::wstring GetPreComputeCachePath(const std::list<ComputationNodeBasePtr>& nodes) const;
 
     // return a reasonable initial learning rate based on the initial mbsize
     double SearchForBestLearnRate(ComputationNetworkPtr net,
@@ -408,6 +420,9 @@ protected:
                                          /*out*/ std::vector<EpochCriterion>& epochEvalErrors,
                                          std::string prefixMsg = "");
 
+    void SaveTrialStartState(ComputationNetworkPtr net, const std::list<Matrix<ElemType>>& smoothedGradients);
+    void RestoreTrialStartState(std::list<Matrix<ElemType>>& smoothedGradients);
+
     size_t AdaptiveMinibatchSizing(ComputationNetworkPtr net,
                                    ComputationNetworkPtr refNet,
                                    const ComputationNodeBasePtr& refNode,
@@ -519,6 +534,15 @@ protected:
                             /*out*/ double& prevCriterion,
                             /*out*/ size_t& minibatchSize);
 
+    void WriteCheckPointFile(const wstring& checkPointFileName, const size_t totalSamplesSeen,
+                             const double learnRatePerSample,
+                             const std::list<Matrix<ElemType>>& smoothedGradients,
+                             const double prevCriterion,
+                             const size_t minibatchSize,
+                             const bool commitToDisk);
+    void WaitForCheckPointWrite();
+    void WaitForCheckPointWriteOnAllNodes();
+
     wstring GetCheckPointFileNameForEpoch(const int epoch);
     wstring GetModelNameForEpoch(const int epoch, bool bLastModel = false);
 
@@ -545,9 +569,13 @@ public:
 protected:
     std::wstring m_modelPath;
     bool m_keepCheckPointFiles;
+    bool m_asyncCheckPoint;                // write checkpoint files on a background thread while training continues
+    bool m_searchTrialsInMemory;           // LR and minibatch-size search: restore the trials' starting point from a copy in CPU memory rather than from disk
+    std::future<void> m_checkPointWriter;  // pending background checkpoint write, if any (its destructor waits for it)
 
     std::wstring m_trainCriterionNodeName;
     std::wstring m_evalCriterionNodeName;
+    std::wstring m_trainingDataDescription;
 
     // enable tracing. Nodes listed here get their m_traceNodeValueXXX flags set
     std::vector<std::wstring> m_traceNodeNamesReal;
@@ -562,6 +590,16 @@ protected:
 
     shared_ptr<IMASGD<ElemType>> m_pMASGDHelper;
 
+    // copy in CPU memory of the model parameters and smoothed gradients that the LR and minibatch-size searches start from ('searchTrialsInMemory')
+    // If set, TrainOneMiniEpochAndReloadModel() goes back to it after each trial instead of rereading the model and checkpoint from disk.
+    // It is kept in CPU memory, so that it does not compete with training for GPU memory.
+    struct TrialStartState
+    {
+        std::vector<std::pair<ComputationNodePtr, std::vector<ElemType>>> parameters;
+        std::vector<std::vector<ElemType>> smoothedGradients;
+    };
+    std::unique_ptr<TrialStartState> m_trialStartState;
+
 private:
     void InitializeAndCheckBlockMomentumSGDParameters();
     void MarkDropoutNodesEvalTimeStampAsOutdated(const ComputationNetworkPtr& net, const ComputationNodeBasePtr& criterionNode);
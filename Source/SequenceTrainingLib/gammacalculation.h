@@ -8,6 +8,7 @@
 #include "Matrix.h"
 #include "CUDAPageLockedMemAllocator.h"
 
+#include <exception>
 #include <memory>
 #include <vector>
 
@@ -100,7 +101,6 @@ public:
     {
         // check total frame number to be added ?
         // int deviceid = loglikelihood.GetDeviceId();
-        size_t boundaryframenum;
         std::vector<size_t> validframes; // [s] cursor pointing to next utterance begin within a single parallel sequence [s]
         validframes.assign(samplesInRecurrentStep, 0);
         ElemType objectValue = 0.0;
@@ -126,15 +126,19 @@ public:
             assert(T == pMBLayout->GetNumTimeSteps());
         }
 
-        size_t mapi = 0; // parallel-sequence index for utterance [i]
-        // cal gamma for each utterance
-        size_t ts = 0;
-        for (size_t i = 0; i < lattices.size(); i++)
+        // The computation is split into three phases per utterance: copying its logLLs into 'pred', the lattice forward-backward
+        // into 'dengammas', and copying the gammas back. On the GPU, 'parallellattice' holds the state of one utterance at a time,
+        // so the phases run interleaved. On the CPU, the forward-backward of each lattice only reads its own stripe of 'pred'
+        // and writes its own stripe of 'dengammas', so all lattices of the minibatch are processed in parallel.
+        std::vector<UtteranceInfo> utts(lattices.size());
+        auto prepare = [&](size_t i, size_t ts)
         {
-            const size_t numframes = lattices[i]->getnumframes();
+            auto& utt = utts[i];
+            utt.ts = ts;
+            utt.numframes = lattices[i]->getnumframes();
+            const size_t numframes = utt.numframes;
 
-            msra::dbn::matrixstripe predstripe(pred, ts, numframes);           // logLLs for this utterance
-            msra::dbn::matrixstripe dengammasstripe(dengammas, ts, numframes); // denominator gammas
+            msra::dbn::matrixstripe predstripe(pred, ts, numframes); // logLLs for this utterance
 
             if (samplesInRecurrentStep == 1) // no sequence parallelism
             {
@@ -150,7 +154,9 @@ public:
             else // multiple parallel sequences
             {
                 // get number of frames for the utterance
-                mapi = extrauttmap[i]; // parallel-sequence index; in case of >1 utterance within this parallel sequence, this is in order of concatenation
+                const size_t mapi = extrauttmap[i]; // parallel-sequence index; in case of >1 utterance within this parallel sequence, this is in order of concatenation
+                utt.mapi = mapi;
+                utt.firstframe = validframes[mapi];
 
                 // scan MBLayout for end of utterance
                 size_t mapframenum = SIZE_MAX; // duration of utterance [i] as determined from MBLayout
@@ -184,16 +190,21 @@ public:
                 {
                     parallellattice.setloglls(tempmatrix);
                 }
+                validframes[mapi] += numframes; // advance the cursor within the parallel sequence
             }
+        };
 
-            array_ref<size_t> uidsstripe(&uids[ts], numframes);
+        auto forwardbackward = [&](size_t i)
+        {
+            auto& utt = utts[i];
+            const size_t ts = utt.ts;
+            const size_t numframes = utt.numframes;
 
-            if (doreferencealign)
-            {
-                boundaryframenum = numframes;
-            }
-            else
-                boundaryframenum = 0;
+            msra::dbn::matrixstripe predstripe(pred, ts, numframes);           // logLLs for this utterance
+            msra::dbn::matrixstripe dengammasstripe(dengammas, ts, numframes); // denominator gammas
+
+            array_ref<size_t> uidsstripe(&uids[ts], numframes);
+            const size_t boundaryframenum = doreferencealign ? numframes : 0;
             array_ref<size_t> boundariesstripe(&boundaries[ts], boundaryframenum);
 
             double numavlogp = 0;
@@ -203,13 +214,23 @@ public:
                 numavlogp += predstripe(s, t) / amf;
             }
             numavlogp /= numframes;
+            utt.numavlogp = numavlogp;
 
             // auto_timer dengammatimer;
-            double denavlogp = lattices[i]->second.forwardbackward(parallellattice,
-                                                                   (const msra::math::ssematrixbase&) predstripe, (const msra::asr::simplesenonehmm&) m_hset,
-                                                                   (msra::math::ssematrixbase&) dengammasstripe, (msra::math::ssematrixbase&) gammasbuffer /*empty, not used*/,
-                                                                   lmf, wp, amf, boostmmifactor, seqsMBRmode, uidsstripe, boundariesstripe);
-            objectValue += (ElemType)((numavlogp - denavlogp) * numframes);
+            utt.denavlogp = lattices[i]->second.forwardbackward(parallellattice,
+                                                                (const msra::math::ssematrixbase&) predstripe, (const msra::asr::simplesenonehmm&) m_hset,
+                                                                (msra::math::ssematrixbase&) dengammasstripe, (msra::math::ssematrixbase&) gammasbuffer /*empty, not used*/,
+                                                                lmf, wp, amf, boostmmifactor, seqsMBRmode, uidsstripe, boundariesstripe);
+        };
+
+        auto finish = [&](size_t i)
+        {
+            const auto& utt = utts[i];
+            const size_t ts = utt.ts;
+            const size_t numframes = utt.numframes;
+            const size_t mapi = utt.mapi;
+
+            objectValue += (ElemType)((utt.numavlogp - utt.denavlogp) * numframes);
 
             if (samplesInRecurrentStep == 1)
             {
@@ -219,7 +240,8 @@ public:
             // copy gamma to tempmatrix
             if (m_deviceid == CPUDEVICE)
             {
-                CopyFromSSEMatrixToCNTKMatrix(dengammas, numrows, numframes, tempmatrix, gammafromlattice.GetDeviceId());
+                msra::dbn::matrixstripe dengammasstripe(dengammas, ts, numframes);
+                CopyFromSSEMatrixToCNTKMatrix(dengammasstripe, numrows, numframes, tempmatrix, gammafromlattice.GetDeviceId());
             }
             else
                 parallellattice.getgamma(tempmatrix);
@@ -227,7 +249,7 @@ public:
             // set gamma for multi channel
             if (samplesInRecurrentStep > 1)
             {
-                Microsoft::MSR::CNTK::Matrix<ElemType> gammaFromLatticeForCurrentParallelUtterance = gammafromlattice.ColumnSlice(mapi + (validframes[mapi] * samplesInRecurrentStep), ((numframes - 1) * samplesInRecurrentStep) + 1);
+                Microsoft::MSR::CNTK::Matrix<ElemType> gammaFromLatticeForCurrentParallelUtterance = gammafromlattice.ColumnSlice(mapi + (utt.firstframe * samplesInRecurrentStep), ((numframes - 1) * samplesInRecurrentStep) + 1);
                 gammaFromLatticeForCurrentParallelUtterance.CopyColumnsStrided(tempmatrix, numframes, 1, samplesInRecurrentStep);
             }
 
@@ -235,22 +257,74 @@ public:
             {
                 for (size_t nframe = 0; nframe < numframes; nframe++)
                 {
-                    size_t uid = uidsstripe[nframe];
+                    size_t uid = uids[ts + nframe];
                     if (samplesInRecurrentStep > 1)
-                        labels(uid, (nframe + validframes[mapi]) * samplesInRecurrentStep + mapi) = 1.0;
+                        labels(uid, (nframe + utt.firstframe) * samplesInRecurrentStep + mapi) = 1.0;
                     else
                         labels(uid, ts + nframe) = 1.0;
                 }
             }
-            if (samplesInRecurrentStep > 1)
-                validframes[mapi] += numframes; // advance the cursor within the parallel sequence
-            fprintf(stderr, "dengamma value %f\n", denavlogp);
-            ts += numframes;
+            fprintf(stderr, "dengamma value %f\n", utt.denavlogp);
+        };
+
+        // cal gamma for each utterance
+        if (m_deviceid != CPUDEVICE)
+        {
+            size_t ts = 0;
+            for (size_t i = 0; i < lattices.size(); i++)
+            {
+                prepare(i, ts);
+                forwardbackward(i);
+                finish(i);
+                ts += utts[i].numframes;
+            }
+        }
+        else
+        {
+            size_t ts = 0;
+            for (size_t i = 0; i < lattices.size(); i++)
+            {
+                prepare(i, ts);
+                ts += utts[i].numframes;
+            }
+
+            // exceptions must not escape the parallel region; the first one is rethrown afterwards
+            std::exception_ptr error;
+#pragma omp parallel for schedule(dynamic)
+            for (int i = 0; i < (int) lattices.size(); i++)
+            {
+                try
+                {
+                    forwardbackward(i);
+                }
+                catch (...)
+                {
+#pragma omp critical
+                    if (!error)
+                        error = std::current_exception();
+                }
+            }
+            if (error)
+                std::rethrow_exception(error);
+
+            for (size_t i = 0; i < lattices.size(); i++)
+                finish(i);
         }
         functionValues.SetValue(objectValue);
     }
 
 private:
+    // where an utterance of the minibatch lives, and its partial results
+    struct UtteranceInfo
+    {
+        size_t ts = 0;         // first column in 'pred' and 'dengammas'
+        size_t numframes = 0;
+        size_t mapi = 0;       // parallel-sequence index
+        size_t firstframe = 0; // first time step within that parallel sequence
+        double numavlogp = 0;
+        double denavlogp = 0;
+    };
+
     // Helper methods for copying between ssematrix objects and CNTK matrices
     void CopyFromCNTKMatrixToSSEMatrix(const Microsoft::MSR::CNTK::Matrix<ElemType>& src, size_t numCols, msra::math::ssematrixbase& dest)
     {
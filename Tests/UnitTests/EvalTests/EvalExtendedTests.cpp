@@ -5,6 +5,8 @@
 
 #include "stdafx.h"
 #include "EvalTestHelper.h"
+#include "../../../Source/Extensibility/EvalServer/EvalServer.h"
+#include <thread>
 
 using namespace Microsoft::MSR::CNTK;
 
@@ -273,5 +275,303 @@ BOOST_AUTO_TEST_CASE(EvalSparseTimesTest)
     eval->Destroy();
 }
 
+BOOST_AUTO_TEST_CASE(EvalBatchedDenseTimesTest)
+{
+    std::string modelDefinition =
+        "deviceId = -1 \n"
+        "precision = \"float\" \n"
+        "traceLevel = 1 \n"
+        "run=NDLNetworkBuilder \n"
+        "NDLNetworkBuilder=[ \n"
+        "i1 = Input(2) \n"
+        "o1 = Times(Constant(2, rows=1, cols=2), i1, tag=\"output\") \n"
+        "FeatureNodes = (i1) \n"
+        "] \n";
+
+    VariableSchema inputLayouts;
+    VariableSchema outputLayouts;
+    IEvaluateModelExtended<float> *eval;
+    eval = SetupNetworkAndGetLayouts(modelDefinition, inputLayouts, outputLayouts);
+
+    // Three sequences of different lengths, evaluated in one forward pass
+    std::vector<Values<float>> inputBuffers(3, Values<float>(1));
+    inputBuffers[0][0].m_buffer = { 1, 2 };
+    inputBuffers[1][0].m_buffer = { 1, 2, 3, 4, 5, 6 };
+    inputBuffers[2][0].m_buffer = { 0, 1, 2, 3 };
+
+    // Note: copying a Values would not preserve the reserved capacity, so every sequence gets its own buffers
+    std::vector<Values<float>> outputBuffers;
+    outputBuffers.push_back(outputLayouts.CreateBuffers<float>({ 3 }));
+    outputBuffers.push_back(outputLayouts.CreateBuffers<float>({ 3 }));
+    BOOST_REQUIRE_THROW(eval->ForwardPass(inputBuffers, outputBuffers), std::exception); // Not enough output buffers
+
+    outputBuffers.push_back(outputLayouts.CreateBuffers<float>({ 3 }));
+    eval->ForwardPass(inputBuffers, outputBuffers);
+
+    std::vector<std::vector<float>> expected{ { 6 }, { 6, 14, 22 }, { 2, 10 } };
+    for (size_t k = 0; k < expected.size(); ++k)
+    {
+        auto buf = outputBuffers[k][0].m_buffer;
+        BOOST_CHECK_EQUAL_COLLECTIONS(buf.begin(), buf.end(), expected[k].begin(), expected[k].end());
+    }
+
+    eval->Destroy();
+}
+
+BOOST_AUTO_TEST_CASE(EvalBatchedSparseTimesTest)
+{
+    std::string modelDefinition =
+        "deviceId = -1 \n"
+        "precision = \"float\" \n"
+        "traceLevel = 1 \n"
+        "run=NDLNetworkBuilder \n"
+        "NDLNetworkBuilder=[ \n"
+        "i1 = SparseInput(3) \n"
+        "o1 = Times(Constant(2, rows=1, cols=3), i1, tag=\"output\") \n"
+        "FeatureNodes = (i1) \n"
+        "] \n";
+
+    VariableSchema inputLayouts;
+    VariableSchema outputLayouts;
+    IEvaluateModelExtended<float> *eval;
+    eval = SetupNetworkAndGetLayouts(modelDefinition, inputLayouts, outputLayouts);
+
+    std::vector<Values<float>> inputBuffers(2, Values<float>(1));
+    inputBuffers[0][0].m_buffer = { 1, 2, 3, 5, 6 };
+    inputBuffers[0][0].m_indices = { 0, 2, 2, 1, 2 };
+    inputBuffers[0][0].m_colIndices = { 0, 2, 2, 5 };
+    inputBuffers[1][0].m_buffer = { 4 };
+    inputBuffers[1][0].m_indices = { 1 };
+    inputBuffers[1][0].m_colIndices = { 0, 1 };
+
+    std::vector<Values<float>> outputBuffers;
+    outputBuffers.push_back(outputLayouts.CreateBuffers<float>({ 3 }));
+    outputBuffers.push_back(outputLayouts.CreateBuffers<float>({ 1 }));
+    eval->ForwardPass(inputBuffers, outputBuffers);
+
+    std::vector<std::vector<float>> expected{ { 6, 0, 28 }, { 8 } };
+    for (size_t k = 0; k < expected.size(); ++k)
+    {
+        auto buf = outputBuffers[k][0].m_buffer;
+        BOOST_CHECK_EQUAL_COLLECTIONS(buf.begin(), buf.end(), expected[k].begin(), expected[k].end());
+    }
+
+    eval->Destroy();
+}
+
+BOOST_AUTO_TEST_CASE(EvalDenseTimesValueRefsTest)
+{
+    std::string modelDefinition =
+        "deviceId = -1 \n"
+        "precision = \"float\" \n"
+        "traceLevel = 1 \n"
+        "run=NDLNetworkBuilder \n"
+        "NDLNetworkBuilder=[ \n"
+        "i1 = Input(4) \n"
+        "o1 = Times(Constant(2, rows=1, cols=4), i1, tag=\"output\") \n"
+        "FeatureNodes = (i1) \n"
+        "] \n";
+
+    VariableSchema inputLayouts;
+    VariableSchema outputLayouts;
+    IEvaluateModelExtended<float> *eval;
+    eval = SetupNetworkAndGetLayouts(modelDefinition, inputLayouts, outputLayouts);
+
+    // Input memory owned by the caller
+    std::vector<float> input{ 1, 2, 3, 4, 0, 1, 0, 1 };
+    ValueRefs<float> inputRefs(1);
+    inputRefs[0].m_buffer.InitFrom(input);
+
+    // Output memory owned by the caller
+    std::vector<float> output(2);
+    ValueRefs<float> outputRefs(1);
+    outputRefs[0].m_buffer.InitFrom(output.data(), 1, 0);
+    BOOST_REQUIRE_THROW(eval->ForwardPass(inputRefs, outputRefs), std::exception); // Not enough capacity in output.
+
+    outputRefs[0].m_buffer.InitFrom(output.data(), output.size(), 0);
+    eval->ForwardPass(inputRefs, outputRefs);
+
+    std::vector<float> expected{ 20, 4 };
+    BOOST_CHECK_EQUAL_COLLECTIONS(output.begin(), output.end(), expected.begin(), expected.end());
+    BOOST_CHECK_EQUAL(outputRefs[0].m_buffer.size(), 2);
+
+    // Output memory borrowed from the network
+    input = { 1, 1, 1, 1 };
+    inputRefs[0].m_buffer.InitFrom(input);
+    outputRefs[0].m_buffer = VectorRef<float>();
+    eval->ForwardPass(inputRefs, outputRefs);
+
+    BOOST_REQUIRE(outputRefs[0].m_buffer.data() != nullptr);
+    std::vector<float> borrowed(outputRefs[0].m_buffer.begin(), outputRefs[0].m_buffer.end());
+    expected = { 8 };
+    BOOST_CHECK_EQUAL_COLLECTIONS(borrowed.begin(), borrowed.end(), expected.begin(), expected.end());
+
+    eval->Destroy();
+}
+
+BOOST_AUTO_TEST_CASE(EvalRepeatedForwardPassTest)
+{
+    std::string modelDefinition =
+        "deviceId = -1 \n"
+        "precision = \"float\" \n"
+        "traceLevel = 1 \n"
+        "run=NDLNetworkBuilder \n"
+        "NDLNetworkBuilder=[ \n"
+        "i1 = Input(4) \n"
+        "o1 = Times(Constant(2, rows=1, cols=4), i1, tag=\"output\") \n"
+        "FeatureNodes = (i1) \n"
+        "] \n";
+
+    VariableSchema inputLayouts;
+    VariableSchema outputLayouts;
+    IEvaluateModelExtended<float> *eval;
+    eval = SetupNetworkAndGetLayouts(modelDefinition, inputLayouts, outputLayouts);
+
+    std::vector<float> output(3);
+    ValueRefs<float> outputRefs(1);
+
+    // First pass binds a caller buffer of two samples, which is released afterwards.
+    {
+        std::vector<float> input{ 1, 2, 3, 4, 0, 1, 0, 1 };
+        ValueRefs<float> inputRefs(1);
+        inputRefs[0].m_buffer.InitFrom(input);
+        outputRefs[0].m_buffer.InitFrom(output.data(), output.size(), 0);
+        eval->ForwardPass(inputRefs, outputRefs);
+
+        std::vector<float> expected{ 20, 4 };
+        BOOST_CHECK_EQUAL_COLLECTIONS(output.begin(), output.begin() + 2, expected.begin(), expected.end());
+    }
+
+    // A different buffer with a different number of samples
+    {
+        std::vector<float> input{ 1, 1, 1, 1, 2, 2, 2, 2, 0, 0, 0, 3 };
+        ValueRefs<float> inputRefs(1);
+        inputRefs[0].m_buffer.InitFrom(input);
+        outputRefs[0].m_buffer.InitFrom(output.data(), output.size(), 0);
+        eval->ForwardPass(inputRefs, outputRefs);
+
+        std::vector<float> expected{ 8, 16, 6 };
+        BOOST_CHECK_EQUAL_COLLECTIONS(output.begin(), output.end(), expected.begin(), expected.end());
+    }
+
+    // The Values API copies its inputs, also after a pass with bound caller memory.
+    std::vector<ValueBuffer<float>> inputBuffer(1);
+    std::vector<ValueBuffer<float>> outputBuffer = outputLayouts.CreateBuffers<float>({ 2 });
+    inputBuffer[0].m_buffer = { 1, 2, 3, 4, 1, 0, 0, 0 };
+    eval->ForwardPass(inputBuffer, outputBuffer);
+
+    std::vector<float> expected{ 20, 2 };
+    auto buf = outputBuffer[0].m_buffer;
+    BOOST_CHECK_EQUAL_COLLECTIONS(buf.begin(), buf.end(), expected.begin(), expected.end());
+
+    inputBuffer[0].m_buffer = { 1, 1, 1, 1 };
+    eval->ForwardPass(inputBuffer, outputBuffer);
+
+    expected = { 8 };
+    buf = outputBuffer[0].m_buffer;
+    BOOST_CHECK_EQUAL_COLLECTIONS(buf.begin(), buf.end(), expected.begin(), expected.end());
+
+    eval->Destroy();
+}
+
+BOOST_AUTO_TEST_CASE(EvalCloneTest)
+{
+    std::string modelDefinition =
+        "deviceId = -1 \n"
+        "precision = \"float\" \n"
+        "traceLevel = 1 \n"
+        "run=NDLNetworkBuilder \n"
+        "NDLNetworkBuilder=[ \n"
+        "i1 = Input(4) \n"
+        "o1 = Times(Constant(2, rows=1, cols=4), i1, tag=\"output\") \n"
+        "FeatureNodes = (i1) \n"
+        "] \n";
+
+    VariableSchema inputLayouts;
+    VariableSchema outputLayouts;
+    IEvaluateModelExtended<float> *eval;
+    eval = SetupNetworkAndGetLayouts(modelDefinition, inputLayouts, outputLayouts);
+
+    // Evaluate the original and its clones concurrently
+    // (That the clones share the parameters but not the activations is checked on the networks, in NetworkTests/CloneWithSharedParameters.cpp.)
+    const size_t numWorkers = 4;
+    std::vector<IEvaluateModelExtended<float>*> workers{ eval };
+    for (size_t w = 1; w < numWorkers; w++)
+        workers.push_back(eval->Clone());
+
+    std::vector<std::vector<float>> results(numWorkers);
+    std::vector<std::thread> threads;
+    for (size_t w = 0; w < numWorkers; w++)
+    {
+        threads.push_back(std::thread([&, w]()
+        {
+            Values<float> inputBuffer(1);
+            Values<float> outputBuffer = outputLayouts.CreateBuffers<float>({ 1 });
+            for (int iteration = 0; iteration < 100; iteration++)
+            {
+                float x = (float)w;
+                inputBuffer[0].m_buffer = { x, x, x, x };
+                workers[w]->ForwardPass(inputBuffer, outputBuffer);
+            }
+            results[w] = outputBuffer[0].m_buffer;
+        }));
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    for (size_t w = 0; w < numWorkers; w++)
+    {
+        std::vector<float> expected{ 8.0f * w };
+        BOOST_CHECK_EQUAL_COLLECTIONS(results[w].begin(), results[w].end(), expected.begin(), expected.end());
+    }
+
+    for (auto worker : workers)
+        worker->Destroy();
+}
+
+BOOST_AUTO_TEST_CASE(EvalServerTest)
+{
+    std::string modelDefinition =
+        "deviceId = -1 \n"
+        "precision = \"float\" \n"
+        "traceLevel = 1 \n"
+        "run=NDLNetworkBuilder \n"
+        "NDLNetworkBuilder=[ \n"
+        "i1 = Input(4) \n"
+        "o1 = Times(Constant(2, rows=1, cols=4), i1, tag=\"output\") \n"
+        "FeatureNodes = (i1) \n"
+        "] \n";
+
+    VariableSchema inputLayouts;
+    VariableSchema outputLayouts;
+    IEvaluateModelExtended<float> *eval;
+    eval = SetupNetworkAndGetLayouts(modelDefinition, inputLayouts, outputLayouts);
+
+    // A request of two samples and a malformed one, served through the batching server
+    FILE* in = tmpfile();
+    FILE* out = tmpfile();
+    BOOST_REQUIRE(in != nullptr && out != nullptr);
+    fputs("1 2 3 4 0 1 0 1\n1 2 x\n", in);
+    rewind(in);
+
+    EvalServer::Server server(eval, /*maxBatchSize=*/4, /*maxDelayMs=*/1);
+    server.Start(/*numWorkers=*/2);
+    server.Serve(in, out);
+    server.Stop();
+
+    rewind(out);
+    char line[256];
+    BOOST_REQUIRE(fgets(line, sizeof(line), out) != nullptr);
+    BOOST_CHECK_EQUAL(std::string(line), "20 4\n");
+    BOOST_REQUIRE(fgets(line, sizeof(line), out) != nullptr);
+    BOOST_CHECK(std::string(line).compare(0, 5, "ERROR") == 0);
+    BOOST_CHECK(fgets(line, sizeof(line), out) == nullptr);
+    BOOST_CHECK(server.Report().find("requests = 1; batches = 1;") != std::string::npos);
+
+    fclose(out);
+    fclose(in);
+    eval->Destroy();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 }}}}
\ No newline at end of file
@@ -543,6 +543,25 @@ BOOST_FIXTURE_TEST_CASE(CPUMatrixSetValues, RandomSeedFixture)
     BOOST_CHECK_CLOSE(m1.SumOfElements(), static_cast<double>(m1.GetNumElements()), 1);
 }
 
+BOOST_FIXTURE_TEST_CASE(CPUMatrixSetValueExternalBuffer, RandomSeedFixture)
+{
+    double external[6] = { 1, 2, 3, 4, 5, 6 };
+    DMatrix m(3, 2);
+    m.SetValue(3, 2, external, matrixFlagDontOwnBuffer);
+    BOOST_CHECK_EQUAL(m.Data(), external);
+    BOOST_CHECK_EQUAL(m(2, 1), 6);
+
+    // copying gives the matrix its own storage again and leaves the external memory alone
+    double values[6] = { 6, 5, 4, 3, 2, 1 };
+    m.SetValue(3, 2, values, matrixFlagNormal);
+    BOOST_CHECK(m.Data() != external);
+    BOOST_CHECK_EQUAL(m(0, 0), 6);
+    BOOST_CHECK_EQUAL(external[0], 1);
+
+    m.Resize(4, 4);
+    BOOST_CHECK_EQUAL(m.GetNumElements(), 16);
+}
+
 BOOST_FIXTURE_TEST_CASE(CPUMatrixTranspose, RandomSeedFixture)
 {
     DMatrix m0(2, 3);
@@ -898,6 +917,234 @@ BOOST_FIXTURE_TEST_CASE(CPUMatrixSeedingDouble, RandomSeedFixture)
     BOOST_CHECK(m1.IsEqualTo(m2));
 }
 
+BOOST_FIXTURE_TEST_CASE(CPUMatrixAdagrad, RandomSeedFixture)
+{
+    const long n = 1031; // not a multiple of the unrolling/vector width
+    SMatrix gradients = SMatrix::RandomUniform(n, 3, -1, 1, IncrementCounter());
+    SMatrix expectedGradients(gradients);
+    SMatrix smoothedGradients = SMatrix::RandomUniform(n, 3, 0, 1, IncrementCounter());
+    SMatrix expectedSmoothedGradients(smoothedGradients);
+
+    // serial reference
+    const float floor = 1e-16f;
+    float* a = expectedSmoothedGradients.Data();
+    float* d_v = expectedGradients.Data();
+    double expectedAveMultiplier = 0;
+    for (long i = 0; i < 3 * n; i++)
+    {
+        a[i] += d_v[i] * d_v[i];
+        float temp = sqrt(a[i] + floor);
+        d_v[i] /= temp;
+        expectedAveMultiplier += 1 / temp;
+    }
+    expectedAveMultiplier /= 3 * n;
+
+    float aveMultiplier = smoothedGradients.Adagrad(gradients, true);
+
+    // element updates must be bit-identical to the serial loop
+    BOOST_CHECK(smoothedGradients.IsEqualTo(expectedSmoothedGradients, 0));
+    BOOST_CHECK(gradients.IsEqualTo(expectedGradients, 0));
+    BOOST_CHECK_CLOSE(aveMultiplier, (float) expectedAveMultiplier, 0.01);
+}
+
+BOOST_FIXTURE_TEST_CASE(CPUMatrixRmsProp, RandomSeedFixture)
+{
+    const long n = 517;
+    DMatrix gradients = DMatrix::RandomUniform(n, 1, -1, 1, IncrementCounter());
+    DMatrix smoothedGradients;
+
+    // first call initializes the state; run a few steps to exercise the sign logic
+    double aveMultiplier = 0;
+    for (int step = 0; step < 3; step++)
+    {
+        DMatrix expectedGradients(gradients);
+        DMatrix expectedState = smoothedGradients.IsEmpty() ? DMatrix() : DMatrix(smoothedGradients);
+
+        aveMultiplier = smoothedGradients.RmsProp(gradients, 0.99, 1.2, 10, 0.75, 0.1, true);
+
+        if (step > 0)
+        {
+            double* avars = expectedState.Data();
+            double* signs = avars + n;
+            double* steps = avars + 2 * n;
+            double* g = expectedGradients.Data();
+            double expectedAveMultiplier = 0;
+            for (long i = 0; i < n; i++)
+            {
+                avars[i] = 0.99 * avars[i] + (1 - 0.99) * (g[i] * g[i]);
+                const int grad_sign = (0 < g[i]) - (g[i] < 0);
+                if (signs[i] * grad_sign > 0)
+                    steps[i] = std::min(steps[i] * 1.2, 10.0);
+                else
+                    steps[i] = std::max(steps[i] * 0.75, 0.1);
+                double a = steps[i] / sqrt(avars[i] + 1e-6f);
+                g[i] *= a;
+                signs[i] = grad_sign;
+                expectedAveMultiplier += a;
+            }
+            BOOST_CHECK(smoothedGradients.IsEqualTo(expectedState, 0));
+            BOOST_CHECK(gradients.IsEqualTo(expectedGradients, 0));
+            BOOST_CHECK_CLOSE(aveMultiplier, expectedAveMultiplier / n, 1e-8);
+        }
+
+        gradients = DMatrix::RandomUniform(n, 1, -1, 1, IncrementCounter());
+    }
+}
+
+// checks the fused LSTM and GRU step kernels: the backward functions against finite differences of the forward functions
+BOOST_FIXTURE_TEST_CASE(CPUMatrixLSTMStep, RandomSeedFixture)
+{
+    const size_t H = 3, S = 2;
+    DMatrix z = DMatrix::RandomUniform(4 * H, S, -1, 1, IncrementCounter());
+    DMatrix rec = DMatrix::RandomUniform(4 * H, S, -1, 1, IncrementCounter());
+    DMatrix b = DMatrix::RandomUniform(4 * H, 1, -1, 1, IncrementCounter());
+    DMatrix p = DMatrix::RandomUniform(H, 3, -1, 1, IncrementCounter());
+    DMatrix cPrev = DMatrix::RandomUniform(H, S, -1, 1, IncrementCounter());
+    DMatrix wh = DMatrix::RandomUniform(H, S, -1, 1, IncrementCounter()); // loss = sum (wh .* h + wc .* c)
+    DMatrix wc = DMatrix::RandomUniform(H, S, -1, 1, IncrementCounter());
+
+    auto loss = [&](const DMatrix& z, const DMatrix& cPrev, const DMatrix& p)
+    {
+        DMatrix gates(z), c(H, S), h(H, S);
+        DMatrix::LSTMStepForward(gates, rec, b, p, cPrev, c, h);
+        double l = 0;
+        for (size_t j = 0; j < S; j++)
+            for (size_t k = 0; k < H; k++)
+                l += wh(k, j) * h(k, j) + wc(k, j) * c(k, j);
+        return l;
+    };
+
+    // forward against a direct evaluation of the cell
+    DMatrix gates(z), c(H, S), h(H, S);
+    DMatrix::LSTMStepForward(gates, rec, b, p, cPrev, c, h);
+    auto sigmoid = [](double x) { return 1 / (1 + exp(-x)); };
+    for (size_t j = 0; j < S; j++)
+    {
+        for (size_t k = 0; k < H; k++)
+        {
+            auto a = [&](size_t g) { return z(k + g * H, j) + rec(k + g * H, j) + b(k + g * H, 0); };
+            double it = sigmoid(a(0) + p(k, 0) * cPrev(k, j));
+            double ft = sigmoid(a(1) + p(k, 1) * cPrev(k, j));
+            double ct = ft * cPrev(k, j) + it * tanh(a(2));
+            double ot = sigmoid(a(3) + p(k, 2) * ct);
+            BOOST_CHECK_CLOSE(c(k, j), ct, 1e-8);
+            BOOST_CHECK_CLOSE(h(k, j), ot * tanh(ct), 1e-8);
+        }
+    }
+
+    DMatrix dc(wc), dp(H, 3);
+    dp.SetValue(0);
+    DMatrix::LSTMStepBackward(gates, p, cPrev, c, wh, dc, dp);
+
+    const double eps = 1e-6;
+    auto checkGradient = [&](DMatrix& x, const DMatrix& dx)
+    {
+        for (size_t i = 0; i < x.GetNumElements(); i++)
+        {
+            const double x0 = x.Data()[i];
+            x.Data()[i] = x0 + eps;
+            const double lPlus = loss(z, cPrev, p);
+            x.Data()[i] = x0 - eps;
+            const double lMinus = loss(z, cPrev, p);
+            x.Data()[i] = x0;
+            BOOST_CHECK_SMALL(dx.Data()[i] - (lPlus - lMinus) / (2 * eps), 1e-7);
+        }
+    };
+    checkGradient(z, gates);
+    checkGradient(cPrev, dc);
+    checkGradient(p, dp);
+}
+
+BOOST_FIXTURE_TEST_CASE(CPUMatrixGRUStep, RandomSeedFixture)
+{
+    const size_t H = 3, S = 2;
+    DMatrix z = DMatrix::RandomUniform(3 * H, S, -1, 1, IncrementCounter());
+    DMatrix rec = DMatrix::RandomUniform(3 * H, S, -1, 1, IncrementCounter());
+    DMatrix b = DMatrix::RandomUniform(3 * H, 1, -1, 1, IncrementCounter());
+    DMatrix hPrev = DMatrix::RandomUniform(H, S, -1, 1, IncrementCounter());
+    DMatrix wh = DMatrix::RandomUniform(H, S, -1, 1, IncrementCounter()); // loss = sum (wh .* h)
+
+    auto loss = [&](const DMatrix& z, const DMatrix& rec, const DMatrix& hPrev)
+    {
+        DMatrix gates(z), rn(H, S), h(H, S);
+        DMatrix::GRUStepForward(gates, rec, b, hPrev, rn, h);
+        double l = 0;
+        for (size_t j = 0; j < S; j++)
+            for (size_t k = 0; k < H; k++)
+                l += wh(k, j) * h(k, j);
+        return l;
+    };
+
+    DMatrix gates(z), rn(H, S), h(H, S);
+    DMatrix::GRUStepForward(gates, rec, b, hPrev, rn, h);
+    auto sigmoid = [](double x) { return 1 / (1 + exp(-x)); };
+    for (size_t j = 0; j < S; j++)
+    {
+        for (size_t k = 0; k < H; k++)
+        {
+            double rt = sigmoid(z(k, j) + rec(k, j) + b(k, 0));
+            double ut = sigmoid(z(k + H, j) + rec(k + H, j) + b(k + H, 0));
+            double nt = tanh(z(k + 2 * H, j) + b(k + 2 * H, 0) + rt * rec(k + 2 * H, j));
+            BOOST_CHECK_CLOSE(h(k, j), (1 - ut) * nt + ut * hPrev(k, j), 1e-8);
+        }
+    }
+
+    DMatrix dhPrev(H, S), dRec(3 * H, S);
+    DMatrix::GRUStepBackward(gates, rn, hPrev, wh, dhPrev, dRec);
+
+    const double eps = 1e-6;
+    auto checkGradient = [&](DMatrix& x, const DMatrix& dx)
+    {
+        for (size_t i = 0; i < x.GetNumElements(); i++)
+        {
+            const double x0 = x.Data()[i];
+            x.Data()[i] = x0 + eps;
+            const double lPlus = loss(z, rec, hPrev);
+            x.Data()[i] = x0 - eps;
+            const double lMinus = loss(z, rec, hPrev);
+            x.Data()[i] = x0;
+            BOOST_CHECK_SMALL(dx.Data()[i] - (lPlus - lMinus) / (2 * eps), 1e-7);
+        }
+    };
+    checkGradient(z, gates);
+    checkGradient(rec, dRec);
+    checkGradient(hPrev, dhPrev); // only the direct path; the path through R is added by the caller
+}
+
+BOOST_FIXTURE_TEST_CASE(CPUMatrixSoftmaxCrossEntropy, RandomSeedFixture)
+{
+    const size_t V = 7, T = 5;
+    DMatrix z = DMatrix::RandomUniform(V, T, -3.0, 3.0, IncrementCounter());
+    DMatrix target(V, T);
+    target.SetValue(0);
+    for (size_t t = 0; t < T; t++)
+        target(t % V, t) = 1;
+    target(1, 0) = 0.5; // soft labels are allowed as well
+    target(0, 0) = 0.5;
+
+    DMatrix logSumExp(1, T), crossEntropy(1, T);
+    DMatrix::SoftmaxCrossEntropy(target, z, logSumExp, crossEntropy);
+
+    DMatrix logSoftmax(V, T);
+    logSoftmax.AssignLogSoftmaxOf(z, true);
+    for (size_t t = 0; t < T; t++)
+    {
+        double ce = 0;
+        for (size_t i = 0; i < V; i++)
+            ce -= target(i, t) * logSoftmax(i, t);
+        BOOST_CHECK_SMALL(crossEntropy(0, t) - ce, 1e-10);
+    }
+
+    DMatrix alpha(1, 1);
+    alpha(0, 0) = 0.25;
+    DMatrix c(V, T);
+    c.SetValue(1);
+    DMatrix::AddScaledSoftmaxDifference(alpha, z, logSumExp, target, c);
+    for (size_t t = 0; t < T; t++)
+        for (size_t i = 0; i < V; i++)
+            BOOST_CHECK_SMALL(c(i, t) - (1 + 0.25 * (exp(logSoftmax(i, t)) - target(i, t))), 1e-10);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 }
 } } }
@@ -59,6 +59,34 @@ BOOST_FIXTURE_TEST_CASE(CPUSparseMatrixCopyColumnSliceToDense, RandomSeedFixture
     BOOST_CHECK(dm1.IsEqualTo(dm2, c_epsilonFloatE4));
 }
 
+BOOST_FIXTURE_TEST_CASE(CPUSparseMatrixReshape, RandomSeedFixture)
+{
+    const size_t m = 12;
+    const size_t n = 30;
+    DenseMatrix dm0(m, n);
+    SparseMatrix sm0(MatrixFormat::matrixFormatSparseCSC, m, n, 0);
+
+    dm0.SetUniformRandomValue(-1, 1, IncrementCounter());
+
+    foreach_coord (row, col, dm0)
+    {
+        if ((row + 3 * col) % 7 == 0)
+            sm0.SetValue(row, col, dm0(row, col));
+        else
+            dm0(row, col) = 0;
+    }
+
+    // merge columns
+    dm0.Reshape(3 * m, n / 3);
+    sm0.Reshape(3 * m, n / 3);
+    BOOST_CHECK(dm0.IsEqualTo(sm0.CopyColumnSliceToDense(0, n / 3), c_epsilonFloatE4));
+
+    // split columns
+    dm0.Reshape(m / 4, 4 * n);
+    sm0.Reshape(m / 4, 4 * n);
+    BOOST_CHECK(dm0.IsEqualTo(sm0.CopyColumnSliceToDense(0, 4 * n), c_epsilonFloatE4));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 }
 } } }
@@ -8,10 +8,12 @@
 #include "../../../Source/Math/GPUMatrix.h"
 #include "../../Common/Include/fileutil.h"
 #include "../../Common/Include/File.h"
+#include "../../Common/Include/MappedFile.h"
 // ToDo: CPP files directly included, use common library in the future if possible
 #include "../../Common/File.cpp"
 #include "../../Common/fileutil.cpp"
 
+#include <algorithm>
 #include <string>
 
 using namespace Microsoft::MSR::CNTK;
@@ -26,17 +28,49 @@ BOOST_FIXTURE_TEST_CASE(CPUMatrixFileWriteRead, RandomSeedFixture)
     CPUMatrix<float> matrixCpuCopy = matrixCpu;
 
     std::wstring fileNameCpu(L"MCPU.txt");
-    File fileCpu(fileNameCpu, fileOptionsText | fileOptionsReadWrite);
+    CPUMatrix<float> matrixCpuRead;
+    {
+        File fileCpu(fileNameCpu, fileOptionsText | fileOptionsReadWrite);
 
-    fileCpu << matrixCpu;
-    fileCpu.SetPosition(0);
+        fileCpu << matrixCpu;
+        fileCpu.SetPosition(0);
 
-    CPUMatrix<float> matrixCpuRead;
-    fileCpu >> matrixCpuRead;
+        fileCpu >> matrixCpuRead;
+    }
+    unlinkOrDie(fileNameCpu);
 
     BOOST_CHECK(matrixCpuCopy.IsEqualTo(matrixCpuRead, c_epsilonFloatE5));
 }
 
+BOOST_FIXTURE_TEST_CASE(CPUMatrixBinaryFileWriteRead, RandomSeedFixture)
+{
+    CPUMatrix<float> matrixCpu = CPUMatrix<float>::RandomUniform(43, 10, -26.3f, 30.2f, IncrementCounter());
+    CPUMatrix<float> matrixCpuCopy = matrixCpu;
+
+    std::wstring fileNameCpu(L"MCPU.bin");
+    {
+        File fileCpu(fileNameCpu, fileOptionsBinary | fileOptionsWrite | fileOptionsSync);
+        fileCpu << matrixCpu;
+        fileCpu.Flush();
+    }
+
+    // the elements are stored as one contiguous block of raw binary values
+    CPUMatrix<float> matrixCpuRead;
+    {
+        File fileCpu(fileNameCpu, fileOptionsBinary | fileOptionsRead);
+        std::vector<char> bytes(fileCpu.Size());
+        freadOrDie(bytes.data(), 1, bytes.size(), fileCpu);
+        const char* elements = (const char*) matrixCpu.Data();
+        BOOST_CHECK(std::search(bytes.begin(), bytes.end(), elements, elements + matrixCpu.GetNumElements() * sizeof(float)) != bytes.end());
+        fileCpu.SetPosition(0);
+
+        fileCpu >> matrixCpuRead;
+    }
+    unlinkOrDie(fileNameCpu);
+
+    BOOST_CHECK(matrixCpuCopy.IsEqualTo(matrixCpuRead, 0));
+}
+
 BOOST_FIXTURE_TEST_CASE(MatrixFileWriteRead, RandomSeedFixture)
 {
     // Test Matrix in Dense mode
@@ -44,13 +78,16 @@ BOOST_FIXTURE_TEST_CASE(MatrixFileWriteRead, RandomSeedFixture)
     Matrix<float> matrixCopy = matrix.DeepClone();
 
     std::wstring fileName(L"M.txt");
-    File file(fileName, fileOptionsText | fileOptionsReadWrite);
+    Matrix<float> matrixRead(c_deviceIdZero);
+    {
+        File file(fileName, fileOptionsText | fileOptionsReadWrite);
 
-    file << matrix;
-    file.SetPosition(0);
+        file << matrix;
+        file.SetPosition(0);
 
-    Matrix<float> matrixRead(c_deviceIdZero);
-    file >> matrixRead;
+        file >> matrixRead;
+    }
+    unlinkOrDie(fileName);
 
     BOOST_CHECK(matrixRead.IsEqualTo(matrixCopy, c_epsilonFloatE5));
 
@@ -61,18 +98,71 @@ BOOST_FIXTURE_TEST_CASE(MatrixFileWriteRead, RandomSeedFixture)
     matrixSparse.SwitchToMatrixType(MatrixType::SPARSE, matrixFormatSparseCSR, true);
 
     std::wstring filenameSparse(L"MS.txt");
-    File fileSparse(filenameSparse, fileOptionsText | fileOptionsReadWrite);
+    Matrix<float> matrixSparseRead(c_deviceIdZero);
+    {
+        File fileSparse(filenameSparse, fileOptionsText | fileOptionsReadWrite);
 
-    fileSparse << matrixSparse;
-    fileSparse.SetPosition(0);
+        fileSparse << matrixSparse;
+        fileSparse.SetPosition(0);
 
-    Matrix<float> matrixSparseRead(c_deviceIdZero);
-    fileSparse >> matrixSparseRead;
+        fileSparse >> matrixSparseRead;
+    }
+    unlinkOrDie(filenameSparse);
 
     BOOST_CHECK(MatrixType::SPARSE == matrixSparseRead.GetMatrixType());
     BOOST_CHECK(matrixSparseRead.IsEqualTo(matrixSparseCopy, c_epsilonFloatE5));
 }
 
+BOOST_FIXTURE_TEST_CASE(MatrixMappableFileWriteRead, RandomSeedFixture)
+{
+    // only the large matrix is stored aligned
+    Matrix<float> matrix = Matrix<float>::RandomUniform(430, 100, CPUDEVICE, -26.3f, 30.2f, IncrementCounter());
+    Matrix<float> matrixCopy = matrix.DeepClone();
+    Matrix<float> smallMatrix = Matrix<float>::RandomUniform(43, 10, CPUDEVICE, -26.3f, 30.2f, IncrementCounter());
+    Matrix<float> smallMatrixCopy = smallMatrix.DeepClone();
+    BOOST_REQUIRE(matrix.GetNumElements() * sizeof(float) >= File::s_minAlignedArraySize);
+    BOOST_REQUIRE(smallMatrix.GetNumElements() * sizeof(float) < File::s_minAlignedArraySize);
+
+    std::wstring fileName(L"MMappable.bin");
+    {
+        File file(fileName, fileOptionsBinary | fileOptionsWrite | fileOptionsMappable);
+        file << 'x' << matrix << smallMatrix; // the marker byte leaves the array unaligned
+    }
+
+    // mapped: the matrix uses the elements in place
+    {
+        std::shared_ptr<MappedFile> mapping;
+        Matrix<float> matrixMapped(CPUDEVICE), smallMatrixRead(CPUDEVICE);
+        {
+            File file(fileName, fileOptionsBinary | fileOptionsRead | fileOptionsMappable);
+            char marker;
+            file >> marker >> matrixMapped >> smallMatrixRead;
+            mapping = file.GetMapping();
+        }
+        BOOST_REQUIRE(mapping);
+        BOOST_CHECK(matrixMapped.IsEqualTo(matrixCopy, c_epsilonFloatE5));
+        BOOST_CHECK(matrixMapped.Data() >= (float*) mapping->Data() && matrixMapped.Data() < (float*) (mapping->Data() + mapping->Size()));
+        BOOST_CHECK_EQUAL(((char*) matrixMapped.Data() - mapping->Data()) % File::s_arrayAlignment, 0);
+        BOOST_CHECK(smallMatrixRead.IsEqualTo(smallMatrixCopy, c_epsilonFloatE5));
+        BOOST_CHECK(smallMatrixRead.OwnBuffer());
+
+        // the mapping is copy-on-write: modifying the matrix must not change the file
+        matrixMapped.SetValue(0.0f);
+    }
+
+    // not mapped: the elements are read into the matrix
+    Matrix<float> matrixRead(CPUDEVICE), smallMatrixRead(CPUDEVICE);
+    {
+        File file(fileName, fileOptionsBinary | fileOptionsRead);
+        char marker;
+        file >> marker >> matrixRead >> smallMatrixRead;
+        BOOST_CHECK(!file.GetMapping());
+    }
+    unlinkOrDie(fileName);
+    BOOST_CHECK(matrixRead.IsEqualTo(matrixCopy, c_epsilonFloatE5));
+    BOOST_CHECK(smallMatrixRead.IsEqualTo(smallMatrixCopy, c_epsilonFloatE5));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE(GPUMatrixSuite)
@@ -83,13 +173,16 @@ BOOST_FIXTURE_TEST_CASE(GPUMatrixFileWriteRead, RandomSeedFixture)
     GPUMatrix<float> matrixGpuCopy = matrixGpu;
 
     std::wstring filenameGpu(L"MGPU.txt");
-    File fileGpu(filenameGpu, fileOptionsText | fileOptionsReadWrite);
+    GPUMatrix<float> matrixGpuRead(c_deviceIdZero);
+    {
+        File fileGpu(filenameGpu, fileOptionsText | fileOptionsReadWrite);
 
-    fileGpu << matrixGpu;
-    fileGpu.SetPosition(0);
+        fileGpu << matrixGpu;
+        fileGpu.SetPosition(0);
 
-    GPUMatrix<float> matrixGpuRead(c_deviceIdZero);
-    fileGpu >> matrixGpuRead;
+        fileGpu >> matrixGpuRead;
+    }
+    unlinkOrDie(filenameGpu);
 
     BOOST_CHECK(matrixGpuCopy.IsEqualTo(matrixGpuRead, c_epsilonFloatE5));
 }
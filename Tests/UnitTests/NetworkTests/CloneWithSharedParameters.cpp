@@ -0,0 +1,98 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// CloneWithSharedParameters.cpp -- the clones that IEvaluateModelExtended::Clone() evaluates with share the parameters, but not the activations
+//
+#include "stdafx.h"
+#include "ComputationNetwork.h"
+#include "ComputationNetworkBuilder.h"
+
+using namespace Microsoft::MSR::CNTK;
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
+
+static const size_t inputDim = 4, outputDim = 3, numSamples = 2;
+
+// deterministic values in [-0.5, 0.5)
+static vector<float> TestValues(size_t n, unsigned int seed)
+{
+    vector<float> values(n);
+    for (auto& value : values)
+    {
+        seed = seed * 1103515245 + 12345;
+        value = (float) ((seed >> 16) & 0x7fff) / 0x8000 - 0.5f;
+    }
+    return values;
+}
+
+// out = Tanh(W * features + b)
+static ComputationNetworkPtr BuildNetwork()
+{
+    auto net = make_shared<ComputationNetwork>(CPUDEVICE);
+    ComputationNetworkBuilder<float> builder(*net);
+
+    auto features = builder.CreateInputNode(L"features", inputDim);
+    net->AddToNodeGroup(L"feature", features);
+    auto w = builder.CreateLearnableParameter(L"W", outputDim, inputDim);
+    w->Value().SetValue(outputDim, inputDim, CPUDEVICE, TestValues(outputDim * inputDim, 1).data());
+    auto b = builder.CreateLearnableParameter(L"b", outputDim, 1);
+    b->Value().SetValue(outputDim, 1, CPUDEVICE, TestValues(outputDim, 2).data());
+
+    auto out = builder.Tanh(builder.Plus(builder.Times(w, features, 1, L"Wx"), b, L"Wxb"), L"out");
+    net->AddToNodeGroup(L"output", out);
+    net->CompileNetwork();
+    return net;
+}
+
+// prepare a network for evaluation the way CNTKEvalExtended::StartForwardEvaluation() does
+static void StartForwardEvaluation(const ComputationNetworkPtr& net)
+{
+    net->AllocateAllMatrices({}, net->OutputNodes(), nullptr);
+    net->StartEvaluateMinibatchLoop(net->OutputNodes());
+}
+
+static Matrix<float>& ValueOf(const ComputationNetworkPtr& net, const wchar_t* nodeName)
+{
+    return net->GetNodeFromName(nodeName)->As<ComputationNode<float>>()->Value();
+}
+
+static Matrix<float> Evaluate(const ComputationNetworkPtr& net, unsigned int inputSeed)
+{
+    net->GetMBLayoutPtrOfNetwork()->InitAsFrameMode(numSamples);
+    ValueOf(net, L"features").SetValue(inputDim, numSamples, CPUDEVICE, TestValues(inputDim * numSamples, inputSeed).data());
+    ComputationNetwork::BumpEvalTimeStamp(net->FeatureNodes());
+    net->ForwardProp(net->OutputNodes());
+    return ValueOf(net, L"out").DeepClone();
+}
+
+BOOST_AUTO_TEST_SUITE(CloneWithSharedParametersSuite)
+
+BOOST_AUTO_TEST_CASE(CloneSharesParametersButNotActivations)
+{
+    auto net = BuildNetwork();
+    auto clone = net->CloneWithSharedParameters();
+    ScopedNetworkOperationMode modeGuard(net, NetworkOperationMode::inferring);
+    ScopedNetworkOperationMode cloneModeGuard(clone, NetworkOperationMode::inferring);
+    StartForwardEvaluation(net);
+    StartForwardEvaluation(clone);
+
+    let cloneOut = Evaluate(clone, 10);
+    Evaluate(net, 11);
+
+    // the parameters are the same matrices
+    for (let name : { L"W", L"b" })
+        BOOST_CHECK_EQUAL(ValueOf(clone, name).Data(), ValueOf(net, name).Data());
+
+    // the inputs and activations are not
+    for (let name : { L"features", L"Wx", L"Wxb", L"out" })
+        BOOST_CHECK_NE(ValueOf(clone, name).Data(), ValueOf(net, name).Data());
+
+    // so evaluating the original left the result of the clone alone, and the clone computes the same function
+    BOOST_CHECK(ValueOf(clone, L"out").IsEqualTo(cloneOut, 0));
+    BOOST_CHECK(Evaluate(net, 10).IsEqualTo(cloneOut, 0));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}}}}
@@ -0,0 +1,210 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// FusedRNN.cpp -- the FusedRNN node against the equivalent LSTM and GRU built from PastValue and elementwise nodes
+//
+#include "stdafx.h"
+#include "ComputationNetwork.h"
+#include "ComputationNetworkBuilder.h"
+#include "RecurrentNodes.h"
+
+using namespace Microsoft::MSR::CNTK;
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
+
+static const size_t inputDim = 3, hiddenDim = 4;
+static const size_t numParallelSequences = 2, numTimeSteps = 3;
+
+// deterministic values in [-0.5, 0.5)
+static vector<float> TestValues(size_t n, unsigned int seed)
+{
+    vector<float> values(n);
+    for (auto& value : values)
+    {
+        seed = seed * 1103515245 + 12345;
+        value = (float) ((seed >> 16) & 0x7fff) / 0x8000 - 0.5f;
+    }
+    return values;
+}
+
+static shared_ptr<ComputationNode<float>> CreateParameter(ComputationNetworkBuilder<float>& builder, const std::wstring& name, size_t rows, size_t cols, float* values)
+{
+    auto node = builder.CreateLearnableParameter(name, rows, cols);
+    node->Value().SetValue(rows, cols, CPUDEVICE, values);
+    return node;
+}
+
+// criterion = SquareError(labels, h) for an LSTM with peepholes, either as one FusedRNN node or built from individual nodes
+// Both networks use the same parameter values; the unfused one holds the peephole columns p0, p1, p2 as separate parameters.
+static ComputationNetworkPtr BuildLSTMNetwork(bool fused)
+{
+    const size_t H = hiddenDim, G = 4;
+    auto net = make_shared<ComputationNetwork>(CPUDEVICE);
+    ComputationNetworkBuilder<float> builder(*net);
+
+    auto features = builder.CreateInputNode(L"features", inputDim);
+    net->AddToNodeGroup(L"feature", features);
+    auto labels = builder.CreateInputNode(L"labels", H);
+    net->AddToNodeGroup(L"label", labels);
+
+    auto w = TestValues(G * H * inputDim, 1), r = TestValues(G * H * H, 2), b = TestValues(G * H, 3), p = TestValues(H * 3, 4);
+    auto W = CreateParameter(builder, L"W", G * H, inputDim, w.data());
+    auto R = CreateParameter(builder, L"R", G * H, H, r.data());
+    auto B = CreateParameter(builder, L"b", G * H, 1, b.data());
+
+    shared_ptr<ComputationNode<float>> h;
+    if (fused)
+    {
+        auto peepholes = CreateParameter(builder, L"p", H, 3, p.data());
+        h = net->AddNodeToNetAndAttachInputs(New<FusedRNNNode<float>>(CPUDEVICE, L"h", H, L"lstm"), { W, R, B, features, peepholes });
+    }
+    else
+    {
+        shared_ptr<ComputationNode<float>> peepholes[3];
+        for (size_t k = 0; k < 3; k++)
+            peepholes[k] = CreateParameter(builder, msra::strfun::wstrprintf(L"p%d", (int) k), H, 1, p.data() + k * H);
+
+        auto dh = builder.PastValue(nullptr, (float) DEFAULT_HIDDEN_ACTIVATION, H, 1, L"dh");
+        auto dc = builder.PastValue(nullptr, (float) DEFAULT_HIDDEN_ACTIVATION, H, 1, L"dc");
+        auto z = builder.Plus(builder.Plus(builder.Times(W, features), builder.Times(R, dh)), B);
+        auto gate = [&](size_t k) { return builder.RowSlice(z, k * H, H); };
+        auto it = builder.Sigmoid(builder.Plus(gate(0), builder.ElementTimes(peepholes[0], dc)));
+        auto ft = builder.Sigmoid(builder.Plus(gate(1), builder.ElementTimes(peepholes[1], dc)));
+        auto c = builder.Plus(builder.ElementTimes(ft, dc), builder.ElementTimes(it, builder.Tanh(gate(2))), L"c");
+        auto ot = builder.Sigmoid(builder.Plus(gate(3), builder.ElementTimes(peepholes[2], c)));
+        h = builder.ElementTimes(ot, builder.Tanh(c), L"h");
+        dh->AttachInputs({ h });
+        dc->AttachInputs({ c });
+    }
+
+    auto criterion = builder.SquareError(labels, h, L"criterion");
+    net->AddToNodeGroup(L"criterion", criterion);
+    net->CompileNetwork();
+    return net;
+}
+
+// criterion = SquareError(labels, h) for a GRU, either as one FusedRNN node or built from individual nodes as BS.RNNs.UnfusedGRU does
+static ComputationNetworkPtr BuildGRUNetwork(bool fused)
+{
+    const size_t H = hiddenDim, G = 3;
+    auto net = make_shared<ComputationNetwork>(CPUDEVICE);
+    ComputationNetworkBuilder<float> builder(*net);
+
+    auto features = builder.CreateInputNode(L"features", inputDim);
+    net->AddToNodeGroup(L"feature", features);
+    auto labels = builder.CreateInputNode(L"labels", H);
+    net->AddToNodeGroup(L"label", labels);
+
+    auto w = TestValues(G * H * inputDim, 7), r = TestValues(G * H * H, 8), b = TestValues(G * H, 9);
+    auto W = CreateParameter(builder, L"W", G * H, inputDim, w.data());
+    auto R = CreateParameter(builder, L"R", G * H, H, r.data());
+    auto B = CreateParameter(builder, L"b", G * H, 1, b.data());
+
+    shared_ptr<ComputationNode<float>> h;
+    if (fused)
+        h = net->AddNodeToNetAndAttachInputs(New<FusedRNNNode<float>>(CPUDEVICE, L"h", H, L"gru"), { W, R, B, features });
+    else
+    {
+        auto dh = builder.PastValue(nullptr, (float) DEFAULT_HIDDEN_ACTIVATION, H, 1, L"dh");
+        auto zx = builder.Plus(builder.Times(W, features), B);
+        auto zh = builder.Times(R, dh);
+        auto rt = builder.Sigmoid(builder.Plus(builder.RowSlice(zx, 0, H), builder.RowSlice(zh, 0, H)));
+        auto ut = builder.Sigmoid(builder.Plus(builder.RowSlice(zx, H, H), builder.RowSlice(zh, H, H)));
+        auto nt = builder.Tanh(builder.Plus(builder.RowSlice(zx, 2 * H, H), builder.ElementTimes(rt, builder.RowSlice(zh, 2 * H, H))));
+        h = builder.Plus(nt, builder.ElementTimes(ut, builder.Minus(dh, nt)), L"h");
+        dh->AttachInputs({ h });
+    }
+
+    auto criterion = builder.SquareError(labels, h, L"criterion");
+    net->AddToNodeGroup(L"criterion", criterion);
+    net->CompileNetwork();
+    return net;
+}
+
+// one forward and backward pass over two sequences of 3 and 2 frames; the second one is followed by a gap
+static void RunMinibatch(const ComputationNetworkPtr& net)
+{
+    const size_t S = numParallelSequences, T = numTimeSteps;
+    auto criterion = net->FinalCriterionNodes().front();
+    net->AllocateAllMatrices({}, {}, criterion);
+    ScopedNetworkOperationMode modeGuard(net, NetworkOperationMode::training);
+    net->StartEvaluateMinibatchLoop(criterion);
+
+    auto pMBLayout = net->GetMBLayoutPtrOfNetwork();
+    pMBLayout->Init(S, T);
+    pMBLayout->AddSequence(0, 0, 0, T);
+    pMBLayout->AddSequence(1, 1, 0, T - 1);
+    pMBLayout->AddGap(1, T - 1, T);
+
+    auto features = TestValues(inputDim * S * T, 5), labels = TestValues(hiddenDim * S * T, 6);
+    net->GetNodeFromName(L"features")->As<ComputationNode<float>>()->Value().SetValue(inputDim, S * T, CPUDEVICE, features.data());
+    net->GetNodeFromName(L"labels")->As<ComputationNode<float>>()->Value().SetValue(hiddenDim, S * T, CPUDEVICE, labels.data());
+    ComputationNetwork::BumpEvalTimeStamp(net->FeatureNodes());
+    ComputationNetwork::BumpEvalTimeStamp(net->LabelNodes());
+
+    net->ForwardProp(criterion);
+    net->Backprop(criterion);
+}
+
+// compare columns [firstCol, firstCol + numCols) of a with all of b, or all columns if numCols == SIZE_MAX
+static void CheckClose(const Matrix<float>& a, const Matrix<float>& b, size_t firstCol = 0, size_t numCols = SIZE_MAX)
+{
+    if (numCols == SIZE_MAX)
+        numCols = a.GetNumCols();
+    BOOST_REQUIRE_EQUAL(a.GetNumRows(), b.GetNumRows());
+    BOOST_REQUIRE_EQUAL(numCols, b.GetNumCols());
+    for (size_t j = 0; j < numCols; j++)
+        for (size_t i = 0; i < a.GetNumRows(); i++)
+            BOOST_CHECK_SMALL(a(i, firstCol + j) - b(i, j), 1e-5f);
+}
+
+BOOST_AUTO_TEST_SUITE(FusedRNNSuite)
+
+BOOST_AUTO_TEST_CASE(FusedLSTMMatchesUnfusedLSTM)
+{
+    auto fusedNet = BuildLSTMNetwork(/*fused=*/true);
+    auto unfusedNet = BuildLSTMNetwork(/*fused=*/false);
+    RunMinibatch(fusedNet);
+    RunMinibatch(unfusedNet);
+
+    auto node = [](const ComputationNetworkPtr& net, const wchar_t* name) { return net->GetNodeFromName(name)->As<ComputationNode<float>>(); };
+
+    // forward: h of all frames except the gap (last column)
+    const size_t numFrames = numParallelSequences * numTimeSteps - 1;
+    auto fusedOutput = node(fusedNet, L"h")->Value().ColumnSlice(0, numFrames);
+    auto unfusedOutput = node(unfusedNet, L"h")->Value().ColumnSlice(0, numFrames);
+    CheckClose(fusedOutput, unfusedOutput);
+    CheckClose(node(fusedNet, L"criterion")->Value(), node(unfusedNet, L"criterion")->Value());
+
+    // backward: the gradients of all parameters
+    for (let name : { L"W", L"R", L"b" })
+        CheckClose(node(fusedNet, name)->Gradient(), node(unfusedNet, name)->Gradient());
+    for (size_t k = 0; k < 3; k++)
+        CheckClose(node(fusedNet, L"p")->Gradient(), node(unfusedNet, msra::strfun::wstrprintf(L"p%d", (int) k).c_str())->Gradient(), k, 1);
+}
+
+BOOST_AUTO_TEST_CASE(FusedGRUMatchesUnfusedGRU)
+{
+    auto fusedNet = BuildGRUNetwork(/*fused=*/true);
+    auto unfusedNet = BuildGRUNetwork(/*fused=*/false);
+    RunMinibatch(fusedNet);
+    RunMinibatch(unfusedNet);
+
+    auto node = [](const ComputationNetworkPtr& net, const wchar_t* name) { return net->GetNodeFromName(name)->As<ComputationNode<float>>(); };
+
+    // forward: h of all frames except the gap (last column)
+    const size_t numFrames = numParallelSequences * numTimeSteps - 1;
+    auto fusedOutput = node(fusedNet, L"h")->Value().ColumnSlice(0, numFrames);
+    auto unfusedOutput = node(unfusedNet, L"h")->Value().ColumnSlice(0, numFrames);
+    CheckClose(fusedOutput, unfusedOutput);
+    CheckClose(node(fusedNet, L"criterion")->Value(), node(unfusedNet, L"criterion")->Value());
+
+    // backward: the gradients of all parameters
+    for (let name : { L"W", L"R", L"b" })
+        CheckClose(node(fusedNet, name)->Gradient(), node(unfusedNet, name)->Gradient());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}}}}
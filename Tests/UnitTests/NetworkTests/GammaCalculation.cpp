@@ -0,0 +1,180 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// GammaCalculation.cpp -- lattice gammas of a minibatch of several utterances against those of each utterance by itself
+//
+#include "stdafx.h"
+#include "Sequences.h"
+#include "gammacalculation.h"
+
+using namespace Microsoft::MSR::CNTK;
+using namespace msra::lattices;
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
+
+// one single-state HMM per unit, each with its own senone
+static const char* testStateList = "s_sil\ns_a\ns_b\ns_sp\n";
+static const char* testTransP = "T1 1 1 0 0.5 0.5\n";
+static const char* testTying = "sil T1 s_sil\na T1 s_a\nb T1 s_b\nsp T1 s_sp\n";
+static const size_t numSenones = 4;
+
+// two small HTK denominator lattices of 5 and 4 frames
+static const char* testLattices[] = {
+    "VERSION=1.1\n"
+    "lmscale=12.00 wdpenalty=0.00\n"
+    "N=4 L=4\n"
+    "I=0 t=0.00\n"
+    "I=1 t=0.02\n"
+    "I=2 t=0.04\n"
+    "I=3 t=0.05\n"
+    "J=0 S=0 E=1 a=-10.50 l=-1.00 d=:sil,0.02:\n"
+    "J=1 S=0 E=2 a=-20.25 l=-2.00 d=:a,0.02:b,0.02:\n"
+    "J=2 S=1 E=2 a=-7.75 l=-0.50 d=:b,0.01:sp,0.01:\n"
+    "J=3 S=2 E=3 a=-3.00 l=0.00 d=:sil,0.01:\n",
+
+    "VERSION=1.1\n"
+    "lmscale=12.00 wdpenalty=0.00\n"
+    "N=4 L=4\n"
+    "I=0 t=0.00\n"
+    "I=1 t=0.01\n"
+    "I=2 t=0.03\n"
+    "I=3 t=0.04\n"
+    "J=0 S=0 E=1 a=-2.00 l=0.00 d=:sil,0.01:\n"
+    "J=1 S=0 E=2 a=-12.00 l=-1.50 d=:sil,0.01:a,0.02:\n"
+    "J=2 S=1 E=2 a=-9.00 l=-1.00 d=:b,0.02:\n"
+    "J=3 S=2 E=3 a=-4.00 l=0.00 d=:sil,0.01:\n",
+};
+
+static void WriteTextFile(const wstring& path, const string& text)
+{
+    auto_file_ptr f(fopenOrDie(path, L"wb"));
+    fwriteOrDie(text.data(), 1, text.size(), f);
+}
+
+// deterministic values in [-3, 0)
+static vector<float> TestLogLLs(size_t n)
+{
+    vector<float> values(n);
+    unsigned int seed = 1;
+    for (auto& value : values)
+    {
+        seed = seed * 1103515245 + 12345;
+        value = (float) ((seed >> 16) & 0x7fff) / 0x8000 * 3 - 3;
+    }
+    return values;
+}
+
+struct GammaCalculationFixture
+{
+    msra::asr::simplesenonehmm hset;
+    vector<shared_ptr<const msra::dbn::latticepair>> lattices;
+    vector<size_t> numFrames;    // [utterance]
+    vector<size_t> uids;         // reference senones of all utterances, concatenated
+    Matrix<float> logLLs;        // [senone, frame] of all utterances, concatenated
+    vector<Matrix<float>> gammas; // [utterance] gammas of each utterance when it is the only one in the minibatch
+    float objective;             // sum of the objectives of the single-utterance minibatches, in utterance order
+
+    GammaCalculationFixture()
+        : logLLs(CPUDEVICE)
+    {
+        const wstring stateListPath = L"GammaCalculation.states", transPPath = L"GammaCalculation.transp", tyingPath = L"GammaCalculation.tying", latticePath = L"GammaCalculation.lat";
+        WriteTextFile(stateListPath, testStateList);
+        WriteTextFile(transPPath, testTransP);
+        WriteTextFile(tyingPath, testTying);
+        hset.loadfromfile(tyingPath, stateListPath, transPPath);
+        for (const auto& text : testLattices)
+        {
+            WriteTextFile(latticePath, text);
+            auto pair = make_shared<msra::dbn::latticepair>();
+            pair->second.fromhtklattice(latticePath, hset.getsymmap());
+            numFrames.push_back(pair->getnumframes());
+            lattices.push_back(pair);
+        }
+        for (const auto& path : { stateListPath, transPPath, tyingPath, latticePath })
+            unlinkOrDie(path);
+
+        let totalNumFrames = numFrames[0] + numFrames[1];
+        for (size_t t = 0; t < totalNumFrames; t++)
+            uids.push_back((t * 3) % numSenones);
+        auto values = TestLogLLs(numSenones * totalNumFrames);
+        logLLs.SetValue(numSenones, totalNumFrames, CPUDEVICE, values.data());
+
+        // the reference: one utterance at a time
+        objective = 0;
+        for (size_t i = 0, ts = 0; i < lattices.size(); ts += numFrames[i], i++)
+        {
+            vector<shared_ptr<const msra::dbn::latticepair>> lattice = { lattices[i] };
+            vector<size_t> utteranceUids(uids.begin() + ts, uids.begin() + ts + numFrames[i]);
+            Matrix<float> utteranceLogLLs = logLLs.ColumnSlice(ts, numFrames[i]).DeepClone();
+            Matrix<float> gamma(numSenones, numFrames[i], CPUDEVICE);
+            objective += CalculateGammas(lattice, utteranceLogLLs, gamma, utteranceUids, 1, nullptr, {});
+            gammas.push_back(move(gamma));
+        }
+    }
+
+    float CalculateGammas(vector<shared_ptr<const msra::dbn::latticepair>>& lattices, const Matrix<float>& logLLs, Matrix<float>& gamma,
+                          vector<size_t>& uids, size_t numParallelSequences, MBLayoutPtr pMBLayout, vector<size_t> extraUttMap)
+    {
+        GammaCalculation<float> gammaCalculation;
+        gammaCalculation.init(hset, CPUDEVICE);
+        Matrix<float> functionValues(1, 1, CPUDEVICE), labels(CPUDEVICE);
+        vector<size_t> boundaries(uids.size(), 0);
+        gammaCalculation.calgammaformb(functionValues, lattices, logLLs, labels, gamma, uids, boundaries,
+                                       numParallelSequences, pMBLayout, extraUttMap, /*doreferencealign=*/false);
+        return functionValues(0, 0);
+    }
+
+    // compare column 'firstCol + j * colStride' of 'actual' with column j of 'expected'
+    static void CheckClose(const Matrix<float>& actual, size_t firstCol, size_t colStride, const Matrix<float>& expected)
+    {
+        for (size_t j = 0; j < expected.GetNumCols(); j++)
+            for (size_t i = 0; i < expected.GetNumRows(); i++)
+                BOOST_CHECK_SMALL(actual(i, firstCol + j * colStride) - expected(i, j), 1e-5f);
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(GammaCalculationSuite, GammaCalculationFixture)
+
+// the utterances follow each other in a single sequence
+BOOST_AUTO_TEST_CASE(GammasOfConcatenatedUtterances)
+{
+    Matrix<float> gamma(numSenones, logLLs.GetNumCols(), CPUDEVICE);
+    let actualObjective = CalculateGammas(lattices, logLLs, gamma, uids, 1, nullptr, {});
+
+    BOOST_CHECK_CLOSE(actualObjective, objective, 1e-4f);
+    CheckClose(gamma, 0, 1, gammas[0]);
+    CheckClose(gamma, numFrames[0], 1, gammas[1]);
+}
+
+// each utterance is a parallel sequence of its own; the shorter one is followed by a gap
+BOOST_AUTO_TEST_CASE(GammasOfParallelUtterances)
+{
+    const size_t S = 2, T = max(numFrames[0], numFrames[1]);
+    auto pMBLayout = make_shared<MBLayout>();
+    pMBLayout->Init(S, T);
+    for (size_t s = 0; s < S; s++)
+    {
+        pMBLayout->AddSequence(s, s, 0, numFrames[s]);
+        if (numFrames[s] < T)
+            pMBLayout->AddGap(s, numFrames[s], T);
+    }
+
+    // interleave the frames of the two utterances
+    Matrix<float> parallelLogLLs(numSenones, S * T, CPUDEVICE);
+    parallelLogLLs.SetValue(0);
+    for (size_t s = 0, ts = 0; s < S; ts += numFrames[s], s++)
+        for (size_t t = 0; t < numFrames[s]; t++)
+            parallelLogLLs.SetColumn(logLLs.ColumnSlice(ts + t, 1), t * S + s);
+
+    Matrix<float> gamma(numSenones, S * T, CPUDEVICE);
+    let actualObjective = CalculateGammas(lattices, parallelLogLLs, gamma, uids, S, pMBLayout, { 0, 1 });
+
+    BOOST_CHECK_CLOSE(actualObjective, objective, 1e-4f);
+    for (size_t s = 0; s < S; s++)
+        CheckClose(gamma, s, S, gammas[s]);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}}}}
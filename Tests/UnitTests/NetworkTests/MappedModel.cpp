@@ -0,0 +1,108 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// MappedModel.cpp -- loading models saved in the mappable format, for evaluation and for training
+//
+#include "stdafx.h"
+#include "ComputationNetwork.h"
+#include "ComputationNetworkBuilder.h"
+#include "fileutil.h"
+
+using namespace Microsoft::MSR::CNTK;
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
+
+// W is large enough to be stored aligned (File::s_minAlignedArraySize), the bias b is not
+static const size_t featureDim = File::s_minAlignedArraySize / sizeof(float) / 2, labelDim = 2, numSamples = 2;
+
+// deterministic values in [-0.05, 0.05)
+static vector<float> TestValues(size_t n, int period)
+{
+    vector<float> values(n);
+    for (size_t i = 0; i < n; i++)
+        values[i] = ((int) (i % period) - period / 2) * 0.1f / period;
+    return values;
+}
+
+// criterion = SquareError(labels, W * features + b)
+static ComputationNetworkPtr BuildLinearRegressionNetwork()
+{
+    auto net = make_shared<ComputationNetwork>(CPUDEVICE);
+    ComputationNetworkBuilder<float> builder(*net);
+
+    auto features = builder.CreateInputNode(L"features", featureDim);
+    net->AddToNodeGroup(L"feature", features);
+    auto labels = builder.CreateInputNode(L"labels", labelDim);
+    net->AddToNodeGroup(L"label", labels);
+
+    auto w = builder.CreateLearnableParameter(L"W", labelDim, featureDim);
+    w->Value().SetValue(labelDim, featureDim, CPUDEVICE, TestValues(labelDim * featureDim, 5).data());
+    auto b = builder.CreateLearnableParameter(L"b", labelDim, 1);
+    b->Value().SetValue(labelDim, 1, CPUDEVICE, TestValues(labelDim, 3).data());
+
+    auto criterion = builder.SquareError(labels, builder.Plus(builder.Times(w, features), b, L"out"), L"criterion");
+    net->AddToNodeGroup(L"criterion", criterion);
+    net->CompileNetwork();
+    return net;
+}
+
+// one forward pass of the criterion over a minibatch
+static float EvaluateCriterion(const ComputationNetworkPtr& net)
+{
+    net->GetMBLayoutPtrOfNetwork()->InitAsFrameMode(numSamples);
+    net->GetNodeFromName(L"features")->As<ComputationNode<float>>()->Value().SetValue(featureDim, numSamples, CPUDEVICE, TestValues(featureDim * numSamples, 7).data());
+    net->GetNodeFromName(L"labels")->As<ComputationNode<float>>()->Value().SetValue(labelDim, numSamples, CPUDEVICE, vector<float>{ 1, 0, 0, 1 }.data());
+    ComputationNetwork::BumpEvalTimeStamp(net->FeatureNodes());
+    ComputationNetwork::BumpEvalTimeStamp(net->LabelNodes());
+
+    auto criterion = net->FinalCriterionNodes().front();
+    net->ForwardProp(criterion);
+    return criterion->As<ComputationNode<float>>()->Value().Get00Element();
+}
+
+BOOST_AUTO_TEST_SUITE(MappedModelSuite)
+
+BOOST_AUTO_TEST_CASE(TrainMappedModel)
+{
+    const std::wstring modelPath = L"TrainMappedModel.dnn";
+    auto deleteModels = MakeScopeExit([&modelPath]()
+    {
+        _wunlink(modelPath.c_str());
+        _wunlink((modelPath + L".updated").c_str());
+    });
+    BuildLinearRegressionNetwork()->Save(modelPath, (FileOptions) (FileOptions::fileOptionsBinary | FileOptions::fileOptionsMappable));
+
+    // evaluation uses the large parameters in place from the mapping, and reads the small ones
+    auto evalNet = ComputationNetwork::CreateFromFile<float>(CPUDEVICE, modelPath, /*readOnly=*/true);
+    auto& evalW = evalNet->GetNodeFromName(L"W")->As<ComputationNode<float>>()->Value();
+    BOOST_CHECK(!evalW.OwnBuffer());
+    BOOST_CHECK(evalNet->GetNodeFromName(L"b")->As<ComputationNode<float>>()->Value().OwnBuffer());
+    const float w01 = evalW(0, 1);
+
+    // training gets its own copy of the parameters
+    auto net = ComputationNetwork::CreateFromFile<float>(CPUDEVICE, modelPath);
+    auto& w = net->GetNodeFromName(L"W")->As<ComputationNode<float>>()->Value();
+    BOOST_CHECK(w.OwnBuffer());
+
+    // one step of gradient descent
+    auto criterion = net->FinalCriterionNodes().front();
+    net->AllocateAllMatrices({}, {}, criterion);
+    ScopedNetworkOperationMode modeGuard(net, NetworkOperationMode::training);
+    net->StartEvaluateMinibatchLoop(criterion);
+    const float before = EvaluateCriterion(net);
+    net->Backprop(criterion);
+    w.AddWithScaleOf(-0.01f, net->GetNodeFromName(L"W")->As<ComputationNode<float>>()->Gradient());
+    const float after = EvaluateCriterion(net);
+    BOOST_CHECK_LT(after, before);
+
+    // the updated parameters can be resized and saved again; the mapped model is not affected
+    net->Save(modelPath + L".updated");
+    w.Resize(3, 3);
+    BOOST_CHECK_EQUAL(evalW(0, 1), w01);
+
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}}}}
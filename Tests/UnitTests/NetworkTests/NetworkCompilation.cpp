@@ -0,0 +1,103 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// NetworkCompilation.cpp -- compile-time benchmark of CompileNetwork() and AllocateAllMatrices() on large synthetic networks
+//
+#include "stdafx.h"
+#include "ComputationNetwork.h"
+#include "ComputationNetworkBuilder.h"
+#include <chrono>
+
+using namespace Microsoft::MSR::CNTK;
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
+
+// Builds 'width' parallel stacks of 'depth' recurrent layers over a common input, summed up by a balanced tree of Plus nodes.
+// Each layer is a loop H = Sigmoid(U * X + W * PastValue(H)) of 7 nodes.
+// The graph is kept shallow so that the recursive traversals do not depend on the size of the network.
+template <class ElemType>
+static ComputationNetworkPtr BuildWideRecurrentNetwork(size_t width, size_t depth, size_t dim)
+{
+    auto net = make_shared<ComputationNetwork>(CPUDEVICE);
+    ComputationNetworkBuilder<ElemType> builder(*net);
+
+    auto features = builder.CreateInputNode(L"features", dim);
+    net->AddToNodeGroup(L"feature", features);
+    auto labels = builder.CreateInputNode(L"labels", dim);
+    net->AddToNodeGroup(L"label", labels);
+
+    vector<shared_ptr<ComputationNode<ElemType>>> outputs;
+    for (size_t i = 0; i < width; i++)
+    {
+        auto input = features;
+        for (size_t j = 0; j < depth; j++)
+        {
+            let suffix = to_wstring(i) + L"_" + to_wstring(j);
+            auto u = builder.CreateLearnableParameter(L"U" + suffix, dim, dim);
+            auto w = builder.CreateLearnableParameter(L"W" + suffix, dim, dim);
+            auto pastValue = builder.PastValue(nullptr, 0.1f, dim, 1, L"P" + suffix);
+            auto output = builder.Sigmoid(builder.Plus(builder.Times(u, input, 1, L"UX" + suffix), builder.Times(w, pastValue, 1, L"WP" + suffix), L"S" + suffix), L"H" + suffix);
+            pastValue->AttachInputs({ output });
+            input = output;
+        }
+        outputs.push_back(input);
+    }
+
+    size_t numSums = 0;
+    while (outputs.size() > 1)
+    {
+        vector<shared_ptr<ComputationNode<ElemType>>> sums;
+        for (size_t i = 0; i + 1 < outputs.size(); i += 2)
+            sums.push_back(builder.Plus(outputs[i], outputs[i + 1], L"Sum" + to_wstring(numSums++)));
+        if (outputs.size() % 2 != 0)
+            sums.push_back(outputs.back());
+        outputs.swap(sums);
+    }
+
+    auto criterion = builder.SquareError(labels, outputs.front(), L"criterion");
+    net->AddToNodeGroup(L"criterion", criterion);
+    return net;
+}
+
+static double SecondsSince(const chrono::steady_clock::time_point& start)
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+BOOST_AUTO_TEST_SUITE(NetworkCompilationSuite)
+
+BOOST_AUTO_TEST_CASE(CompileLargeRecurrentNetwork)
+{
+    // about 20k nodes and 2800 recurrent loops
+    const size_t width = 700;
+    const size_t depth = 4;
+    auto net = BuildWideRecurrentNetwork<float>(width, depth, 4);
+    BOOST_CHECK_EQUAL(net->GetTotalNumberOfNodes(), width * depth * 7 + (width - 1) + 3);
+
+    auto start = chrono::steady_clock::now();
+    net->CompileNetwork();
+    let compileTime = SecondsSince(start);
+
+    start = chrono::steady_clock::now();
+    net->AllocateAllMatrices(net->EvaluationNodes(), vector<ComputationNodeBasePtr>(), net->FinalCriterionNodes().front());
+    let allocationTime = SecondsSince(start);
+
+    fprintf(stderr, "CompileLargeRecurrentNetwork: %d nodes, CompileNetwork() %.3f s, AllocateAllMatrices() %.3f s\n",
+            (int) net->GetTotalNumberOfNodes(), compileTime, allocationTime);
+
+    BOOST_CHECK(net->IsCompiled());
+    // every layer is its own loop
+    let h00 = net->GetNodeFromName(L"H0_0");
+    let p00 = net->GetNodeFromName(L"P0_0");
+    let h01 = net->GetNodeFromName(L"H0_1");
+    BOOST_CHECK(h00->IsPartOfLoop());
+    BOOST_CHECK(h00->IsPartOfSameLoopAs(*p00));
+    BOOST_CHECK(!h00->IsPartOfSameLoopAs(*h01));
+    BOOST_CHECK(!net->GetNodeFromName(L"Sum0")->IsPartOfLoop());
+    BOOST_CHECK(net->GetNodeFromName(L"criterion")->GetSampleLayout().GetNumElements() == 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}}}}
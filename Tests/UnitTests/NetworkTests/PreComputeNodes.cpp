@@ -0,0 +1,136 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// PreComputeNodes.cpp -- combining the Mean and InvStdDev accumulators of parallel workers against a serial pass over all data
+//
+#include "stdafx.h"
+#include "ComputationNetwork.h"
+#include "ComputationNetworkBuilder.h"
+#include <condition_variable>
+#include <mutex>
+#include <numeric>
+#include <thread>
+
+using namespace Microsoft::MSR::CNTK;
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
+
+static const size_t featureDim = 2, maxMinibatchSize = 3;
+
+// stand-in for MPI's AllReduce() across workers that run as threads
+// Each call blocks until all workers have contributed their vector, then returns the element-wise sum to each of them.
+class MockAllReduceSum
+{
+    std::mutex m_mutex;
+    std::condition_variable m_allArrived;
+    const size_t m_numWorkers;
+    size_t m_numArrived = 0;
+    size_t m_numCompleted = 0; // number of completed reductions, to tell waiting workers that theirs is done
+    vector<double> m_sum, m_result;
+
+public:
+    MockAllReduceSum(size_t numWorkers)
+        : m_numWorkers(numWorkers)
+    {
+    }
+
+    void operator()(vector<double>& v)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_numArrived == 0)
+            m_sum.assign(v.size(), 0);
+        for (size_t i = 0; i < v.size(); i++)
+            m_sum[i] += v[i];
+        let numCompleted = m_numCompleted;
+        if (++m_numArrived == m_numWorkers)
+        {
+            m_result = m_sum;
+            m_numArrived = 0;
+            m_numCompleted++;
+            m_allArrived.notify_all();
+        }
+        else
+            m_allArrived.wait(lock, [&] { return m_numCompleted != numCompleted; });
+        v = m_result;
+    }
+};
+
+// Mean and InvStdDev of columns [begin, end) of 'data', read in minibatches of up to 'maxMinibatchSize' samples
+// If 'allReduceSum' is given, the accumulators are combined with those of the other workers before finalizing, as SGD::PreCompute() does.
+static ComputationNetworkPtr ComputeStatistics(const vector<float>& data, size_t begin, size_t end, const std::function<void(vector<double>&)>& allReduceSum)
+{
+    auto net = make_shared<ComputationNetwork>(CPUDEVICE);
+    ComputationNetworkBuilder<float> builder(*net);
+    auto features = builder.CreateInputNode(L"features", featureDim);
+    net->AddToNodeGroup(L"feature", features);
+    net->AddToNodeGroup(L"output", builder.Mean(features, L"mean"));
+    net->AddToNodeGroup(L"output", builder.InvStdDev(features, L"invStdDev"));
+    net->CompileNetwork();
+
+    std::list<ComputationNodeBasePtr> nodes = { net->GetNodeFromName(L"mean"), net->GetNodeFromName(L"invStdDev") };
+    net->AllocateAllMatrices(vector<ComputationNodeBasePtr>(nodes.begin(), nodes.end()), {}, nullptr);
+    ScopedNetworkOperationMode modeGuard(net, NetworkOperationMode::preComputing);
+    net->StartEvaluateMinibatchLoop(nodes);
+    for (auto& node : nodes)
+        dynamic_pointer_cast<IPreComputeNode>(node)->MarkComputed(false /*begin accumulating*/);
+
+    for (size_t t = begin; t < end; t += maxMinibatchSize)
+    {
+        let numSamples = min(end - t, maxMinibatchSize);
+        vector<float> minibatch(data.begin() + t * featureDim, data.begin() + (t + numSamples) * featureDim);
+        net->GetMBLayoutPtrOfNetwork()->InitAsFrameMode(numSamples);
+        features->Value().SetValue(featureDim, numSamples, CPUDEVICE, minibatch.data());
+        ComputationNetwork::BumpEvalTimeStamp(net->FeatureNodes());
+        net->ForwardProp(nodes);
+    }
+
+    if (allReduceSum)
+        for (auto& node : nodes)
+            dynamic_pointer_cast<IPreComputeNode>(node)->AggregateAccumulators(allReduceSum);
+    for (auto& node : nodes)
+        dynamic_pointer_cast<IPreComputeNode>(node)->MarkComputed(true /*done accumulating*/);
+    return net;
+}
+
+BOOST_AUTO_TEST_SUITE(PreComputeNodesSuite)
+
+BOOST_AUTO_TEST_CASE(AggregateAccumulatorsMatchesSerialPreCompute)
+{
+    // the workers' shares of the data are uneven, and one of them is empty
+    const vector<size_t> shares = { 5, 0, 2, 9 };
+    let totalNumSamples = std::accumulate(shares.begin(), shares.end(), (size_t) 0);
+    vector<float> data(featureDim * totalNumSamples);
+    for (size_t i = 0; i < data.size(); i++)
+        data[i] = (float) ((i * 37) % 11) + 10.0f * (i % featureDim); // (the dimensions differ in mean)
+
+    auto serialNet = ComputeStatistics(data, 0, totalNumSamples, nullptr);
+
+    MockAllReduceSum allReduceSum(shares.size());
+    vector<ComputationNetworkPtr> workerNets(shares.size());
+    vector<std::thread> workers;
+    for (size_t w = 0, begin = 0; w < shares.size(); begin += shares[w], w++)
+        workers.push_back(std::thread([&, w, begin]()
+        {
+            workerNets[w] = ComputeStatistics(data, begin, begin + shares[w], [&](vector<double>& v) { allReduceSum(v); });
+        }));
+    for (auto& worker : workers)
+        worker.join();
+
+    // every worker ends up with the statistics of all data
+    for (let& workerNet : workerNets)
+    {
+        for (let name : { L"mean", L"invStdDev" })
+        {
+            let& expected = serialNet->GetNodeFromName(name)->As<ComputationNode<float>>()->Value();
+            let& actual = workerNet->GetNodeFromName(name)->As<ComputationNode<float>>()->Value();
+            BOOST_REQUIRE_EQUAL(actual.GetNumElements(), featureDim);
+            for (size_t i = 0; i < featureDim; i++)
+                BOOST_CHECK_CLOSE(actual(i, 0), expected(i, 0), 1e-3f);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}}}}
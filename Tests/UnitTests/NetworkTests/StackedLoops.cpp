@@ -0,0 +1,146 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// StackedLoops.cpp -- gradients of two stacked recurrent layers, i.e. two SEQ loops where the upper one reads the lower one, against finite differences
+//
+#include "stdafx.h"
+#include "ComputationNetwork.h"
+#include "ComputationNetworkBuilder.h"
+
+using namespace Microsoft::MSR::CNTK;
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
+
+static const size_t inputDim = 2, hiddenDim = 3;
+static const size_t numParallelSequences = 2, numTimeSteps = 4;
+
+// deterministic values in [-0.5, 0.5)
+static vector<double> TestValues(size_t n, unsigned int seed)
+{
+    vector<double> values(n);
+    for (auto& value : values)
+    {
+        seed = seed * 1103515245 + 12345;
+        value = (double) ((seed >> 16) & 0x7fff) / 0x8000 - 0.5;
+    }
+    return values;
+}
+
+static shared_ptr<ComputationNode<double>> CreateParameter(ComputationNetworkBuilder<double>& builder, const std::wstring& name, size_t rows, size_t cols, unsigned int seed)
+{
+    auto node = builder.CreateLearnableParameter(name, rows, cols);
+    auto values = TestValues(rows * cols, seed);
+    node->Value().SetValue(rows, cols, CPUDEVICE, values.data());
+    return node;
+}
+
+// criterion = SquareError(labels, h2) where
+//  h1 = Tanh(W1 * features + R1 * PastValue(h1))
+//  h2 = Tanh(W2 * h1 + R2 * PastValue(h2))
+static ComputationNetworkPtr BuildStackedNetwork()
+{
+    const size_t H = hiddenDim;
+    auto net = make_shared<ComputationNetwork>(CPUDEVICE);
+    ComputationNetworkBuilder<double> builder(*net);
+
+    auto features = builder.CreateInputNode(L"features", inputDim);
+    net->AddToNodeGroup(L"feature", features);
+    auto labels = builder.CreateInputNode(L"labels", H);
+    net->AddToNodeGroup(L"label", labels);
+
+    auto layer = [&](const shared_ptr<ComputationNode<double>>& input, size_t inputDim, int index)
+    {
+        auto W = CreateParameter(builder, msra::strfun::wstrprintf(L"W%d", index), H, inputDim, 2 * index);
+        auto R = CreateParameter(builder, msra::strfun::wstrprintf(L"R%d", index), H, H, 2 * index + 1);
+        auto dh = builder.PastValue(nullptr, 0.1f, H, 1);
+        auto h = builder.Tanh(builder.Plus(builder.Times(W, input), builder.Times(R, dh)), msra::strfun::wstrprintf(L"h%d", index));
+        dh->AttachInputs({ h });
+        return h;
+    };
+    auto h1 = layer(features, inputDim, 1);
+    auto h2 = layer(h1, H, 2);
+
+    auto criterion = builder.SquareError(labels, h2, L"criterion");
+    net->AddToNodeGroup(L"criterion", criterion);
+    net->CompileNetwork();
+    return net;
+}
+
+// prepare a minibatch of two sequences of 4 and 3 frames; the second one is followed by a gap
+static void SetUpMinibatch(const ComputationNetworkPtr& net)
+{
+    const size_t S = numParallelSequences, T = numTimeSteps;
+    auto criterion = net->FinalCriterionNodes().front();
+    net->AllocateAllMatrices({}, {}, criterion);
+    net->StartEvaluateMinibatchLoop(criterion);
+
+    auto pMBLayout = net->GetMBLayoutPtrOfNetwork();
+    pMBLayout->Init(S, T);
+    pMBLayout->AddSequence(0, 0, 0, T);
+    pMBLayout->AddSequence(1, 1, 0, T - 1);
+    pMBLayout->AddGap(1, T - 1, T);
+
+    auto features = TestValues(inputDim * S * T, 10), labels = TestValues(hiddenDim * S * T, 11);
+    net->GetNodeFromName(L"features")->As<ComputationNode<double>>()->Value().SetValue(inputDim, S * T, CPUDEVICE, features.data());
+    net->GetNodeFromName(L"labels")->As<ComputationNode<double>>()->Value().SetValue(hiddenDim, S * T, CPUDEVICE, labels.data());
+    ComputationNetwork::BumpEvalTimeStamp(net->FeatureNodes());
+    ComputationNetwork::BumpEvalTimeStamp(net->LabelNodes());
+}
+
+BOOST_AUTO_TEST_SUITE(StackedLoopsSuite)
+
+BOOST_AUTO_TEST_CASE(StackedLoopsGradientsMatchFiniteDifferences)
+{
+    auto net = BuildStackedNetwork();
+    auto node = [&](const wchar_t* name) { return net->GetNodeFromName(name)->As<ComputationNode<double>>(); };
+    auto criterion = net->GetNodeFromName(L"criterion");
+
+    // the two layers form separate loops, so the gradient from h2 into h1 is one that crosses loops
+    BOOST_REQUIRE(node(L"h1")->IsPartOfLoop() && node(L"h2")->IsPartOfLoop());
+    BOOST_CHECK(!node(L"h1")->IsPartOfSameLoopAs(*node(L"h2")));
+
+    SetUpMinibatch(net);
+    ScopedNetworkOperationMode modeGuard(net, NetworkOperationMode::training);
+    net->ForwardProp(criterion);
+    net->Backprop(criterion);
+
+    // keep copies of the gradients, as the forward passes below may reuse their memory
+    map<wstring, Matrix<double>> gradients;
+    for (let name : { L"W1", L"R1", L"W2", L"R2" })
+        gradients.emplace(name, net->GetNodeFromName(name)->As<ComputationNode<double>>()->Gradient().DeepClone());
+
+    // central differences of the criterion w.r.t. each parameter element
+    const double epsilon = 1e-5;
+    for (let name : { L"W1", L"R1", L"W2", L"R2" })
+    {
+        auto parameterNode = net->GetNodeFromName(name);
+        auto parameter = parameterNode->As<ComputationNode<double>>();
+        let& gradient = gradients.at(name);
+        auto& value = parameter->Value();
+        for (size_t j = 0; j < value.GetNumCols(); j++)
+        {
+            for (size_t i = 0; i < value.GetNumRows(); i++)
+            {
+                let original = value(i, j);
+                double objective[2];
+                for (int k = 0; k < 2; k++)
+                {
+                    value(i, j) = original + (k == 0 ? epsilon : -epsilon);
+                    ComputationNetwork::BumpEvalTimeStamp({ parameterNode });
+                    net->ForwardProp(criterion);
+                    objective[k] = criterion->As<ComputationNode<double>>()->Value()(0, 0);
+                }
+                value(i, j) = original;
+                ComputationNetwork::BumpEvalTimeStamp({ parameterNode });
+
+                let expected = (objective[0] - objective[1]) / (2 * epsilon);
+                BOOST_CHECK_SMALL(gradient(i, j) - expected, 1e-6);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}}}}
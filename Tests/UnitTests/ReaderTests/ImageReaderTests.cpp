@@ -220,5 +220,65 @@ BOOST_AUTO_TEST_CASE(ImageReaderGrayscale)
         1);
 }
 
+// ImageReaderPacked_00000.imgpack holds the images of ImageReaderSimple_map.txt (written by ImagePackConverter.py),
+// so reading it in order must give the same minibatches as reading the map file.
+BOOST_AUTO_TEST_CASE(ImageReaderPacked)
+{
+    const string config = testDataPath() + "/Config/ImageReaderPacked_Config.cntk";
+    const string mapOutput = testDataPath() + "/Control/ImageReaderPacked_MapOutput.txt";
+    const string packedOutput = testDataPath() + "/Control/ImageReaderPacked_Output.txt";
+    HelperReadInAndWriteOut<float>(config, mapOutput, "Map_Test", "reader", 4, 2, 2, 1, 1, 0, 1);
+    HelperReadInAndWriteOut<float>(config, packedOutput, "Packed_Test", "reader", 4, 2, 2, 1, 1, 0, 1);
+    CheckFilesEquivalent(mapOutput, packedOutput);
+}
+
+// In the second epoch, all images come from the cache of decoded images, in memory or spilled to disk.
+// Either way, the minibatches must be the same as without the cache, and no spilled files may be left behind.
+BOOST_AUTO_TEST_CASE(ImageReaderCache)
+{
+    const string config = testDataPath() + "/Config/ImageReaderPacked_Config.cntk";
+    const string mapOutput = testDataPath() + "/Control/ImageReaderPacked_MapOutput.txt";
+    const string cacheOutput = testDataPath() + "/Control/ImageReaderCache_Output.txt";
+    const string spillOutput = testDataPath() + "/Control/ImageReaderCacheSpill_Output.txt";
+    HelperReadInAndWriteOut<float>(config, mapOutput, "Map_Test", "reader", 4, 2, 2, 1, 1, 0, 1);
+    HelperReadInAndWriteOut<float>(config, cacheOutput, "Cache_Test", "reader", 4, 2, 2, 1, 1, 0, 1);
+    CheckFilesEquivalent(mapOutput, cacheOutput);
+
+    HelperReadInAndWriteOut<float>(config, spillOutput, "Spill_Test", "reader", 4, 2, 2, 1, 1, 0, 1);
+    CheckFilesEquivalent(mapOutput, spillOutput);
+    for (boost::filesystem::directory_iterator file(currentPath()), end; file != end; ++file)
+        BOOST_CHECK_MESSAGE(file->path().filename().string().find("imagecache_") != 0, "Spilled image not deleted: " + file->path().string());
+}
+
+// Scaling the decoded 8 bit image must give the same features as scaling it in float, up to the rounding of an
+// 8 bit result. Cubic interpolation overshoots at the edges of the pattern, which an 8 bit result would clip.
+BOOST_AUTO_TEST_CASE(ImageReaderScaleByteMatchesFloat)
+{
+    const string config = testDataPath() + "/Config/ImageReaderScale_Config.cntk";
+    const size_t imageSize = 13 * 11 * 3;
+    auto readImage = [&](const string& testSectionName)
+    {
+        auto inputs = CreateStreamMinibatchInputs<float>(1, 0);
+        auto reader = GetDataReader(config, testSectionName, "reader");
+        reader->StartMinibatchLoop(1, 0, 1);
+        BOOST_REQUIRE(reader->GetMinibatch(*inputs));
+        auto& features = inputs->GetInputMatrix<float>(L"features");
+        BOOST_REQUIRE_EQUAL(features.GetNumElements(), imageSize);
+        std::unique_ptr<float[]> data(features.CopyToArray());
+        return vector<float>(data.get(), data.get() + imageSize);
+    };
+
+    const auto cubicByte = readImage("CubicByte_Test");
+    const auto cubicFloat = readImage("CubicFloat_Test");
+    BOOST_CHECK(*std::min_element(cubicFloat.begin(), cubicFloat.end()) < 0 || *std::max_element(cubicFloat.begin(), cubicFloat.end()) > 255);
+    for (size_t i = 0; i < imageSize; i++)
+        BOOST_CHECK_SMALL(cubicByte[i] - cubicFloat[i], 1e-3f);
+
+    const auto linearByte = readImage("LinearByte_Test");
+    const auto linearFloat = readImage("LinearFloat_Test");
+    for (size_t i = 0; i < imageSize; i++)
+        BOOST_CHECK_SMALL(linearByte[i] - linearFloat[i], 1.0f);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 } } } }
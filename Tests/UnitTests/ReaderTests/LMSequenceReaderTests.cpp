@@ -0,0 +1,71 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+#include "stdafx.h"
+#include "Common/ReaderTestHelper.h"
+
+using namespace Microsoft::MSR::CNTK;
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
+
+struct LMSequenceReaderFixture : ReaderFixture
+{
+    LMSequenceReaderFixture()
+        : ReaderFixture("/Data")
+    {
+    }
+
+    // Like HelperReadInAndWriteOut(), but calls DataEnd() after each minibatch, as SGD does,
+    // which is where LMSequenceReader marks the sequences of the minibatch as done.
+    void ReadAllAndWriteOut(const string& configFileName, const string& testSectionName, const string& testDataFilePath, size_t mbSize, size_t epochs)
+    {
+        auto inputs = CreateStreamMinibatchInputs<float>(1, 1);
+        auto reader = GetDataReader(configFileName, testSectionName, "reader");
+
+        boost::filesystem::remove(testDataFilePath);
+        ofstream outputFile(testDataFilePath, ios::out);
+        for (size_t epoch = 0; epoch < epochs; epoch++)
+        {
+            reader->StartMinibatchLoop(mbSize, epoch, requestDataSize);
+            while (reader->GetMinibatch(*inputs))
+            {
+                for (const auto& name : { L"features", L"labels" })
+                    OutputMatrix(inputs->GetInputMatrix<float>(name), *inputs->GetInput(name).pMBLayout, outputFile);
+                reader->DataEnd();
+            }
+        }
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(ReaderTestSuite, LMSequenceReaderFixture)
+
+BOOST_AUTO_TEST_CASE(LMSequenceReaderBinaryCorpusMatchesText)
+{
+    const string configFileName = testDataPath() + "/Config/LMSequenceReaderBinaryCorpus_Config.cntk";
+    const string binaryFileName = "LMSequenceReaderBinaryCorpus_Train.bin"; // (as in the config, relative to the current path)
+    const string textOutput = testDataPath() + "/Control/LMSequenceReaderBinaryCorpus_Text_Output.txt";
+    const string convertedOutput = testDataPath() + "/Control/LMSequenceReaderBinaryCorpus_Converted_Output.txt";
+    const string reopenedOutput = testDataPath() + "/Control/LMSequenceReaderBinaryCorpus_Reopened_Output.txt";
+    boost::filesystem::remove(binaryFileName);
+
+    const size_t mbSize = 4, epochs = 2; // (mbSize is the truncation length; some sentences are longer)
+    ReadAllAndWriteOut(configFileName, "Text_Test", textOutput, mbSize, epochs);
+
+    // the first binary reader converts the text, the second one opens the existing file
+    ReadAllAndWriteOut(configFileName, "Binary_Test", convertedOutput, mbSize, epochs);
+    BOOST_CHECK(boost::filesystem::exists(binaryFileName));
+    BOOST_CHECK(!boost::filesystem::exists(binaryFileName + ".tmp"));
+    ReadAllAndWriteOut(configFileName, "Binary_Test", reopenedOutput, mbSize, epochs);
+
+    BOOST_CHECK_GT(boost::filesystem::file_size(textOutput), 0);
+    CheckFilesEquivalent(textOutput, convertedOutput);
+    CheckFilesEquivalent(textOutput, reopenedOutput);
+
+    for (const auto& fileName : { binaryFileName, textOutput, convertedOutput, reopenedOutput })
+        boost::filesystem::remove(fileName);
+};
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} } } }
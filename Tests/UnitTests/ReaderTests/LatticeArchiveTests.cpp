@@ -0,0 +1,135 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// LatticeArchiveTests.cpp -- mapped lattice archives (.latmap) against the TOC-based lattice archives they are converted from
+//
+
+#include "stdafx.h"
+#include "latticearchive.h"
+
+using namespace msra::lattices;
+using namespace std;
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
+
+// two small HTK lattices over the units sil, a, b, and sp
+static const char* testLattices[] = {
+    "VERSION=1.1\n"
+    "lmscale=12.00 wdpenalty=0.00\n"
+    "N=4 L=4\n"
+    "I=0 t=0.00\n"
+    "I=1 t=0.02\n"
+    "I=2 t=0.04\n"
+    "I=3 t=0.05\n"
+    "J=0 S=0 E=1 a=-10.50 l=-1.00 d=:sil,0.02:\n"
+    "J=1 S=0 E=2 a=-20.25 l=-2.00 d=:a,0.02:b,0.02:\n"
+    "J=2 S=1 E=2 a=-7.75 l=-0.50 d=:b,0.01:sp,0.01:\n"
+    "J=3 S=2 E=3 a=-3.00 l=0.00 d=:sil,0.01:\n",
+
+    "VERSION=1.1\n"
+    "lmscale=12.00 wdpenalty=0.00\n"
+    "N=3 L=2\n"
+    "I=0 t=0.00\n"
+    "I=1 t=0.03\n"
+    "I=2 t=0.04\n"
+    "J=0 S=0 E=1 a=-12.00 l=-1.50 d=:a,0.01:b,0.02:\n"
+    "J=1 S=1 E=2 a=-4.00 l=0.00 d=:sil,0.01:\n",
+};
+static const wchar_t* testKeys[] = { L"utt1", L"utt2" };
+
+static void WriteTextFile(const wstring& path, const string& text)
+{
+    auto_file_ptr f(fopenOrDie(path, L"wb"));
+    fwriteOrDie(text.data(), 1, text.size(), f);
+}
+
+static string ReadBinaryFile(const wstring& path)
+{
+    ifstream f(msra::strfun::utf8(path), ios::binary);
+    return string(istreambuf_iterator<char>(f), istreambuf_iterator<char>());
+}
+
+// the serialized form of a lattice, for comparing lattices
+static string Serialize(lattice& L)
+{
+    const wstring path = L"LatticeArchiveTests.serialized";
+    {
+        auto_file_ptr f(fopenOrDie(path, L"wb"));
+        L.fwrite(f);
+    }
+    string bytes = ReadBinaryFile(path);
+    unlinkOrDie(path);
+    return bytes;
+}
+
+// write the test lattices into a TOC-based archive; its units are numbered differently from the model's
+static void WriteTocArchive(const wstring& tocPath, const wstring& archivePath)
+{
+    const unordered_map<string, size_t> archiveUnits = { { "sil", 0 }, { "a", 1 }, { "b", 2 }, { "sp", 3 } };
+    WriteTextFile(archivePath + L".symlist", "sil\na\nb\nsp\n");
+    string toc;
+    auto_file_ptr f(fopenOrDie(archivePath, L"wb"));
+    for (size_t i = 0; i < _countof(testLattices); i++)
+    {
+        const wstring htkPath = L"LatticeArchiveTests.lat";
+        WriteTextFile(htkPath, testLattices[i]);
+        lattice L;
+        L.fromhtklattice(htkPath, archiveUnits);
+        unlinkOrDie(htkPath);
+
+        toc += msra::strfun::strprintf("%s=%s[%d]\n", msra::strfun::utf8(testKeys[i]).c_str(), i == 0 ? msra::strfun::utf8(archivePath).c_str() : "", (int) ftell(f));
+        L.fwrite(f);
+    }
+    WriteTextFile(tocPath, toc);
+}
+
+BOOST_AUTO_TEST_SUITE(LatticeArchiveTests)
+
+BOOST_AUTO_TEST_CASE(MappedLatticeArchiveRoundTrip)
+{
+    const unordered_map<string, size_t> modelUnits = { { "a", 0 }, { "b", 1 }, { "sil", 2 }, { "sp", 3 } };
+    const wstring tocPath = L"LatticeArchiveTests.toc", archivePath = L"LatticeArchiveTests.lats", mappedPath = L"LatticeArchiveTests.latmap";
+    WriteTocArchive(tocPath, archivePath);
+    archive::convertmapped({ tocPath }, mappedPath, modelUnits);
+
+    // every lattice reads back from the mapped archive exactly as from the original one
+    {
+        archive tocArchive({ tocPath }, modelUnits);
+        archive mappedArchive({ mappedPath }, modelUnits);
+        for (const auto& key : testKeys)
+        {
+            BOOST_REQUIRE(mappedArchive.haslattice(key));
+            lattice expected, actual;
+            tocArchive.getlattice(key, expected);
+            mappedArchive.getlattice(key, actual);
+            BOOST_CHECK_EQUAL(actual.getnumframes(), expected.getnumframes());
+            BOOST_CHECK_EQUAL(actual.getnumnodes(), expected.getnumnodes());
+            BOOST_CHECK_EQUAL(actual.getnumedges(), expected.getnumedges());
+            BOOST_CHECK(Serialize(actual) == Serialize(expected));
+        }
+        BOOST_CHECK(!mappedArchive.haslattice(L"utt3"));
+    }
+
+    // a record whose node count points beyond the end of the mapping is rejected
+    const wstring corruptPath = L"LatticeArchiveTests.corrupt.latmap";
+    string bytes = ReadBinaryFile(mappedPath);
+    const uint32_t numNodes = 0xffffffff;
+    memcpy(&bytes[32 /*sizeof(mappedheader); first record's info.numnodes*/], &numNodes, sizeof(numNodes));
+    WriteTextFile(corruptPath, bytes);
+    WriteTextFile(corruptPath + L".symlist", ReadBinaryFile(mappedPath + L".symlist"));
+    {
+        archive corruptArchive({ corruptPath }, modelUnits);
+        lattice L;
+        BOOST_CHECK_THROW(corruptArchive.getlattice(testKeys[0], L), std::runtime_error);
+    }
+
+    for (const auto& path : { tocPath, archivePath, mappedPath, corruptPath })
+        unlinkOrDie(path);
+    for (const auto& path : { archivePath, mappedPath, corruptPath })
+        unlinkOrDie(path + L".symlist");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}}}}